@@ -1,25 +1,117 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome import pins
-from esphome.const import CONF_ID, CONF_PIN, CONF_DALLAS_ID, CONF_ADDRESS, CONF_INDEX
+from esphome.components import sensor
+from esphome.core import CORE
+from esphome.const import (
+    CONF_ID,
+    CONF_PIN,
+    CONF_DALLAS_ID,
+    CONF_ADDRESS,
+    CONF_INDEX,
+    CONF_CHANNEL,
+    CONF_UART_ID,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_MILLISECOND,
+    UNIT_PERCENT,
+    UNIT_SECOND,
+)
 
 MULTI_CONF = True
+DOMAIN = "dallas"
 AUTO_LOAD = ["sensor"]
 CONF_ALERT_UPDATE_INTERVAL = "alert_update_interval"
 CONF_ALERT_ACTIVITY = "activity_alert"
+CONF_BENCHMARK = "benchmark"
+CONF_OVERDRIVE = "overdrive"
+CONF_RESUME_ROM = "resume_rom"
+CONF_SINGLE_DEVICE = "single_device"
+CONF_ROM_CACHE = "rom_cache"
+CONF_RESCAN_INTERVAL = "rescan_interval"
+CONF_MAX_DEVICES = "max_devices"
+CONF_PARALLEL = "parallel"
+CONF_LOCK_POLICY = "lock_policy"
+CONF_MAX_LOCK_TIME = "max_lock_time"
+CONF_WORKER_CORE = "worker_core"
+CONF_DS2482_ID = "ds2482_id"
+CONF_UART_ONE_WIRE_ID = "uart_one_wire_id"
+CONF_RMT = "rmt"
+CONF_CALIBRATE = "calibrate"
+CONF_TIMING_SWEEP = "timing_sweep"
+CONF_INSTRUMENTATION = "instrumentation"
+CONF_BUS_UTILIZATION = "bus_utilization"
+INSTRUMENTATION_SENSORS = ["lock_time", "slot_time", "read_sample", "reset_time", "transaction_time"]
+
+def _instrumentation_sensor_schema():
+    return sensor.sensor_schema(
+        unit_of_measurement="µs",
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
+CONF_TX_CHANNEL = "tx_channel"
+CONF_RX_CHANNEL = "rx_channel"
 
 dallas_ns = cg.esphome_ns.namespace("dallas")
 DallasNetwork = dallas_ns.class_("DallasNetwork")
 DallasComponent = dallas_ns.class_("DallasComponent", cg.PollingComponent, DallasNetwork)
+DS2482Component = dallas_ns.class_("DS2482Component")
+UARTOneWire = dallas_ns.class_("UARTOneWire")
+uart_ns = cg.esphome_ns.namespace("uart")
+UARTComponent = uart_ns.class_("UARTComponent")
+OneWireLockPolicy = dallas_ns.enum("OneWireLockPolicy")
+LOCK_POLICIES = {
+    "SLOT": OneWireLockPolicy.ONE_WIRE_LOCK_SLOT,
+    "BYTE": OneWireLockPolicy.ONE_WIRE_LOCK_BYTE,
+    "TRANSACTION": OneWireLockPolicy.ONE_WIRE_LOCK_TRANSACTION,
+}
 
-CONFIG_SCHEMA = cv.Schema(
+CONFIG_SCHEMA = cv.All(cv.Schema(
     {
         cv.Optional(CONF_ID,"dallas_wire"): cv.declare_id(DallasComponent),
 #        cv.GenerateID(): cv.declare_id(DallasComponent),
-        cv.Required(CONF_PIN): pins.internal_gpio_output_pin_schema,
+        cv.Optional(CONF_PIN): pins.internal_gpio_output_pin_schema,
+        cv.Optional(CONF_DS2482_ID): cv.use_id(DS2482Component),
+        cv.Optional(CONF_CHANNEL, default=0): cv.int_range(min=0, max=7),
+        cv.Optional(CONF_UART_ID): cv.use_id(UARTComponent),
+        cv.GenerateID(CONF_UART_ONE_WIRE_ID): cv.declare_id(UARTOneWire),
         cv.Optional(CONF_ALERT_UPDATE_INTERVAL, default="never"): cv.update_interval,
+        cv.Optional(CONF_BENCHMARK, default=False): cv.boolean,
+        cv.Optional(CONF_RESUME_ROM, default=True): cv.boolean,
+        cv.Optional(CONF_SINGLE_DEVICE, default=False): cv.boolean,
+        cv.Optional(CONF_ROM_CACHE, default=False): cv.boolean,
+        cv.Optional(CONF_RESCAN_INTERVAL, default="never"): cv.update_interval,
+        cv.Optional(CONF_MAX_DEVICES, default=255): cv.int_range(min=0, max=65535),
+        cv.Optional(CONF_PARALLEL, default=False): cv.boolean,
+        cv.Optional(CONF_LOCK_POLICY, default="TRANSACTION"): cv.enum(LOCK_POLICIES, upper=True),
+        # interrupts run between bytes and search triplets once a transaction held them off this long,
+        # 0 holds them off for the whole transaction
+        cv.Optional(CONF_MAX_LOCK_TIME, default="1ms"): cv.positive_time_period_microseconds,
+        cv.Optional(CONF_WORKER_CORE): cv.All(cv.only_on_esp32, cv.int_range(min=0, max=1)),
+        cv.Optional(CONF_CALIBRATE, default=False): cv.boolean,
+        cv.Optional(CONF_TIMING_SWEEP, default=False): cv.boolean,
+        cv.Optional(CONF_INSTRUMENTATION): cv.Schema(
+            {cv.Optional(key): _instrumentation_sensor_schema() for key in INSTRUMENTATION_SENSORS}
+        ),
+        cv.Optional(CONF_BUS_UTILIZATION): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_RMT): cv.All(
+            cv.only_on_esp32,
+            cv.Schema(
+                {
+                    cv.Required(CONF_TX_CHANNEL): cv.int_range(min=0, max=7),
+                    cv.Required(CONF_RX_CHANNEL): cv.int_range(min=0, max=7),
+                }
+            ),
+        ),
     }
-).extend(cv.polling_component_schema("60s"))
+).extend(cv.polling_component_schema("60s")), cv.has_exactly_one_key(CONF_PIN, CONF_DS2482_ID, CONF_UART_ID))
 
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
@@ -28,10 +120,72 @@ async def to_code(config):
     if CONF_ALERT_UPDATE_INTERVAL in config:
         cg.add(var.set_alert_update_interval(config[CONF_ALERT_UPDATE_INTERVAL]))
 
-    pin = await cg.gpio_pin_expression(config[CONF_PIN])
-    cg.add(var.set_pin(pin))
+    cg.add(var.set_benchmark(config[CONF_BENCHMARK]))
+    cg.add(var.set_resume(config[CONF_RESUME_ROM]))
+    if config[CONF_SINGLE_DEVICE]:
+        cg.add(var.set_single_device(True))
+    if config[CONF_ROM_CACHE]:
+        cg.add(var.set_rom_cache(True))
+    cg.add(var.set_rescan_interval(config[CONF_RESCAN_INTERVAL]))
+    cg.add(var.set_max_devices(config[CONF_MAX_DEVICES]))
+    if config[CONF_PARALLEL]:
+        # the first parallel hub drives the others
+        root = CORE.data.setdefault(DOMAIN, {}).setdefault(CONF_PARALLEL, var)
+        cg.add(var.set_parallel(root))
+    cg.add(var.set_lock_policy(config[CONF_LOCK_POLICY]))
+    cg.add(var.set_max_lock_us(config[CONF_MAX_LOCK_TIME]))
+    if CONF_WORKER_CORE in config:
+        cg.add(var.set_worker_core(config[CONF_WORKER_CORE]))
+    if config[CONF_CALIBRATE]:
+        cg.add(var.set_calibrate(True))
+    if config[CONF_TIMING_SWEEP]:
+        cg.add(var.set_timing_sweep(True))
+    if CONF_INSTRUMENTATION in config:
+        cg.add_define("USE_DALLAS_INSTRUMENTATION")
+        for key in INSTRUMENTATION_SENSORS:
+            if key in config[CONF_INSTRUMENTATION]:
+                sens = await sensor.new_sensor(config[CONF_INSTRUMENTATION][key])
+                cg.add(getattr(var, f"set_{key}_sensor")(sens))
+    if CONF_BUS_UTILIZATION in config:
+        sens = await sensor.new_sensor(config[CONF_BUS_UTILIZATION])
+        cg.add(var.set_bus_utilization_sensor(sens))
+
+    if CONF_DS2482_ID in config:
+        ds2482 = await cg.get_variable(config[CONF_DS2482_ID])
+        cg.add(var.set_one_wire(ds2482.get_channel(config[CONF_CHANNEL])))
+    elif CONF_UART_ID in config:
+        cg.add_define("USE_DALLAS_UART")
+        uart = await cg.get_variable(config[CONF_UART_ID])
+        one_wire = cg.new_Pvariable(config[CONF_UART_ONE_WIRE_ID], uart)
+        cg.add(var.set_one_wire(one_wire))
+    else:
+        pin = await cg.gpio_pin_expression(config[CONF_PIN])
+        cg.add(var.set_pin(pin))
+        if CONF_RMT in config:
+            cg.add_define("USE_DALLAS_RMT")
+            rmt = config[CONF_RMT]
+            cg.add(var.set_rmt_channels(rmt[CONF_TX_CHANNEL], rmt[CONF_RX_CHANNEL]))
 
 DallasDevice = dallas_ns.class_("DallasDevice")
+CONF_DIAGNOSTICS = "diagnostics"
+# sensor, unit and state class of the per device counters
+DEVICE_STATS_SENSORS = {
+    "transactions": (None, STATE_CLASS_TOTAL_INCREASING),
+    "crc_failures": (None, STATE_CLASS_TOTAL_INCREASING),
+    "presence_failures": (None, STATE_CLASS_TOTAL_INCREASING),
+    "retries": (None, STATE_CLASS_TOTAL_INCREASING),
+    "failure_rate": (UNIT_PERCENT, STATE_CLASS_MEASUREMENT),
+    "last_success": (UNIT_SECOND, STATE_CLASS_MEASUREMENT),
+    "bus_time": (UNIT_MILLISECOND, STATE_CLASS_MEASUREMENT),
+}
+
+def _device_stats_sensor_schema(unit, state_class):
+    return sensor.sensor_schema(
+        unit_of_measurement=unit,
+        accuracy_decimals=0,
+        state_class=state_class,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
 
 def dallas_device_schema():
     """Create a schema for a dallas device"""
@@ -40,6 +194,13 @@ def dallas_device_schema():
       cv.Optional(CONF_DALLAS_ID, "dallas_wire"): cv.use_id(DallasNetwork),
       cv.Optional(CONF_ADDRESS): cv.hex_uint64_t,
       cv.Optional(CONF_INDEX): cv.positive_int,
+      cv.Optional(CONF_OVERDRIVE, default=False): cv.boolean,
+      cv.Optional(CONF_DIAGNOSTICS): cv.Schema(
+          {
+              cv.Optional(key): _device_stats_sensor_schema(unit, state_class)
+              for key, (unit, state_class) in DEVICE_STATS_SENSORS.items()
+          }
+      ),
 	}
     return cv.Schema(schema).add_extra(cv.has_exactly_one_key(CONF_ADDRESS, CONF_INDEX))
     
@@ -50,6 +211,12 @@ async def register_dallas_device(var, config):
         cg.add(var.set_address(config[CONF_ADDRESS]))
     else:
         cg.add(var.set_index(config[CONF_INDEX]))
+    if config[CONF_OVERDRIVE]:
+        cg.add(var.set_overdrive(True))
+    for key in DEVICE_STATS_SENSORS:
+        if key in config.get(CONF_DIAGNOSTICS, {}):
+            sens = await sensor.new_sensor(config[CONF_DIAGNOSTICS][key])
+            cg.add(getattr(var, f"set_{key}_sensor")(sens))
 
     hub = await cg.get_variable(config[CONF_DALLAS_ID])
     cg.add(var.set_parent(hub))
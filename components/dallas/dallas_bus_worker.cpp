@@ -0,0 +1,67 @@
+#ifdef USE_ESP32
+
+#include "dallas_bus_worker.h"
+#include "dallas_component.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace dallas {
+
+static const char *const TAG = "dallas.worker";
+
+static const uint32_t WORKER_STACK_SIZE = 4096;
+static const UBaseType_t WORKER_PRIORITY = 5;
+
+bool DallasBusWorker::start(uint8_t core) {
+  auto res = xTaskCreatePinnedToCore(DallasBusWorker::task_main_, "dallas", WORKER_STACK_SIZE, this, WORKER_PRIORITY,
+                                     &this->task_, core);
+  if (res != pdPASS) {
+    ESP_LOGE(TAG, "Creating bus task failed");
+    this->task_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool DallasBusWorker::submit(DallasTransaction *transaction) {
+  if (!this->requests_.push(transaction))
+    return false;
+  xTaskNotifyGive(this->task_);
+  return true;
+}
+
+DallasTransaction *DallasBusWorker::take_result() {
+  DallasTransaction *transaction;
+  if (!this->results_.pop(transaction))
+    return nullptr;
+  return transaction;
+}
+
+void DallasBusWorker::wait_idle() {
+  while (!this->is_idle())
+    vTaskDelay(1);
+}
+
+void DallasBusWorker::task_main_(void *arg) { static_cast<DallasBusWorker *>(arg)->run_(); }
+
+void DallasBusWorker::run_() {
+  while (true) {
+    // busy before taking a request, so the main loop never sees an empty queue and an idle task mid-handover
+    this->busy_.store(true);
+    DallasTransaction *transaction;
+    if (!this->requests_.pop(transaction)) {
+      this->busy_.store(false);
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
+    transaction->run();
+    // the main loop drains the results every loop
+    while (!this->results_.push(transaction))
+      vTaskDelay(1);
+  }
+}
+
+}  // namespace dallas
+}  // namespace esphome
+
+#endif  // USE_ESP32
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifdef USE_ESP32
+
+#include "dallas_queue.h"
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace esphome {
+namespace dallas {
+
+struct DallasTransaction;
+
+/** Task that owns a bus and runs the bus part of transactions.
+ *
+ * The main loop hands over transactions through a request queue and takes
+ * them back through a result queue to run their completion, so sensor states
+ * are still published from the main loop.
+ */
+class DallasBusWorker {
+ public:
+  /// Start the task pinned to core.
+  bool start(uint8_t core);
+  /// Hand a transaction to the task, false if the request queue is full.
+  bool submit(DallasTransaction *transaction);
+  /// Take a transaction the task is done with, nullptr if there is none.
+  DallasTransaction *take_result();
+  /// Nothing queued or running, so the main loop may use the bus itself.
+  bool is_idle() const { return !this->busy_.load() && this->requests_.empty(); }
+  /// Block until the task is idle.
+  void wait_idle();
+  /// Whether the caller runs on the task.
+  bool in_worker() const { return xTaskGetCurrentTaskHandle() == this->task_; }
+
+ protected:
+  static void task_main_(void *arg);
+  void run_();
+
+  TaskHandle_t task_{nullptr};
+  DallasSPSCQueue<DallasTransaction *, 8> requests_;
+  DallasSPSCQueue<DallasTransaction *, 8> results_;
+  std::atomic<bool> busy_{false};
+};
+
+}  // namespace dallas
+}  // namespace esphome
+
+#endif  // USE_ESP32
@@ -1,24 +1,199 @@
 #include "dallas_component.h"
 #include "esphome/core/log.h"
 
+#include <algorithm>
+#include <memory>
+
 namespace esphome {
 namespace dallas {
 
 static const char *const TAG = "dallas.sensor";
 static const uint8_t DALLAS_COMMAND_START_CONVERSION = 0x44;
+static const uint8_t DALLAS_CONVERSION_READ_MAX = 16;
+// transfer errors since the last calibration that trigger another one
+static const uint32_t DALLAS_RECALIBRATE_ERRORS = 5;
+
 
 void DallasNetwork::register_sensor(DallasDevice *sensor) { this->sensors_.push_back(sensor); }
 
+// the search takes the 0 branch first starting from the LSB, so it finds devices in bit reversed order
+static uint64_t search_order(uint64_t address) {
+  uint64_t res = 0;
+  for (uint8_t i = 0; i < 64; i++) {
+    res = (res << 1) | ((address >> i) & 1);
+  }
+  return res;
+}
+
 bool DallasNetwork::setup_sensors() {
-  std::vector<uint64_t> raw_sensors;
-  raw_sensors = this->search_vec();
+  this->start_discovery();
+  while (!this->discovery_step())
+    ;
+  return this->discovery_successful_;
+}
+
+void DallasNetwork::start_discovery() {
+  this->discovery_roms_.clear();
+  this->discovery_families_.clear();
+  this->discovery_family_index_ = 0;
+  this->discovery_first_ = true;
+  this->discovery_successful_ = true;
+  this->discovery_state_ = DISCOVERY_STARTING;
+}
+
+void DallasNetwork::begin_discovery_() {
+  this->discovery_bench_.begin(this->get_one_wire_(), "discovery");
+
+  std::vector<uint64_t> known;
+  // a rescan is looking for changes, so always search
+  if (this->rom_cache_ && !this->rescanning_)
+    known = this->load_rom_cache_();
+  this->rom_cache_used_ = !known.empty();
+  if (known.empty() && this->single_device_ && !this->rescanning_)
+    known = this->read_rom_vec();
+  if (!known.empty()) {
+    this->discovery_roms_ = known;
+    for (auto address : known) {
+      this->attach_address_(address);
+    }
+    this->discovery_state_ = DISCOVERY_FINISHING;
+    return;
+  }
+
+  if (!this->get_family_codes_(this->discovery_families_))
+    this->discovery_families_ = {0};
+  this->discovery_state_ = DISCOVERY_SEARCHING;
+}
+
+bool DallasNetwork::discovery_step() {
+  if (this->discovery_state_ == DISCOVERY_IDLE || this->discovery_state_ == DISCOVERY_DONE)
+    return true;
+
+  if (this->discovery_state_ == DISCOVERY_STARTING) {
+    this->begin_discovery_();
+    return false;
+  }
+
+  if (this->discovery_state_ == DISCOVERY_SEARCHING) {
+    auto address = this->search_next_();
+    if (address != 0u) {
+      this->discovery_roms_.push_back(address);
+      this->attach_address_(address);
+      return false;
+    }
+    if (++this->discovery_family_index_ < this->discovery_families_.size()) {
+      this->discovery_first_ = true;
+      return false;
+    }
+    if (this->discovery_families_.size() > 1) {
+      // keep the order of a full search so index based devices don't move
+      std::sort(this->discovery_roms_.begin(), this->discovery_roms_.end(),
+                [](uint64_t a, uint64_t b) { return search_order(a) < search_order(b); });
+    }
+    if (this->rom_cache_)
+      this->save_rom_cache_(this->discovery_roms_);
+  }
+
+  this->finish_discovery_();
+  return true;
+}
+
+uint64_t DallasNetwork::search_next_() {
+  auto wire = this->get_reset_one_wire_();
+  if ( wire == nullptr )
+    return 0u;
+  if ( this->discovery_first_ ) {
+    auto family = this->discovery_families_[this->discovery_family_index_];
+    if (family != 0)
+      wire->reset_search(family);
+    else
+      wire->reset_search();
+    this->discovery_first_ = false;
+  } else {
+    // the bus may have been used for other searches since the last step
+    wire->set_search_state(this->search_state_);
+  }
 
+  auto address = wire->search();
+  this->search_state_ = wire->get_search_state();
+  return address;
+}
+
+void DallasNetwork::attach_address_(uint64_t address) {
+  auto *address8 = reinterpret_cast<uint8_t *>(&address);
+  if (crc8(address8, 7) != address8[7])
+    return;
+  for (auto *sensor : this->sensors_) {
+    if (sensor->get_address() != address)
+      continue;
+    if (!sensor->is_attached()) {
+      if (!sensor->get_index().has_value())
+        this->attach_sensor_(sensor);
+    } else if (!sensor->is_online()) {
+      ESP_LOGI(TAG, "%s is back online", sensor->get_address_name().c_str());
+      sensor->online_ = true;
+      // it may have lost its configuration
+      this->setup_device_(sensor);
+    }
+  }
+}
+
+void DallasNetwork::attach_sensor_(DallasDevice *sensor) {
+  if (sensor->get_overdrive()) {
+    auto *wire = this->get_one_wire_();
+    if (wire != nullptr && !wire->supports_overdrive()) {
+      ESP_LOGW(TAG, "%s: the bus master has no overdrive speed", sensor->get_address_name().c_str());
+    } else if (wire != nullptr) {
+      wire->set_overdrive_device(sensor->get_address(), true);
+    }
+  }
+
+  sensor->attached_ = true;
+  sensor->online_ = true;
+  if (!this->setup_device_(sensor)) {
+    this->discovery_successful_ = false;
+  }
+}
+
+bool DallasNetwork::setup_device_(DallasDevice *sensor) {
+  uint32_t start = this->get_bus_us_();
+  bool ok = sensor->setup_sensor();
+  sensor->stats_.bus_us += this->get_bus_us_() - start;
+  return ok;
+}
+
+uint32_t DallasNetwork::get_bus_us_() {
+  auto *wire = this->get_root_network()->get_one_wire_();
+  return wire != nullptr ? wire->get_stats().bus_us.get() : 0;
+}
+
+void DallasNetwork::finish_discovery_() {
+  auto &raw_sensors = this->discovery_roms_;
+  this->bus_device_count_ = raw_sensors.size();
+  this->discovery_bench_.set_count(raw_sensors.size());
+  this->discovery_bench_.finish();
+
+  std::vector<uint64_t> previous = std::move(this->bus_roms_);
+  this->bus_roms_ = raw_sensors;
+  std::sort(this->bus_roms_.begin(), this->bus_roms_.end());
+  auto on_bus = [this](uint64_t address) {
+    return std::binary_search(this->bus_roms_.begin(), this->bus_roms_.end(), address);
+  };
+
+  if (!this->rescanning_) {
 ESP_LOGD(TAG, "found %d sensors", raw_sensors.size());
+  }
 
+  this->found_sensors_.clear();
   for (auto &address : raw_sensors) {
+    // only report changes on a rescan
+    bool known = std::binary_search(previous.begin(), previous.end(), address);
+    if (this->rescanning_ && !known)
+      ESP_LOGI(TAG, "Dallas device 0x%s appeared", format_hex(address).c_str());
     auto *address8 = reinterpret_cast<uint8_t *>(&address);
     if (crc8(address8, 7) != address8[7]) {
-      ESP_LOGW(TAG, "Dallas device 0x%s has invalid CRC.", format_hex(address).c_str());
+      if (!known)
+        ESP_LOGW(TAG, "Dallas device 0x%s has invalid CRC.", format_hex(address).c_str());
       continue;
     }
     bool is_supported = false;
@@ -29,92 +204,464 @@ ESP_LOGD(TAG, "found %d sensors", raw_sensors.size());
       }
     }
     if ( !is_supported ) {
+      if (!known)
         ESP_LOGW(TAG, "Unknown device type 0x%02X.", address8[0]);
-        continue;
+      continue;
     }
     this->found_sensors_.push_back(address);
   }
 
-  bool successful = true;
-
   for (auto *sensor : this->sensors_) {
+    if (sensor->is_attached()) {
+      if (this->hotplug_ && sensor->is_online() && !on_bus(sensor->get_address())) {
+        ESP_LOGW(TAG, "%s went offline", sensor->get_address_name().c_str());
+        sensor->online_ = false;
+      }
+      continue;
+    }
     if (sensor->get_index().has_value()) {
       if (*sensor->get_index() >= this->found_sensors_.size()
         || !sensor->is_supported(reinterpret_cast<uint8_t *>(&this->found_sensors_[*sensor->get_index()]))) {
-        successful = false;
+        this->discovery_successful_ = false;
         continue;
       }
       sensor->set_address(this->found_sensors_[*sensor->get_index()]);
+    } else if (this->hotplug_) {
+      // keep it pending, a rescan attaches it once it shows up
+      this->discovery_successful_ = false;
+      continue;
     }
 
-    if (!sensor->setup_sensor()) {
-      successful = false;
-    }
+    this->attach_sensor_(sensor);
   }
-  return successful;
+
+  this->discovery_state_ = DISCOVERY_DONE;
+  this->on_discovery_finished_();
+  this->rescanning_ = false;
+}
+
+void DallasNetwork::start_rescan() {
+  if (this->is_discovering())
+    return;
+  this->start_discovery();
+  this->rescanning_ = true;
 }
 
 bool DallasNetwork::update_conversions() {
   if (this->sensors_.empty())
     return true;
 
+  this->update_bench_.begin(this->get_one_wire_(), "update");
   auto wire = this->get_reset_one_wire_();
   if ( wire == nullptr )
     return false;
 
   {
-    InterruptLock lock;
+    OneWireLock lock(wire);
     wire->skip();
     wire->write8(DALLAS_COMMAND_START_CONVERSION);
   }
 
+  this->schedule_conversion_reads_(nullptr);
+  return true;
+}
+
+void DallasNetwork::schedule_conversion_reads_(std::vector<DallasDevice *> *parallel) {
+  auto *wire = this->get_one_wire_();
+  this->pending_conversions_ = 0;
   for (auto *sensor : this->sensors_) {
+    if (!sensor->is_attached() || !sensor->is_online())
+      continue;
+    uint8_t command;
+    if (parallel != nullptr && !wire->is_overdrive_device(sensor->get_address()) &&
+        sensor->get_conversion_read(command) != 0) {
+      parallel->push_back(sensor);
+      continue;
+    }
 	auto conversion_millis = sensor->millis_to_wait_for_conversion();
 	if (conversion_millis > 0 && conversion_millis != SCHEDULER_DONT_RUN) {
-      this->component_set_timeout(sensor->get_address_name(), conversion_millis, [this, sensor] {
-	    sensor->read_conversion();
-      });
+      this->pending_conversions_++;
+      this->component_set_timeout(sensor->get_address_name(), conversion_millis,
+                                  [this, sensor] { this->submit_conversion_read_(sensor); });
 	}
   }
+  if (this->pending_conversions_ == 0)
+    this->update_bench_.finish();
+}
+
+void DallasNetwork::submit(DallasDevice *device, uint8_t key, DallasPriority priority, std::function<void()> &&run,
+                           std::function<void()> &&complete) {
+  auto *root = this->get_root_network();
+  if (root != this) {
+    root->submit(device, key, priority, std::move(run), std::move(complete));
+    return;
+  }
+  if (device != nullptr) {
+    // the bus time of the work goes to the device, wherever it runs
+    run = [this, device, run = std::move(run)]() {
+      uint32_t start = this->get_bus_us_();
+      run();
+      device->stats_.bus_us += this->get_bus_us_() - start;
+    };
+  }
+  for (auto &transaction : this->transactions_) {
+    if (transaction.device == device && transaction.key == key) {
+      transaction.run = std::move(run);
+      transaction.complete = std::move(complete);
+      transaction.priority = std::min(transaction.priority, priority);
+      return;
+    }
+  }
+  this->transactions_.push_back({device, key, priority, std::move(run), std::move(complete)});
+}
+
+void DallasNetwork::publish_device_stats() {
+  for (auto *sensor : this->sensors_) {
+    ESP_LOGV(TAG, "%s: %.1fms on the bus", sensor->get_address_name().c_str(),
+             (sensor->stats_.bus_us - sensor->published_stats_.bus_us) / 1000.0f);
+    sensor->publish_stats();
+  }
+}
+
+bool DallasNetwork::is_bus_idle() {
+  auto *root = this->get_root_network();
+  return root->transactions_.empty() && root->is_bus_available_();
+}
+
+bool DallasNetwork::run_transactions() {
+  while (!this->transactions_.empty()) {
+    auto next = this->transactions_.begin();
+    for (auto it = next; it != this->transactions_.end(); ++it) {
+      if (it->priority < next->priority)
+        next = it;
+    }
+    if (next->complete && this->offload_transaction_(*next)) {
+      this->transactions_.erase(next);
+      continue;
+    }
+    // everything else needs the bus on this thread
+    if (!this->is_bus_available_())
+      return false;
+    // the work may queue more work, so take it off first
+    auto transaction = std::move(*next);
+    this->transactions_.erase(next);
+    transaction.run();
+    if (transaction.complete)
+      transaction.complete();
+    // one slower transaction per loop, so a waiting actuator write is delayed by at most that
+    if (transaction.priority != DALLAS_PRIORITY_ACTUATOR)
+      break;
+  }
+  return this->transactions_.empty();
+}
+
+void DallasNetwork::submit_conversion_read_(DallasDevice *sensor) {
+  auto done = [this]() {
+    // benchmark covers the conversion and all the reads
+    this->update_bench_.set_count(this->update_bench_.get_count() + 1);
+    if (--this->pending_conversions_ == 0)
+      this->update_bench_.finish();
+  };
+  uint8_t command;
+  uint8_t len = sensor->get_conversion_read(command);
+  if (len == 0 || len > DALLAS_CONVERSION_READ_MAX) {
+    this->submit(sensor, DALLAS_KEY_CONVERSION_READ, DALLAS_PRIORITY_SENSOR, [sensor, done]() {
+      sensor->read_conversion();
+      done();
+    });
+    return;
+  }
+
+  struct ConversionRead {
+    uint8_t data[DALLAS_CONVERSION_READ_MAX];
+    bool ok;
+  };
+  auto read = std::make_shared<ConversionRead>();
+  this->submit(
+      sensor, DALLAS_KEY_CONVERSION_READ, DALLAS_PRIORITY_SENSOR,
+      [sensor, read, command, len]() {
+        auto *wire = sensor->get_reset_one_wire_();
+        read->ok = wire != nullptr;
+        if (!read->ok)
+          return;
+        OneWireLock lock(wire);
+        wire->select(sensor->get_address());
+        wire->write8(command);
+        for (uint8_t i = 0; i < len; i++)
+          read->data[i] = wire->read8();
+      },
+      [sensor, read, done]() {
+        sensor->finish_conversion_read(read->data, read->ok);
+        done();
+      });
+}
+
+bool DallasNetwork::get_family_codes_(std::vector<uint8_t> &families) {
+  // nothing configured, search everything so the addresses get logged
+  if (this->sensors_.empty())
+    return false;
+  for (auto *sensor : this->sensors_) {
+    if (!sensor->get_family_codes(families))
+      return false;
+  }
+  std::sort(families.begin(), families.end());
+  families.erase(std::unique(families.begin(), families.end()), families.end());
   return true;
 }
 
-std::vector<uint64_t> DallasNetwork::search_vec() {
+std::vector<uint64_t> DallasNetwork::read_rom_vec() {
   std::vector<uint64_t> res;
+  OneWireBenchmark bench(this->get_one_wire_(), "read_rom");
 
-  while ( true ) {
-    auto wire = this->get_reset_one_wire_();
-    if ( wire == nullptr )
-      break;
-    if ( res.empty() ) // reset on first
-      wire->reset_search();
+  auto wire = this->get_reset_one_wire_();
+  if (wire == nullptr)
+    return res;
 
-    auto address = wire->search();
-    if ( address == 0u)
-      break;
+  uint64_t address;
+  {
+    OneWireLock lock(wire);
+    address = wire->read_rom();
+  }
+  auto *address8 = reinterpret_cast<uint8_t *>(&address);
+  // more than one device responding corrupts the crc
+  if (address8[0] == 0 || crc8(address8, 7) != address8[7]) {
+    ESP_LOGW(TAG, "Read ROM failed, searching the bus instead");
+    return res;
+  }
+  res.push_back(address);
+  bench.set_count(res.size());
+  return res;
+}
+
+std::vector<uint64_t> DallasNetwork::load_rom_cache_() {
+  std::vector<uint64_t> res;
+  this->rom_cache_pref_ = global_preferences->make_preference<DallasRomCache>(this->get_rom_cache_hash_(), true);
+
+  DallasRomCache cache{};
+  if (!this->rom_cache_pref_.load(&cache) || cache.count == 0 || cache.count > DALLAS_ROM_CACHE_SIZE)
+    return res;
+
+  OneWireBenchmark bench(this->get_one_wire_(), "verify_rom_cache");
+  for (uint8_t i = 0; i < cache.count; i++) {
+    auto wire = this->get_reset_one_wire_();
+    if (wire == nullptr)
+      return {};
+    uint64_t address;
+    {
+      OneWireLock lock(wire);
+      address = wire->search_select(cache.roms[i], ONE_WIRE_ROM_SEARCH);
+    }
+    if (address != cache.roms[i]) {
+      ESP_LOGD(TAG, "Cached device 0x%s not found, searching", format_hex(cache.roms[i]).c_str());
+      return {};
+    }
     res.push_back(address);
   }
+  bench.set_count(res.size());
+  ESP_LOGD(TAG, "Using %u cached devices", cache.count);
   return res;
 }
 
+void DallasNetwork::save_rom_cache_(const std::vector<uint64_t> &roms) {
+  DallasRomCache cache{};
+  if (roms.size() > DALLAS_ROM_CACHE_SIZE) {
+    ESP_LOGW(TAG, "Too many devices to cache (%u)", roms.size());
+  } else {
+    cache.count = roms.size();
+    std::copy(roms.begin(), roms.end(), cache.roms);
+  }
+  DallasRomCache current{};
+  if (this->rom_cache_pref_.load(&current) && current.count == cache.count &&
+      std::equal(cache.roms, cache.roms + cache.count, current.roms))
+    return;
+  this->rom_cache_pref_.save(&cache);
+}
+
 void DallasComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up DallasComponent 2...");
 
-  pin_->setup();
+  if (pin_ != nullptr) {
+    pin_->setup();
 
-  // clear bus with 480µs high, otherwise initial reset in search_vec() fails
-  pin_->pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
-  delayMicroseconds(480);
+    // clear bus with 480µs high, otherwise initial reset in search_vec() fails
+    pin_->pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
+    delayMicroseconds(480);
+
+#ifdef USE_DALLAS_RMT
+    if (this->rmt_tx_channel_ >= 0) {
+      auto *rmt = new RMTOneWire(pin_, static_cast<rmt_channel_t>(this->rmt_tx_channel_),  // NOLINT
+                                 static_cast<rmt_channel_t>(this->rmt_rx_channel_));
+      if (rmt->setup()) {
+        one_wire_ = rmt;
+      } else {
+        ESP_LOGW(TAG, "RMT not available, bit-banging the bus");
+        delete rmt;  // NOLINT(cppcoreguidelines-owning-memory)
+      }
+    }
+#endif
+    if (one_wire_ == nullptr)
+      one_wire_ = new ESPOneWire(pin_);  // NOLINT(cppcoreguidelines-owning-memory)
+  } else if (one_wire_ == nullptr) {
+    ESP_LOGE(TAG, "No pin or bus master configured");
+    this->mark_failed();
+    return;
+  }
+  one_wire_->set_benchmark(this->benchmark_);
+  one_wire_->set_resume(this->resume_);
+  one_wire_->set_max_devices(this->max_devices_);
+  one_wire_->set_lock_policy(this->lock_policy_);
+  one_wire_->set_max_lock_us(this->max_lock_us_);
+  if (this->calibrate_)
+    this->calibrate_bus_();
 
-  one_wire_ = new ESPOneWire(pin_);  // NOLINT(cppcoreguidelines-owning-memory)
+  if (this->worker_core_ >= 0) {
+#ifdef USE_ESP32
+    if (this->parallel_) {
+      ESP_LOGW(TAG, "Parallel buses run from the main loop, not starting a bus task");
+    } else {
+      this->worker_ = new DallasBusWorker();  // NOLINT(cppcoreguidelines-owning-memory)
+      if (!this->worker_->start(this->worker_core_)) {
+        delete this->worker_;  // NOLINT(cppcoreguidelines-owning-memory)
+        this->worker_ = nullptr;
+      }
+    }
+#endif
+  }
+  // bus masters with their own timing block for a whole command anyway. With a bus task the
+  // conversion is queued like the other work, so the async engine and the task never share the bus.
+  if (one_wire_->is_bit_banged() && !this->has_worker_())
+    async_ = new ESPOneWireAsync(one_wire_);  // NOLINT(cppcoreguidelines-owning-memory)
 
-  if (!this->setup_sensors()) {
+  if (this->parallel_) {
+    auto *root = this->parallel_root_;
+    if (root->parallel_group_.add_bus(this->one_wire_) == root->parallel_hubs_.size()) {
+      root->parallel_hubs_.push_back(this);
+    } else {
+      this->parallel_ = false;
+    }
+  }
+
+  // enumerate from loop() so the rest of the firmware isn't blocked
+  this->start_discovery();
+
+  if (this->rescan_interval_ != SCHEDULER_DONT_RUN) {
+    this->set_hotplug(true);
+    this->set_interval("rescan", this->rescan_interval_, [this]() { this->start_rescan(); });
+  }
+}
+
+void DallasComponent::loop() {
+#ifdef USE_ESP32
+  if (this->worker_ != nullptr) {
+    while (auto *transaction = this->worker_->take_result()) {
+      transaction->complete();
+      delete transaction;  // NOLINT(cppcoreguidelines-owning-memory)
+    }
+  }
+#endif
+  if (this->async_ != nullptr && this->async_->is_busy()) {
+    if (!this->is_bus_available_())
+      return;
+    this->async_->step();
+    return;
+  }
+  // discovery only runs when no other bus work is waiting
+  if (!this->run_transactions() || !this->is_bus_available_())
+    return;
+  if (this->is_discovering())
+    this->discovery_step();
+}
+
+void DallasComponent::on_discovery_finished_() {
+  if (!this->discovery_successful_) {
     this->status_set_error();
+  } else {
+    this->status_clear_error();
+  }
+
+  // Skip ROM needs nothing else on the bus. A search by family only sees the configured families and a
+  // missing configured device may come back, so a single device found by family is checked with a
+  // search of the whole bus. The rom cache only verified the cached devices, searching the bus would
+  // undo what it saves, so a single cached device keeps Match ROM.
+  bool single = this->single_device_ || (this->bus_device_count_ == 1 && !this->rom_cache_used_);
+  for (auto *sensor : this->sensors_) {
+    single &= !sensor->has_branches() && !sensor->needs_match_rom() &&
+              std::binary_search(this->bus_roms_.begin(), this->bus_roms_.end(), sensor->get_address());
+  }
+  bool full_search = this->discovery_families_.size() == 1 && this->discovery_families_[0] == 0;
+  if (single && !this->single_device_ && !full_search)
+    single = this->is_only_device_();
+  if (single != this->one_wire_->is_single_device()) {
+    ESP_LOGD(TAG, "Addressing devices with %s ROM", single ? "Skip" : "Match");
+    this->one_wire_->set_single_device(single);
+  }
+
+  // once, the first device found is the reference
+  if (this->timing_sweep_ && !this->found_sensors_.empty() && this->one_wire_->is_bit_banged()) {
+    this->timing_sweep_ = false;
+    this->sweep_ = new OneWireTimingSweep();  // NOLINT(cppcoreguidelines-owning-memory)
+    if (this->sweep_->start(this->one_wire_, this->found_sensors_[0])) {
+      this->submit(nullptr, DALLAS_KEY_SWEEP, DALLAS_PRIORITY_DISCOVERY, [this]() { this->sweep_step_(); });
+    } else {
+      delete this->sweep_;  // NOLINT(cppcoreguidelines-owning-memory)
+      this->sweep_ = nullptr;
+    }
   }
 }
 
+bool DallasComponent::is_only_device_() {
+  auto *wire = this->get_reset_one_wire_();
+  if (wire == nullptr)
+    return false;
+  wire->reset_search();
+  return wire->search() != 0 && wire->get_search_state().last_device_flag;
+}
+
+void DallasComponent::sweep_step_() {
+  // a few searches per transaction, the other bus work goes in between
+  if (this->sweep_->step()) {
+    this->submit(nullptr, DALLAS_KEY_SWEEP, DALLAS_PRIORITY_DISCOVERY, [this]() { this->sweep_step_(); });
+    return;
+  }
+  if (this->sweep_->found())
+    this->one_wire_->set_timing(this->sweep_->get_best());
+  delete this->sweep_;  // NOLINT(cppcoreguidelines-owning-memory)
+  this->sweep_ = nullptr;
+}
+
+bool DallasComponent::offload_transaction_(DallasTransaction &transaction) {
+#ifdef USE_ESP32
+  if (this->worker_ == nullptr)
+    return false;
+  auto *request = new DallasTransaction(std::move(transaction));  // NOLINT(cppcoreguidelines-owning-memory)
+  if (this->worker_->submit(request))
+    return true;
+  transaction = std::move(*request);
+  delete request;  // NOLINT(cppcoreguidelines-owning-memory)
+#endif
+  return false;
+}
+
+bool DallasComponent::has_worker_() const {
+#ifdef USE_ESP32
+  return this->worker_ != nullptr;
+#else
+  return false;
+#endif
+}
+
+bool DallasComponent::is_bus_available_() {
+#ifdef USE_ESP32
+  if (this->worker_ != nullptr)
+    return this->worker_->in_worker() || this->worker_->is_idle();
+#endif
+  return true;
+}
+
 void DallasComponent::start_alert_poller() {
-    this->set_interval("alert_update", this->get_alert_update_interval(), [this]() { this->update_alert(); });
+    this->set_interval("alert_update", this->get_alert_update_interval(), [this]() {
+      this->submit(nullptr, DALLAS_KEY_ALERT_POLL, DALLAS_PRIORITY_ALERT, [this]() { this->update_alert(); });
+    });
 }
 
 void DallasComponent::stop_alert_poller() {
@@ -133,6 +680,7 @@ void DallasComponent::update_alert() {
   //ESP_LOGD(TAG,"Scanning alerting devices");
   auto start = millis();
   uint8_t count = 0;
+  OneWireBenchmark bench(this->one_wire_, "update_alert");
 
   this->one_wire_->reset_search();
   while(true){
@@ -148,9 +696,7 @@ void DallasComponent::update_alert() {
       bool found = false;
       for (auto *sensor : this->sensors_) {
         if (sensor->get_address() == addr){
-          this->component_set_timeout(sensor->get_address_name(), 1, [this, sensor] {
-        	    sensor->notify_alerting();
-              });
+          this->submit(sensor, DALLAS_KEY_ALERT, DALLAS_PRIORITY_ALERT, [sensor] { sensor->notify_alerting(); });
 //          sensor->notify_alerting();
           ++count;
           found = true;
@@ -161,6 +707,7 @@ void DallasComponent::update_alert() {
       }
   }
 
+  bench.set_count(count);
   auto duration = millis() - start;
   if ( duration > 20) {
     ESP_LOGW(TAG, "long alert %d count=%d", duration, count);
@@ -171,8 +718,47 @@ void DallasComponent::update_alert() {
 void DallasComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "DallasComponent:");
   LOG_PIN("  Pin: ", this->pin_);
+  if (this->pin_ == nullptr && this->one_wire_ != nullptr)
+    ESP_LOGCONFIG(TAG, "  Bus master: %s", this->one_wire_->dump_summary().c_str());
   LOG_UPDATE_INTERVAL(this);
   LOG_UPDATE_ALERT_INTERVAL(this);
+  if (this->rescan_interval_ != SCHEDULER_DONT_RUN) {
+    ESP_LOGCONFIG(TAG, "  Rescan Interval: %.1fs", this->rescan_interval_ / 1000.0f);
+  }
+  if (this->one_wire_ != nullptr && this->one_wire_->is_single_device()) {
+    ESP_LOGCONFIG(TAG, "  Single device mode");
+  }
+#ifdef USE_ESP32
+  if (this->worker_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Bus task on core %d", this->worker_core_);
+  }
+#endif
+  if (this->parallel_) {
+    ESP_LOGCONFIG(TAG, "  Parallel with %u buses, updated by %s", this->parallel_root_->parallel_hubs_.size(),
+                  this->parallel_root_->get_bus_summary_().c_str());
+  }
+  if (this->one_wire_ != nullptr) {
+    auto &stats = this->one_wire_->get_stats();
+    ESP_LOGCONFIG(TAG, "  Bus: resets=%u presence_failures=%u slots=%u bus_us=%u", stats.resets.get(),
+                  stats.presence_failures.get(), stats.slots.get(), stats.bus_us.get());
+    if (this->calibrate_ && this->one_wire_->is_bit_banged()) {
+      auto &timing = this->one_wire_->get_timing();
+      ESP_LOGCONFIG(TAG, "  Calibrated timing: sample=%uus slot=%uus transfer_errors=%u", timing.read_sample,
+                    timing.slot, stats.transfer_errors.get());
+    }
+    static const char *const LOCK_POLICIES[] = {"slot", "byte", "transaction"};
+    ESP_LOGCONFIG(TAG, "  Interrupt lock: policy=%s max_lock_us=%u locked_us=%u longest=%uus",
+                  LOCK_POLICIES[this->lock_policy_], this->max_lock_us_, stats.locked_us.get(),
+                  stats.max_locked_us.get());
+#ifdef USE_DALLAS_INSTRUMENTATION
+    auto &instrumentation = this->one_wire_->get_instrumentation();
+    instrumentation.slot.dump("Slot time");
+    instrumentation.read_sample.dump("Read sample");
+    instrumentation.reset.dump("Reset time");
+    instrumentation.lock.dump("Lock time");
+    instrumentation.transaction.dump("Transaction time");
+#endif
+  }
 
   DallasNetwork::dump_config();
 }
@@ -212,12 +798,175 @@ void DallasNetwork::dump_config() {
 }
 
 void DallasComponent::update() {
+#ifdef USE_DALLAS_INSTRUMENTATION
+  this->publish_instrumentation_();
+#endif
+  this->publish_device_stats();
+  this->publish_bus_utilization_();
+  if (this->calibrate_ && this->one_wire_ != nullptr &&
+      this->one_wire_->get_stats().transfer_errors - this->calibrated_errors_ >= DALLAS_RECALIBRATE_ERRORS) {
+    ESP_LOGW(TAG, "Transfers keep failing, calibrating the bus again");
+    this->submit(nullptr, DALLAS_KEY_RECALIBRATE, DALLAS_PRIORITY_DISCOVERY, [this]() { this->calibrate_bus_(); });
+  }
+  if (this->parallel_) {
+    // the first hub updates all of them, queued like the other work on its bus
+    if (this->parallel_root_ == this)
+      this->submit(nullptr, DALLAS_KEY_CONVERSION, DALLAS_PRIORITY_PARALLEL, [this]() { this->update_parallel_(); });
+    return;
+  }
   this->status_clear_warning();
-  bool result = this->update_conversions();
-  if (!result) {
+  if (this->sensors_.empty())
+    return;
+
+  // the reset and convert command run from loop(), the reads are scheduled when they are done
+  this->update_bench_.begin(this->one_wire_, "update");
+  if (this->async_ == nullptr) {
+    this->submit(nullptr, DALLAS_KEY_CONVERSION, DALLAS_PRIORITY_SENSOR, [this]() { this->start_conversion_(); });
+    return;
+  }
+  bool started = this->async_->start({ONE_WIRE_ROM_SKIP, DALLAS_COMMAND_START_CONVERSION}, 0,
+                                     [this](bool present, const std::vector<uint8_t> &data) {
+                                       if (!present) {
+                                         ESP_LOGE(TAG, "Requesting conversion failed");
+                                         this->status_set_warning();
+                                         this->update_bench_.finish();
+                                         return;
+                                       }
+                                       this->schedule_conversion_reads_(nullptr);
+                                     });
+  if (!started)
+    ESP_LOGW(TAG, "Bus busy, skipping update");
+}
+
+#ifdef USE_DALLAS_INSTRUMENTATION
+void DallasComponent::publish_instrumentation_() {
+  if (this->one_wire_ == nullptr)
+    return;
+  auto &instrumentation = this->one_wire_->get_instrumentation();
+  auto publish = [](sensor::Sensor *sensor, OneWireHistogram &histogram) {
+    uint32_t value = histogram.take_recent_max();
+    if (sensor != nullptr)
+      sensor->publish_state(value);
+  };
+  publish(this->lock_time_sensor_, instrumentation.lock);
+  publish(this->slot_time_sensor_, instrumentation.slot);
+  publish(this->read_sample_sensor_, instrumentation.read_sample);
+  publish(this->reset_time_sensor_, instrumentation.reset);
+  publish(this->transaction_time_sensor_, instrumentation.transaction);
+}
+#endif
+
+void DallasComponent::calibrate_bus_() {
+  this->calibrated_errors_ = this->one_wire_->get_stats().transfer_errors;
+  this->one_wire_->calibrate();
+}
+
+void DallasComponent::start_conversion_() {
+  auto *wire = this->get_reset_one_wire_();
+  if (wire == nullptr) {
     ESP_LOGE(TAG, "Requesting conversion failed");
     this->status_set_warning();
+    this->update_bench_.finish();
+    return;
+  }
+  {
+    OneWireLock lock(wire);
+    wire->skip();
+    wire->write8(DALLAS_COMMAND_START_CONVERSION);
+  }
+  this->schedule_conversion_reads_(nullptr);
+}
+
+void DallasComponent::update_parallel_() {
+  auto *group = &this->parallel_group_;
+  uint32_t mask = 0;
+  for (uint8_t i = 0; i < this->parallel_hubs_.size(); i++) {
+    auto *hub = this->parallel_hubs_[i];
+    hub->status_clear_warning();
+    // leave buses alone while they are searched, and drop reads still pending from the last update
+    hub->parallel_reads_.clear();
+    if (!hub->sensors_.empty() && !hub->is_discovering())
+      mask |= 1u << i;
+  }
+  if (mask == 0)
+    return;
+
+  this->parallel_bench_.begin(this->one_wire_, "parallel_update");
+  uint32_t present = group->reset(mask);
+  group->write8(present, ONE_WIRE_ROM_SKIP);
+  group->write8(present, DALLAS_COMMAND_START_CONVERSION);
+
+  uint16_t wait = 0;
+  for (uint8_t i = 0; i < this->parallel_hubs_.size(); i++) {
+    auto *hub = this->parallel_hubs_[i];
+    if (!(mask & (1u << i)))
+      continue;
+    if (!(present & (1u << i))) {
+      ESP_LOGE(TAG, "Requesting conversion failed");
+      hub->status_set_warning();
+      continue;
+    }
+    hub->update_bench_.begin(hub->one_wire_, "update");
+    hub->schedule_conversion_reads_(&hub->parallel_reads_);
+    for (auto *sensor : hub->parallel_reads_)
+      wait = std::max(wait, sensor->millis_to_wait_for_conversion());
+  }
+  if (wait == 0) {
+    this->parallel_bench_.finish();
+    return;
+  }
+  this->set_timeout("parallel_read", wait, [this]() {
+    this->submit(nullptr, DALLAS_KEY_PARALLEL_READ, DALLAS_PRIORITY_PARALLEL, [this]() { this->read_parallel_(); });
+  });
+}
+
+void DallasComponent::read_parallel_() {
+  auto *group = &this->parallel_group_;
+  uint8_t count = 0;
+  std::vector<size_t> next(this->parallel_hubs_.size(), 0);
+  while (true) {
+    // one device from every bus with reads left
+    uint32_t mask = 0;
+    uint64_t addresses[ESPOneWireGroup::MAX_BUSES];
+    uint8_t commands[ESPOneWireGroup::MAX_BUSES];
+    uint8_t lens[ESPOneWireGroup::MAX_BUSES];
+    DallasDevice *devices[ESPOneWireGroup::MAX_BUSES];
+    uint8_t len = 0;
+    for (uint8_t i = 0; i < this->parallel_hubs_.size(); i++) {
+      auto &reads = this->parallel_hubs_[i]->parallel_reads_;
+      if (next[i] >= reads.size())
+        continue;
+      devices[i] = reads[next[i]++];
+      addresses[i] = devices[i]->get_address();
+      lens[i] = std::min(devices[i]->get_conversion_read(commands[i]), DALLAS_CONVERSION_READ_MAX);
+      len = std::max(len, lens[i]);
+      mask |= 1u << i;
+    }
+    if (mask == 0)
+      break;
+
+    uint8_t data[DALLAS_CONVERSION_READ_MAX][ESPOneWireGroup::MAX_BUSES];
+    uint32_t present = group->reset(mask);
+    group->write8(present, ONE_WIRE_ROM_SELECT);
+    group->write64(present, addresses);
+    group->write8(present, commands);
+    for (uint8_t b = 0; b < len; b++)
+      group->read8(present, data[b]);
+
+    for (uint8_t i = 0; i < this->parallel_hubs_.size(); i++) {
+      if (!(mask & (1u << i)))
+        continue;
+      uint8_t result[DALLAS_CONVERSION_READ_MAX];
+      for (uint8_t b = 0; b < lens[i]; b++)
+        result[b] = data[b][i];
+      devices[i]->finish_conversion_read(result, (present & (1u << i)) != 0);
+      count++;
+    }
   }
+  for (auto *hub : this->parallel_hubs_)
+    hub->parallel_reads_.clear();
+  this->parallel_bench_.set_count(count);
+  this->parallel_bench_.finish();
 }
 
 void DallasDevice::set_address(uint64_t address) { this->address_ = address; }
@@ -235,6 +984,7 @@ const std::string &DallasDevice::get_address_name() {
 void DallasDevice::dump_config() {
   //LOG_SENSOR("  ", "Device", this);
 	ESP_LOGCONFIG(TAG, "  Device Address: %s", this->get_address_name().c_str());
+  ESP_LOGCONFIG(TAG, "  Bus time: %uus", this->stats_.bus_us.get());
 }
 
 ESPOneWire *DallasDevice::get_reset_one_wire_() {
@@ -243,7 +993,118 @@ ESPOneWire *DallasDevice::get_reset_one_wire_() {
     ESP_LOGD(TAG, "parent is null");
     return nullptr;
   }
-  return parent->get_reset_one_wire_();
+  // skip devices known to be missing instead of failing on every access
+  if (!this->online_)
+    return nullptr;
+  this->stats_.transactions++;
+  auto *wire = parent->get_reset_one_wire_();
+  if (wire == nullptr)
+    this->stats_.presence_failures++;
+  return wire;
+}
+
+void DallasDevice::publish_stats() {
+  auto &stats = this->stats_;
+  auto &published = this->published_stats_;
+  if (this->transactions_sensor_ != nullptr)
+    this->transactions_sensor_->publish_state(stats.transactions);
+  if (this->crc_failures_sensor_ != nullptr)
+    this->crc_failures_sensor_->publish_state(stats.crc_failures);
+  if (this->presence_failures_sensor_ != nullptr)
+    this->presence_failures_sensor_->publish_state(stats.presence_failures);
+  if (this->retries_sensor_ != nullptr)
+    this->retries_sensor_->publish_state(stats.retries);
+  if (this->failure_rate_sensor_ != nullptr) {
+    uint32_t transactions = stats.transactions - published.transactions;
+    uint32_t failures = stats.crc_failures - published.crc_failures + stats.presence_failures -
+                        published.presence_failures;
+    if (transactions != 0)
+      this->failure_rate_sensor_->publish_state(std::min(100.0f, failures * 100.0f / transactions));
+  }
+  if (this->bus_time_sensor_ != nullptr)
+    this->bus_time_sensor_->publish_state((stats.bus_us - published.bus_us) / 1000.0f);
+  if (this->last_success_sensor_ != nullptr) {
+    if (stats.last_success != 0) {
+      this->last_success_sensor_->publish_state((millis() - stats.last_success) / 1000);
+    } else {
+      this->last_success_sensor_->publish_state(NAN);
+    }
+  }
+  published = stats;
+}
+
+void DallasDevice::submit_(uint8_t key, DallasPriority priority, std::function<void()> &&run) {
+  if (this->parent_ == nullptr) {
+    run();
+    return;
+  }
+  this->parent_->submit(this, key, priority, std::move(run));
+}
+
+bool DallasDevice::run_program_(OneWireProgram &program) {
+  auto *wire = this->get_reset_one_wire_();
+  if (wire == nullptr)
+    return false;
+  if (!program.execute(wire, this->address_)) {
+    ESP_LOGW(TAG, "%s: %s", this->get_address_name().c_str(), program.get_error());
+    this->transfer_failed_();
+    // programs only read or write fixed values, so running one again is harmless
+    this->stats_.retries++;
+    wire = this->get_reset_one_wire_();
+    if (wire == nullptr)
+      return false;
+    if (!program.execute(wire, this->address_)) {
+      ESP_LOGW(TAG, "%s: %s on retry", this->get_address_name().c_str(), program.get_error());
+      this->transfer_failed_();
+      return false;
+    }
+  }
+  this->transfer_ok_();
+  return true;
+}
+
+void DallasDevice::set_bus_timeout_(uint8_t key, uint32_t ms, std::function<void()> &&f) {
+  if (this->parent_ == nullptr)
+    return;
+  this->parent_->component_set_timeout(this->get_address_name() + "_seq" + to_string(key), ms, std::move(f));
+}
+
+void DallasDevice::transfer_failed_() {
+  this->stats_.crc_failures++;
+  auto *wire = this->get_one_wire_();
+  if (wire == nullptr)
+    return;
+  wire->count_transfer_error();
+  // the device may have missed the match, don't rely on its resume flag
+  wire->invalidate_resume();
+  if (!wire->is_overdrive_device(this->address_))
+    return;
+  ESP_LOGW(TAG, "%s failed at overdrive speed, using standard speed", this->get_address_name().c_str());
+  wire->set_overdrive_device(this->address_, false);
+}
+
+uint32_t DallasComponent::get_rom_cache_hash_() {
+  return fnv1_hash("dallas_rom_" + this->get_bus_summary_());
+}
+
+void DallasComponent::publish_bus_utilization_() {
+  if (this->one_wire_ == nullptr)
+    return;
+  uint32_t now = millis();
+  uint32_t bus_us = this->one_wire_->get_stats().bus_us;
+  uint32_t elapsed_ms = now - this->utilization_ms_;
+  if (this->bus_utilization_sensor_ != nullptr && this->utilization_ms_ != 0 && elapsed_ms != 0) {
+    float utilization = (bus_us - this->utilization_bus_us_) / (elapsed_ms * 10.0f);
+    this->bus_utilization_sensor_->publish_state(std::min(100.0f, utilization));
+  }
+  this->utilization_ms_ = now;
+  this->utilization_bus_us_ = bus_us;
+}
+
+std::string DallasComponent::get_bus_summary_() const {
+  if (this->pin_ != nullptr)
+    return this->pin_->dump_summary();
+  return this->one_wire_ != nullptr ? this->one_wire_->dump_summary() : "";
 }
 
 ESPOneWire *DallasComponent::get_reset_one_wire_() {
@@ -252,8 +1113,15 @@ ESPOneWire *DallasComponent::get_reset_one_wire_() {
     ESP_LOGD(TAG, "one wire is null");
     return nullptr;
   }
+  // blocking users of the bus wait for a running transaction
+#ifdef USE_ESP32
+  if (this->worker_ != nullptr && !this->worker_->in_worker())
+    this->worker_->wait_idle();
+#endif
+  if (this->async_ != nullptr && this->async_->is_busy())
+    this->async_->finish();
   {
-    InterruptLock lock;
+    OneWireLock lock(wire);
 
     if (!wire->reset()) {
       ESP_LOGD(TAG, "reset failed");
@@ -281,48 +1149,6 @@ std::string DallasGPIOPin::dump_summary() const {
   return buffer;
 }
 
-
-
-uint16_t crc16(const uint8_t *data, uint16_t len, uint16_t crc, uint16_t reverse_poly, bool refin, bool refout) {
-#ifdef USE_ESP32
-  if (reverse_poly == 0x8408) {
-    crc = crc16_le(refin ? crc : (crc ^ 0xffff), data, len);
-    return refout ? crc : (crc ^ 0xffff);
-  }
-#endif
-  if (refin) {
-    crc ^= 0xffff;
-  }
-  /*
-#ifndef USE_ESP32
-  if (reverse_poly == 0x8408) {
-    while (len--) {
-      uint8_t combo = crc ^ (uint8_t) *data++;
-      crc = (crc >> 8) ^ CRC16_8408_LE_LUT_L[combo & 0x0F] ^ CRC16_8408_LE_LUT_H[combo >> 4];
-    }
-  } else
-#endif
-      if (reverse_poly == 0xa001) {
-    while (len--) {
-      uint8_t combo = crc ^ (uint8_t) *data++;
-      crc = (crc >> 8) ^ CRC16_A001_LE_LUT_L[combo & 0x0F] ^ CRC16_A001_LE_LUT_H[combo >> 4];
-    }
-  } else */ {
-    while (len--) {
-      crc ^= *data++;
-      for (uint8_t i = 0; i < 8; i++) {
-        if (crc & 0x0001) {
-          crc = (crc >> 1) ^ reverse_poly;
-        } else {
-          crc >>= 1;
-        }
-      }
-    }
-  }
-  return refout ? (crc ^ 0xffff) : crc;
-}
-
-
 }  // namespace dallas
 }  // namespace esphome
 
@@ -1,8 +1,17 @@
 #pragma once
 
 #include "esphome/core/component.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esp_one_wire.h"
+#include "esp_one_wire_group.h"
+#include "esp_one_wire_async.h"
+#include "dallas_bus_worker.h"
+#include "dallas_crc.h"
+#include "one_wire_program.h"
+#include "uart_one_wire.h"
+#include "rmt_one_wire.h"
+#include "one_wire_sweep.h"
 
 #include <vector>
 
@@ -21,29 +30,177 @@ namespace dallas {
 
 class DallasDevice;
 class DallasSensor;
+class DallasSequence;
+
+static const uint8_t DALLAS_ROM_CACHE_SIZE = 32;
+
+/// Devices found by the last full search, stored in flash.
+struct DallasRomCache {
+  uint8_t count;
+  uint64_t roms[DALLAS_ROM_CACHE_SIZE];
+};
+
+/// Order in which queued bus work runs, lower first.
+enum DallasPriority : uint8_t {
+  DALLAS_PRIORITY_ACTUATOR,
+  DALLAS_PRIORITY_ALERT,
+  DALLAS_PRIORITY_SENSOR,
+  /// Reads on all parallel buses at once, they hold every bus of the group.
+  DALLAS_PRIORITY_PARALLEL,
+  DALLAS_PRIORITY_DISCOVERY,
+};
+
+/// Keys of the bus work the network and the sequencer queue for a device, devices use keys below these.
+static const uint8_t DALLAS_KEY_CONVERSION_READ = 0xF0;
+static const uint8_t DALLAS_KEY_ALERT = 0xF1;
+static const uint8_t DALLAS_KEY_SEQUENCE = 0xF2;
+/// Keys of the bus work a device queues for itself, a newer write or read replaces the queued one.
+static const uint8_t DALLAS_KEY_WRITE = 0;
+static const uint8_t DALLAS_KEY_READ = 1;
+/// Keys of the bus work a hub queues for the whole bus, without a device.
+static const uint8_t DALLAS_KEY_ALERT_POLL = 0;
+static const uint8_t DALLAS_KEY_CONVERSION = 1;
+static const uint8_t DALLAS_KEY_RECALIBRATE = 2;
+static const uint8_t DALLAS_KEY_SWEEP = 3;
+static const uint8_t DALLAS_KEY_PARALLEL_READ = 4;
+
+/// Bus work queued on a network.
+struct DallasTransaction {
+  DallasDevice *device;
+  uint8_t key;
+  DallasPriority priority;
+  std::function<void()> run;
+  /// Runs on the main loop after run, which then only touches the bus. Optional.
+  std::function<void()> complete;
+};
+
+enum DiscoveryState : uint8_t {
+  DISCOVERY_IDLE,
+  DISCOVERY_STARTING,
+  DISCOVERY_SEARCHING,
+  DISCOVERY_FINISHING,
+  DISCOVERY_DONE,
+};
 
 class DallasNetwork {
  public:
   void register_sensor(DallasDevice *sensor);
+  /// Discover the devices and set them up, blocking until done.
   virtual bool setup_sensors();
+  /// Start discovering the devices, discovery_step() then finds one device per call.
+  void start_discovery();
+  /// Run one step of the discovery, returns true when it is done.
+  bool discovery_step();
+  bool is_discovering() const {
+    return this->discovery_state_ != DISCOVERY_IDLE && this->discovery_state_ != DISCOVERY_DONE;
+  }
+  bool is_discovery_done() const { return this->discovery_state_ == DISCOVERY_DONE; }
+  /// Search the bus again, attaching new devices and marking missing ones offline.
+  void start_rescan();
+  /// Take devices offline when a discovery doesn't find them, and keep unfound devices pending.
+  void set_hotplug(bool hotplug) { this->hotplug_ = hotplug; }
   void dump_config();
 
   bool update_conversions();
+  /// Publish the reliability counters and bus time of the devices on this network.
+  void publish_device_stats();
+
+  /** Queue bus work for a device, it runs from the loop of the root network.
+   *
+   * Work for the same device and key that is still queued is replaced, keeping
+   * its place in the queue.
+   */
+  void submit(DallasDevice *device, uint8_t key, DallasPriority priority, std::function<void()> &&run,
+              std::function<void()> &&complete = {});
+  /// Run all queued actuator writes and then at most one other transaction, true if nothing is left.
+  bool run_transactions();
+  bool has_transactions() { return !this->get_root_network()->transactions_.empty(); }
+  /// No bus work is queued or running elsewhere, so lower priority work may use the bus.
+  bool is_bus_idle();
+  /// The network that owns the bus, branches forward their work to it.
+  virtual DallasNetwork *get_root_network() { return this; }
+
+  /// Keep the discovered devices in flash and verify them on boot instead of searching.
+  void set_rom_cache(bool rom_cache) { this->rom_cache_ = rom_cache; }
+  bool get_rom_cache() const { return this->rom_cache_; }
  protected:
   friend DallasDevice;
   virtual ESPOneWire *get_reset_one_wire_() = 0;
+  /// Get the bus without resetting it.
+  virtual ESPOneWire *get_one_wire_() = 0;
   virtual Component *get_component() = 0;
   std::vector<DallasDevice *> sensors_;
   std::vector<uint64_t> found_sensors_;
   virtual void component_set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) = 0;  // NOLINT
-  std::vector<uint64_t> search_vec();
+  /// Use the cache or Read ROM if possible, otherwise set up the search.
+  void begin_discovery_();
+  /// Find the next device of the current discovery family, 0 when there are no more.
+  uint64_t search_next_();
+  /// Set up the devices configured with this address.
+  void attach_address_(uint64_t address);
+  void attach_sensor_(DallasDevice *sensor);
+  /// Set up a device, its bus time goes to the device.
+  bool setup_device_(DallasDevice *sensor);
+  /// Bus time of the root bus so far, in µs.
+  uint32_t get_bus_us_();
+  /// Bind index based devices and set up the devices that weren't found.
+  void finish_discovery_();
+  virtual void on_discovery_finished_() {}
+  /// Collect the family codes of the registered devices, false if any device doesn't declare them.
+  bool get_family_codes_(std::vector<uint8_t> &families);
+  /// Discover the only device on the bus with Read ROM.
+  std::vector<uint64_t> read_rom_vec();
+  /// Schedule reading the conversion results, group readable devices go into parallel instead if given.
+  void schedule_conversion_reads_(std::vector<DallasDevice *> *parallel);
+  /// Queue reading the conversion result of a device, split in bus access and handling the result.
+  void submit_conversion_read_(DallasDevice *sensor);
+  /// Hand a split transaction to another thread, false if it has to run here.
+  virtual bool offload_transaction_(DallasTransaction &transaction) { return false; }
+  /// Whether this thread may use the bus now.
+  virtual bool is_bus_available_() { return true; }
+
+  /// Key of the rom cache, must be unique per network.
+  virtual uint32_t get_rom_cache_hash_() = 0;
+  /// Load the cached devices, empty if there is no cache or a device didn't answer.
+  std::vector<uint64_t> load_rom_cache_();
+  void save_rom_cache_(const std::vector<uint64_t> &roms);
+
+  bool rom_cache_{false};
+  /// The last discovery came from the rom cache and saw nothing of the devices that aren't cached.
+  bool rom_cache_used_{false};
+  ESPPreferenceObject rom_cache_pref_;
+
+  /// Discover with Read ROM instead of searching.
+  bool single_device_{false};
+  /// Number of devices the last discovery found. A search by family only counts the configured families
+  /// and the rom cache the cached devices, only a full search counts everything on the bus.
+  size_t bus_device_count_{0};
+
+  DiscoveryState discovery_state_{DISCOVERY_IDLE};
+  bool hotplug_{false};
+  bool rescanning_{false};
+  /// All devices found by the last discovery, sorted.
+  std::vector<uint64_t> bus_roms_;
+  bool discovery_successful_{true};
+  bool discovery_first_{true};
+  std::vector<uint64_t> discovery_roms_;
+  std::vector<uint8_t> discovery_families_;
+  size_t discovery_family_index_{0};
+  OneWireSearchState search_state_;
+  OneWireBenchmark discovery_bench_;
+  OneWireBenchmark update_bench_;
+  uint16_t pending_conversions_{0};
+  std::vector<DallasTransaction> transactions_;
 };
 
 class DallasComponent : public PollingComponent, public DallasNetwork {
  public:
   void set_pin(InternalGPIOPin *pin) { pin_ = pin; }
+  /// Use a bus master provided by another component instead of a pin.
+  void set_one_wire(ESPOneWire *one_wire) { one_wire_ = one_wire; }
 
   void setup() override;
+  void loop() override;
   void dump_config() override;
   //float get_setup_priority() const override { return setup_priority::DATA; }
   float get_setup_priority() const override { return setup_priority::BUS; }
@@ -56,16 +213,124 @@ class DallasComponent : public PollingComponent, public DallasNetwork {
   void start_alert_poller();
   void stop_alert_poller();
   void call_setup() override;
+  void set_benchmark(bool benchmark) { this->benchmark_ = benchmark; }
+  void set_resume(bool resume) { this->resume_ = resume; }
+  /// Force single-drop mode: discover with Read ROM and address with Skip ROM.
+  void set_single_device(bool single_device) { this->single_device_ = single_device; }
+  void set_rescan_interval(uint32_t rescan_interval) { this->rescan_interval_ = rescan_interval; }
+  void set_max_devices(uint16_t max_devices) { this->max_devices_ = max_devices; }
+  /// Run conversions and reads in the same time slots as the other parallel hubs, root is the first of
+  /// them and drives the group.
+  void set_parallel(DallasComponent *root) {
+    this->parallel_ = true;
+    this->parallel_root_ = root;
+  }
+  void set_lock_policy(OneWireLockPolicy lock_policy) { this->lock_policy_ = lock_policy; }
+  void set_max_lock_us(uint32_t max_lock_us) { this->max_lock_us_ = max_lock_us; }
+  /// Run the bus from a task pinned to this core instead of the main loop, ESP32 only.
+  void set_worker_core(int8_t worker_core) { this->worker_core_ = worker_core; }
+  /// Fit the slot timing to the bus at setup, and again when transfers keep failing.
+  void set_calibrate(bool calibrate) { this->calibrate_ = calibrate; }
+  /// Measure which slot timings read reliably once the devices are found, and use the fastest.
+  void set_timing_sweep(bool timing_sweep) { this->timing_sweep_ = timing_sweep; }
+
+#ifdef USE_DALLAS_INSTRUMENTATION
+  /// Longest time of each kind since the last update, in µs.
+  SUB_SENSOR(lock_time);
+  SUB_SENSOR(slot_time);
+  SUB_SENSOR(read_sample);
+  SUB_SENSOR(reset_time);
+  SUB_SENSOR(transaction_time);
+#endif
+  /// Share of the time the bus was busy since the last update, in percent.
+  SUB_SENSOR(bus_utilization);
+#ifdef USE_DALLAS_RMT
+  /// Generate the time slots with the RMT peripheral instead of bit-banging the pin, ESP32 only.
+  void set_rmt_channels(uint8_t tx_channel, uint8_t rx_channel) {
+    this->rmt_tx_channel_ = tx_channel;
+    this->rmt_rx_channel_ = rx_channel;
+  }
+#endif
 
  protected:
+  /// Convert on all parallel hubs, then read the results one device per bus at a time.
+  void update_parallel_();
+  void read_parallel_();
 
   ESPOneWire *get_reset_one_wire_() override;
+  ESPOneWire *get_one_wire_() override { return this->one_wire_; }
   Component *get_component() override { return this; }
+  uint32_t get_rom_cache_hash_() override;
+  void on_discovery_finished_() override;
+  /// Search the whole bus, whether the device found is the only one on it.
+  bool is_only_device_();
   void component_set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) override {set_timeout(name, timeout, std::move(f));}
+  bool offload_transaction_(DallasTransaction &transaction) override;
+  bool is_bus_available_() override;
+  bool has_worker_() const;
+  /// Start the conversion on all devices and schedule the reads, blocking.
+  void start_conversion_();
+  /// Calibrate the bus timing, counting transfer errors from here.
+  void calibrate_bus_();
+  /// Run one point of the timing sweep, queueing the next.
+  void sweep_step_();
+#ifdef USE_DALLAS_INSTRUMENTATION
+  void publish_instrumentation_();
+#endif
+  void publish_bus_utilization_();
+  std::string get_bus_summary_() const;
 
-  InternalGPIOPin *pin_;
-  ESPOneWire *one_wire_;
+  InternalGPIOPin *pin_{nullptr};
+  ESPOneWire *one_wire_{nullptr};
+  /// Sends the conversion broadcast without blocking, only without a bus task.
+  ESPOneWireAsync *async_{nullptr};
   uint32_t alert_update_interval_;
+  bool benchmark_{false};
+  bool resume_{true};
+  uint32_t rescan_interval_{SCHEDULER_DONT_RUN};
+  uint16_t max_devices_{255};
+  bool parallel_{false};
+  OneWireLockPolicy lock_policy_{ONE_WIRE_LOCK_TRANSACTION};
+  uint32_t max_lock_us_{0};
+  int8_t worker_core_{-1};
+  bool calibrate_{false};
+  bool timing_sweep_{false};
+  OneWireTimingSweep *sweep_{nullptr};
+  /// Transfer errors at the last calibration.
+  uint32_t calibrated_errors_{0};
+#ifdef USE_DALLAS_RMT
+  int8_t rmt_tx_channel_{-1};
+  int8_t rmt_rx_channel_{-1};
+#endif
+  /// millis() and bus time at the last utilization publish.
+  uint32_t utilization_ms_{0};
+  uint32_t utilization_bus_us_{0};
+#ifdef USE_ESP32
+  DallasBusWorker *worker_{nullptr};
+#endif
+  /// Devices waiting for a group read, in order.
+  std::vector<DallasDevice *> parallel_reads_;
+  OneWireBenchmark parallel_bench_;
+  /// The first parallel hub, its group and hubs hold the buses of all of them.
+  DallasComponent *parallel_root_{nullptr};
+  ESPOneWireGroup parallel_group_;
+  std::vector<DallasComponent *> parallel_hubs_;
+};
+
+/// Reliability counters of one device.
+struct DallasDeviceStats {
+  /// Transactions started, each one begins with a bus reset.
+  OneWireCounter transactions{0};
+  /// Transfers that failed a check: CRC, confirm byte or complemented data.
+  OneWireCounter crc_failures{0};
+  /// Transactions that found no device on the bus.
+  OneWireCounter presence_failures{0};
+  /// Transfers repeated after a failed check.
+  OneWireCounter retries{0};
+  /// millis() of the last transfer that passed its check, 0 if none yet.
+  OneWireCounter last_success{0};
+  /// Bus time of the work done for this device, in µs.
+  OneWireCounter bus_us{0};
 };
 
 class DallasDevice {
@@ -83,25 +348,75 @@ class DallasDevice {
   optional<uint8_t> get_index() const;
   /// Set the index of this sensor. If using index, address will be set after setup.
   void set_index(uint8_t index);
+  /// Whether the device has been found and set up.
+  bool is_attached() const { return this->attached_; }
+  /// Whether the device was present at the last discovery, offline devices aren't accessed.
+  bool is_online() const { return this->online_; }
+  /// Address this device at overdrive speed, falls back to standard speed on errors.
+  void set_overdrive(bool overdrive) { this->overdrive_ = overdrive; }
+  bool get_overdrive() const { return this->overdrive_; }
 
   /// Get the number of milliseconds we have to wait for the conversion phase.
   uint16_t virtual millis_to_wait_for_conversion() const { return 0; };
 
   bool virtual is_supported(uint8_t *address8) { return false; }
+  /// Add the family codes this device can have, used to search only for those. False if unknown.
+  bool virtual get_family_codes(std::vector<uint8_t> &families) { return false; }
+  /// Whether devices are connected behind this one, so it can't be the only device on the bus.
+  bool virtual has_branches() const { return false; }
+  /// Whether the device has to be addressed with Match ROM, even as the only device on the bus.
+  bool virtual needs_match_rom() const { return false; }
   bool virtual setup_sensor() { return false; };
   void virtual dump_config();
   void virtual read_conversion() {};
+  /// Length of the conversion result read after sending command, 0 if it can't be read as part of a group.
+  uint8_t virtual get_conversion_read(uint8_t &command) { return 0; }
+  /// Handle a conversion result read as part of a group, ok is false if the bus didn't answer.
+  void virtual finish_conversion_read(const uint8_t *data, bool ok) {}
   void virtual notify_alerting() {};
 
+  const DallasDeviceStats &get_stats() const { return this->stats_; }
+  /// Publish the counters to the diagnostic sensors that are set.
+  void publish_stats();
+  SUB_SENSOR(transactions);
+  SUB_SENSOR(crc_failures);
+  SUB_SENSOR(presence_failures);
+  SUB_SENSOR(retries);
+  /// Failed transactions since the last publish, in percent.
+  SUB_SENSOR(failure_rate);
+  /// Seconds since the last transfer that passed its check.
+  SUB_SENSOR(last_success);
+  /// Bus time since the last publish, in ms.
+  SUB_SENSOR(bus_time);
+
  protected:
   DallasNetwork *parent_{nullptr};
   uint64_t address_{0U};
   optional<uint8_t> index_;
   std::string address_name_;
+  bool overdrive_{false};
+  bool attached_{false};
+  bool online_{true};
+  friend DallasNetwork;
   
- // ESPOneWire *get_one_wire_() { return this->parent_ ? this->parent_->one_wire_ : nullptr; }
+  ESPOneWire *get_one_wire_() { return this->parent_ ? this->parent_->get_one_wire_() : nullptr; }
   ESPOneWire *get_reset_one_wire_();
+  /// Report a failed CRC or confirm byte, drops the device back to standard speed and full ROM matching.
+  void transfer_failed_();
+  /// Report a transfer that passed its check.
+  void transfer_ok_() { this->stats_.last_success = millis(); }
   void status_set_warning() { this->parent_->get_component()->status_set_warning(); }
+  /// Queue bus work on the network, key tells apart the kinds of work of this device.
+  void submit_(uint8_t key, DallasPriority priority, std::function<void()> &&run);
+  /// Reset the bus and run a program on this device, a failed check counts as a failed transfer.
+  bool run_program_(OneWireProgram &program);
+  /// Run f after ms without holding the bus, a newer timeout with the same key replaces it.
+  void set_bus_timeout_(uint8_t key, uint32_t ms, std::function<void()> &&f);
+  friend class DallasSequence;
+
+  DallasDeviceStats stats_;
+  /// Counters at the last publish, for the failure rate.
+  DallasDeviceStats published_stats_;
 };
 
 class DallasSensor : public sensor::Sensor, public DallasDevice {
@@ -142,7 +457,5 @@ class DallasGPIOPin : public GPIOPin {
   gpio::Flags flags_;
 };
 
-uint16_t crc16(const uint8_t *data, uint16_t len, uint16_t crc, uint16_t reverse_poly, bool refin, bool refout);
-
 }  // namespace dallas
 }  // namespace esphome
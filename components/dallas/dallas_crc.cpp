@@ -0,0 +1,46 @@
+#include "dallas_crc.h"
+
+namespace esphome {
+namespace dallas {
+
+uint16_t crc16(const uint8_t *data, uint16_t len, uint16_t crc, uint16_t reverse_poly, bool refin, bool refout) {
+#ifdef USE_ESP32
+  if (reverse_poly == 0x8408) {
+    crc = crc16_le(refin ? crc : (crc ^ 0xffff), data, len);
+    return refout ? crc : (crc ^ 0xffff);
+  }
+#endif
+  if (refin) {
+    crc ^= 0xffff;
+  }
+  /*
+#ifndef USE_ESP32
+  if (reverse_poly == 0x8408) {
+    while (len--) {
+      uint8_t combo = crc ^ (uint8_t) *data++;
+      crc = (crc >> 8) ^ CRC16_8408_LE_LUT_L[combo & 0x0F] ^ CRC16_8408_LE_LUT_H[combo >> 4];
+    }
+  } else
+#endif
+      if (reverse_poly == 0xa001) {
+    while (len--) {
+      uint8_t combo = crc ^ (uint8_t) *data++;
+      crc = (crc >> 8) ^ CRC16_A001_LE_LUT_L[combo & 0x0F] ^ CRC16_A001_LE_LUT_H[combo >> 4];
+    }
+  } else */ {
+    while (len--) {
+      crc ^= *data++;
+      for (uint8_t i = 0; i < 8; i++) {
+        if (crc & 0x0001) {
+          crc = (crc >> 1) ^ reverse_poly;
+        } else {
+          crc >>= 1;
+        }
+      }
+    }
+  }
+  return refout ? (crc ^ 0xffff) : crc;
+}
+
+}  // namespace dallas
+}  // namespace esphome
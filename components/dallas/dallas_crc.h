@@ -0,0 +1,12 @@
+#pragma once
+
+#include "esphome/core/helpers.h"
+#include <cstdint>
+
+namespace esphome {
+namespace dallas {
+
+uint16_t crc16(const uint8_t *data, uint16_t len, uint16_t crc, uint16_t reverse_poly, bool refin, bool refout);
+
+}  // namespace dallas
+}  // namespace esphome
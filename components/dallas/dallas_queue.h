@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace esphome {
+namespace dallas {
+
+/** Fixed size queue for one producer and one consumer thread, without locks.
+ *
+ * Holds up to N - 1 items.
+ */
+template<typename T, size_t N> class DallasSPSCQueue {
+ public:
+  /// Producer side, false if the queue is full.
+  bool push(const T &item) {
+    size_t head = this->head_.load(std::memory_order_relaxed);
+    size_t next = (head + 1) % N;
+    if (next == this->tail_.load(std::memory_order_acquire))
+      return false;
+    this->items_[head] = item;
+    this->head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer side, false if the queue is empty.
+  bool pop(T &item) {
+    size_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (tail == this->head_.load(std::memory_order_acquire))
+      return false;
+    item = this->items_[tail];
+    this->tail_.store((tail + 1) % N, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return this->head_.load(std::memory_order_acquire) == this->tail_.load(std::memory_order_acquire);
+  }
+  bool full() const {
+    return (this->head_.load(std::memory_order_acquire) + 1) % N == this->tail_.load(std::memory_order_acquire);
+  }
+
+ protected:
+  T items_[N];
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,42 @@
+#include "dallas_sequence.h"
+
+namespace esphome {
+namespace dallas {
+
+DallasSequence::DallasSequence(DallasDevice *device, DallasPriority priority, uint8_t key)
+    : state_(std::make_shared<State>()) {
+  this->state_->device = device;
+  this->state_->priority = priority;
+  this->state_->key = key;
+}
+
+DallasSequence &DallasSequence::then(std::function<bool()> &&step) {
+  this->state_->steps.push_back({std::move(step), 0});
+  return *this;
+}
+
+DallasSequence &DallasSequence::sleep(uint32_t ms) {
+  this->state_->steps.push_back({nullptr, ms});
+  return *this;
+}
+
+void DallasSequence::run() { next_(this->state_); }
+
+void DallasSequence::next_(const std::shared_ptr<State> &state) {
+  if (state->next >= state->steps.size())
+    return;
+  auto &step = state->steps[state->next++];
+  auto *device = state->device;
+  if (step.sleep_ms != 0) {
+    device->set_bus_timeout_(state->key, step.sleep_ms, [state]() { next_(state); });
+    return;
+  }
+  // the same key keeps a restarted sequence from queueing the step twice
+  device->submit_(state->key, state->priority, [state, &step]() {
+    if (step.work())
+      next_(state);
+  });
+}
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "dallas_component.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace esphome {
+namespace dallas {
+
+/** A device's bus work written as a list of steps and waits.
+ *
+ * Every step runs as its own queued transaction and waits don't hold the
+ * bus, so other devices use it while this one waits for a conversion.
+ *
+ *   DallasSequence(this, DALLAS_PRIORITY_SENSOR)
+ *       .then([this]() { return this->start_conversion(); })
+ *       .sleep(10)
+ *       .then([this]() { return this->read_result(); })
+ *       .run();
+ */
+class DallasSequence {
+ public:
+  DallasSequence(DallasDevice *device, DallasPriority priority, uint8_t key = DALLAS_KEY_SEQUENCE);
+
+  /// Add a bus step, returning false ends the sequence.
+  DallasSequence &then(std::function<bool()> &&step);
+  /// Wait before the next step.
+  DallasSequence &sleep(uint32_t ms);
+  /// Queue the first step, the sequence keeps itself alive until it is done.
+  void run();
+
+ protected:
+  struct Step {
+    std::function<bool()> work;
+    uint32_t sleep_ms;
+  };
+  struct State {
+    DallasDevice *device;
+    DallasPriority priority;
+    uint8_t key;
+    std::vector<Step> steps;
+    size_t next{0};
+  };
+
+  static void next_(const std::shared_ptr<State> &state);
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace dallas
+}  // namespace esphome
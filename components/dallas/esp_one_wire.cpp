@@ -2,6 +2,9 @@
 #include "esphome/core/log.h"
 #include "esphome/core/helpers.h"
 
+#include <algorithm>
+#include <new>
+
 namespace esphome {
 namespace dallas {
 
@@ -10,43 +13,181 @@ static const char *const TAG = "dallas.one_wire";
 const uint8_t ONE_WIRE_ROM_SELECT = 0x55;
 const uint8_t ONE_WIRE_ROM_SEARCH = 0xF0;
 const uint8_t ONE_WIRE_ROM_ACTIVE_SEARCH = 0xEC;
+const uint8_t ONE_WIRE_ROM_OVERDRIVE_SKIP = 0x3C;
+const uint8_t ONE_WIRE_ROM_OVERDRIVE_SELECT = 0x69;
+const uint8_t ONE_WIRE_ROM_RESUME = 0xA5;
+const uint8_t ONE_WIRE_ROM_SKIP = 0xCC;
+const uint8_t ONE_WIRE_ROM_READ = 0x33;
+
+static const uint8_t DALLAS_MODEL_DS2408 = 0x29;
+static const uint8_t DALLAS_MODEL_DS2413 = 0x3A;
+static const uint8_t DALLAS_MODEL_DS28EA00 = 0x42;
+
+// only some families implement Resume ROM, the rest would ignore it
+static bool supports_resume(uint64_t address) {
+  switch (address & 0xff) {
+    case DALLAS_MODEL_DS2408:
+    case DALLAS_MODEL_DS2413:
+    case DALLAS_MODEL_DS28EA00:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Unfortunately some frameworks have different characteristics than others
+// esp32 arduino appears to pull the bus low only after the digital_write(false),
+// whereas on esp-idf it already happens during the pin_mode(OUTPUT)
+// manually correct for this with the read sample constants.
+static const OneWireTiming ONE_WIRE_STANDARD_TIMING = {
+    .reset_low = 480,
+    .presence_sample = 70,
+    .reset_tail = 410,
+    .slot = 60,
+    .write0_low = 55,
+    .write1_low = 6,
+    .read_low = 3,
+#ifdef USE_ESP32
+    .read_sample = 12,
+#else
+    .read_sample = 14,
+#endif
+};
+
+// overdrive slots are 10µs, the master has to sample within 2µs of the slot start
+static const OneWireTiming ONE_WIRE_OVERDRIVE_TIMING = {
+    .reset_low = 70,
+    .presence_sample = 9,
+    .reset_tail = 40,
+    .slot = 10,
+    .write0_low = 8,
+    .write1_low = 1,
+    .read_low = 1,
+    .read_sample = 2,
+};
+
+ESPOneWire::ESPOneWire(InternalGPIOPin *pin) {
+  pin_ = pin->to_isr();
+  pin_number_ = pin->get_pin();
+  standard_timing_ = ONE_WIRE_STANDARD_TIMING;
+}
+
+ESPOneWire::ESPOneWire() {
+  bit_banged_ = false;
+  standard_timing_ = ONE_WIRE_STANDARD_TIMING;
+}
+
+std::string ESPOneWire::dump_summary() const { return str_sprintf("GPIO%u", this->pin_number_); }
 
-ESPOneWire::ESPOneWire(InternalGPIOPin *pin) { pin_ = pin->to_isr(); }
+const OneWireTiming &ESPOneWire::timing_() const {
+  return this->overdrive_ ? ONE_WIRE_OVERDRIVE_TIMING : this->standard_timing_;
+}
 
 bool HOT IRAM_ATTR ESPOneWire::reset() {
+  // a standard speed reset returns all devices to standard speed
+  this->overdrive_ = false;
+  bool r = this->reset_(false);
+  if (!r)
+    this->resume_address_ = 0;
+  return r;
+}
+
+bool HOT IRAM_ATTR ESPOneWire::reset_overdrive() {
+  this->overdrive_ = true;
+  bool r = this->reset_(true);
+  if (!r)
+    this->resume_address_ = 0;
+  return r;
+}
+
+bool HOT IRAM_ATTR ESPOneWire::reset_(bool overdrive) {
+  auto &timing = overdrive ? ONE_WIRE_OVERDRIVE_TIMING : this->standard_timing_;
   // See reset here:
   // https://www.maximintegrated.com/en/design/technical-documents/app-notes/1/126.html
+  uint32_t start = micros();
+  this->stats_.resets++;
   // Wait for communication to clear (delay G)
   pin_.pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
   uint8_t retries = 125;
   do {
-    if (--retries == 0)
+    if (--retries == 0) {
+      this->stats_.presence_failures++;
+      this->stats_.bus_us += micros() - start;
+      ONE_WIRE_RECORD(this, reset, micros() - start);
       return false;
+    }
     delayMicroseconds(2);
   } while (!pin_.digital_read());
 
-  // Send 480µs LOW TX reset pulse (drive bus low, delay H)
+  // at standard speed only the presence sample is timing critical, the low time and the tail may stretch.
+  // The overdrive low has to stay within 80µs, a longer one is a standard reset.
+  bool relock = this->locked_;
+  if (overdrive) {
+    this->lock_();
+  } else {
+    this->unlock_();
+  }
+
+  // Send LOW TX reset pulse, 480µs at standard speed (drive bus low, delay H)
   pin_.pin_mode(gpio::FLAG_OUTPUT);
   pin_.digital_write(false);
-  delayMicroseconds(480);
+  delayMicroseconds(timing.reset_low);
 
+  if (!overdrive)
+    this->lock_();
   // Release the bus, delay I
   pin_.pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
-  delayMicroseconds(70);
+  delayMicroseconds(timing.presence_sample);
 
   // sample bus, 0=device(s) present, 1=no device present
   bool r = !pin_.digital_read();
+  this->unlock_();
   // delay J
-  delayMicroseconds(410);
+  delayMicroseconds(timing.reset_tail);
+  if (relock)
+    this->lock_();
+  if (!r)
+    this->stats_.presence_failures++;
+  this->stats_.bus_us += micros() - start;
+  ONE_WIRE_RECORD(this, reset, micros() - start);
   return r;
 }
 
-uint32_t lastbit{0};
+bool ESPOneWire::reset_start_() {
+  pin_.pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
+  if (!pin_.digital_read())
+    return false;
+  this->overdrive_ = false;
+  // the bytes that follow aren't known here, so don't rely on a resume
+  this->resume_address_ = 0;
+  this->stats_.resets++;
+  pin_.pin_mode(gpio::FLAG_OUTPUT);
+  pin_.digital_write(false);
+  return true;
+}
+
+bool HOT IRAM_ATTR ESPOneWire::reset_presence_() {
+  auto &timing = this->standard_timing_;
+  bool locked = this->lock_();
+  pin_.pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
+  delayMicroseconds(timing.presence_sample);
+  bool r = !pin_.digital_read();
+  if (locked)
+    this->unlock_();
+  if (!r) {
+    this->stats_.presence_failures++;
+    this->resume_address_ = 0;
+  }
+  return r;
+}
 
 void HOT IRAM_ATTR ESPOneWire::write_bit(bool bit) {
-  while((micros()-lastbit)<60)
+  auto &timing = this->timing_();
+  uint32_t slot_start = micros();
+  while((micros()-this->last_slot_)<timing.slot)
     ;
-  lastbit = micros();
+  bool locked = this->lock_();
+  this->last_slot_ = micros();
 
   // drive bus low
   pin_.pin_mode(gpio::FLAG_OUTPUT);
@@ -60,21 +201,28 @@ void HOT IRAM_ATTR ESPOneWire::write_bit(bool bit) {
   // ds18b20 appears to read the bus after roughly 14µs
 //  uint32_t delay0 = bit ? 6 : 60;
 //  uint32_t delay1 = bit ? 54 : 5;
-  uint32_t delay0 = bit ? 6 : 55;
- uint32_t delay1 = bit ? 1 : 1;
+  uint32_t delay0 = bit ? timing.write1_low : timing.write0_low;
 
   // delay A/C
   delayMicroseconds(delay0);
   // release bus
   pin_.digital_write(true);
-  // delay B/D
-  delayMicroseconds(delay1);
+  // delay B/D, the rest of the slot is waited out before the next one starts
+  delayMicroseconds(1);
+  if (locked)
+    this->unlock_();
+  this->stats_.slots++;
+  this->stats_.bus_us += micros() - slot_start;
+  ONE_WIRE_RECORD(this, slot, micros() - this->last_slot_);
 }
 
 bool HOT IRAM_ATTR ESPOneWire::read_bit() {
-  while((micros()-lastbit)<60)
+  auto &timing = this->timing_();
+  uint32_t slot_start = micros();
+  while((micros()-this->last_slot_)<timing.slot)
     ;
-  lastbit = micros();
+  bool locked = this->lock_();
+  this->last_slot_ = micros();
 
   // drive bus low
   pin_.pin_mode(gpio::FLAG_OUTPUT);
@@ -88,29 +236,24 @@ bool HOT IRAM_ATTR ESPOneWire::read_bit() {
 
   uint32_t start = micros();
   // datasheet says >1µs
-  delayMicroseconds(3);
+  delayMicroseconds(timing.read_low);
 
   // release bus, delay E
   pin_.pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
 
-  // Unfortunately some frameworks have different characteristics than others
-  // esp32 arduino appears to pull the bus low only after the digital_write(false),
-  // whereas on esp-idf it already happens during the pin_mode(OUTPUT)
-  // manually correct for this with these constants.
-
-#ifdef USE_ESP32
-  uint32_t timing_constant = 12;
-#else
-  uint32_t timing_constant = 14;
-#endif
-
   // measure from start value directly, to get best accurate timing no matter
   // how long pin_mode/delayMicroseconds took
-  while (micros() - start < timing_constant)
+  while (micros() - start < timing.read_sample)
     ;
 
   // sample bus to read bit from peer
   bool r = pin_.digital_read();
+  ONE_WIRE_RECORD(this, read_sample, micros() - this->last_slot_);
+  if (locked)
+    this->unlock_();
+  this->stats_.slots++;
+  this->stats_.bus_us += micros() - slot_start;
+  ONE_WIRE_RECORD(this, slot, micros() - this->last_slot_);
 
 /*
   // wait for 0 to end
@@ -133,41 +276,228 @@ bool HOT IRAM_ATTR ESPOneWire::read_bit() {
 }
 
 void IRAM_ATTR ESPOneWire::write8(uint8_t val) {
+  this->yield_lock_();
+  bool locked = this->lock_policy_ == ONE_WIRE_LOCK_BYTE && this->lock_();
   for (uint8_t i = 0; i < 8; i++) {
     this->write_bit(bool((1u << i) & val));
   }
+  if (locked)
+    this->unlock_();
 }
 
 void IRAM_ATTR ESPOneWire::write64(uint64_t val) {
-  for (uint8_t i = 0; i < 64; i++) {
-    this->write_bit(bool((1ULL << i) & val));
+  for (uint8_t i = 0; i < 8; i++) {
+    this->write8(val >> (i * 8));
   }
 }
 
 uint8_t IRAM_ATTR ESPOneWire::read8() {
+  this->yield_lock_();
+  bool locked = this->lock_policy_ == ONE_WIRE_LOCK_BYTE && this->lock_();
   uint8_t ret = 0;
   for (uint8_t i = 0; i < 8; i++) {
     ret |= (uint8_t(this->read_bit()) << i);
   }
+  if (locked)
+    this->unlock_();
   return ret;
 }
 uint64_t IRAM_ATTR ESPOneWire::read64() {
   uint64_t ret = 0;
   for (uint8_t i = 0; i < 8; i++) {
-    ret |= (uint64_t(this->read_bit()) << i);
+    ret |= uint64_t(this->read8()) << (i * 8);
   }
   return ret;
 }
+
+// a device holding the bus for a 0 releases it 15µs after the slot start at the earliest
+static const uint8_t ONE_WIRE_READ_VALID_US = 15;
+// max slot length, the bus has to rise within it
+static const uint8_t ONE_WIRE_CALIBRATE_MAX_RISE_US = 60;
+static const uint8_t ONE_WIRE_CALIBRATE_ROUNDS = 8;
+
+bool ESPOneWire::calibrate() {
+  if (!this->bit_banged_)
+    return true;
+  // after a reset devices wait for a ROM command, the short pulses look like 1 bits to them
+  // and the reset at the end makes them forget those
+  {
+    OneWireLock lock(this);
+    if (!this->reset())
+      return false;
+  }
+  uint32_t latency = 0;
+  uint32_t rise = 0;
+  for (uint8_t i = 0; i < ONE_WIRE_CALIBRATE_ROUNDS; i++) {
+    uint32_t start, low, released, high;
+    {
+      InterruptLock lock;
+      start = micros();
+      pin_.pin_mode(gpio::FLAG_OUTPUT);
+      pin_.digital_write(false);
+      low = micros();
+      delayMicroseconds(1);
+      released = micros();
+      pin_.pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
+      while (!pin_.digital_read() && micros() - released < ONE_WIRE_CALIBRATE_MAX_RISE_US)
+        ;
+      high = micros();
+    }
+    latency = std::max(latency, low - start);
+    rise = std::max(rise, high - released);
+    delayMicroseconds(this->standard_timing_.slot);
+  }
+  {
+    OneWireLock lock(this);
+    this->reset();
+  }
+  if (rise >= ONE_WIRE_CALIBRATE_MAX_RISE_US) {
+    ESP_LOGW(TAG, "GPIO%u: bus stays low, keeping the slot timing", this->pin_number_);
+    return false;
+  }
+
+  OneWireTiming timing = ONE_WIRE_STANDARD_TIMING;
+  // a 1 has to have risen by the sample point, with a µs to spare for the micros() resolution
+  uint32_t sample = timing.read_low + latency + rise + 1;
+  if (sample >= ONE_WIRE_READ_VALID_US) {
+    ESP_LOGW(TAG, "GPIO%u: bus rises in %uµs, too slow to read reliably", this->pin_number_, rise);
+    return false;
+  }
+  timing.read_sample = sample;
+  // the bus has to be back up after a 0 before the next slot starts
+  timing.slot = std::max<uint32_t>(timing.slot, timing.write0_low + latency + rise + 1);
+  this->standard_timing_ = timing;
+  ESP_LOGD(TAG, "GPIO%u: latency %uµs, rise %uµs, sampling at %uµs, %uµs slots", this->pin_number_, latency, rise,
+           timing.read_sample, timing.slot);
+  return true;
+}
+
+void ESPOneWire::read_bytes(uint8_t *data, uint16_t len) {
+  for (uint16_t i = 0; i < len; i++)
+    data[i] = this->read8();
+}
+
+bool IRAM_ATTR ESPOneWire::lock_() {
+  if (this->locked_ || !this->bit_banged_)
+    return false;
+  new (this->lock_storage_) InterruptLock();
+  this->locked_ = true;
+  this->lock_start_ = micros();
+  return true;
+}
+
+void IRAM_ATTR ESPOneWire::unlock_() {
+  if (!this->locked_)
+    return;
+  uint32_t held = micros() - this->lock_start_;
+  reinterpret_cast<InterruptLock *>(this->lock_storage_)->~InterruptLock();
+  this->locked_ = false;
+  this->stats_.locked_us += held;
+  if (held > this->stats_.max_locked_us)
+    this->stats_.max_locked_us = held;
+  ONE_WIRE_RECORD(this, lock, held);
+}
+
+void IRAM_ATTR ESPOneWire::yield_lock_(uint8_t slots) {
+  if (!this->locked_ || this->max_lock_us_ == 0)
+    return;
+  // slots may be stretched between bytes, so pending interrupts can run here
+  uint32_t next_us = slots * this->timing_().slot;
+  if (micros() - this->lock_start_ + next_us > this->max_lock_us_) {
+    this->unlock_();
+    this->lock_();
+  }
+}
 void IRAM_ATTR ESPOneWire::select(uint64_t address) {
+  if (!this->overdrive_ && this->is_overdrive_device(address)) {
+    this->select_overdrive(address);
+    return;
+  }
+  if (this->single_device_) {
+    this->skip();
+    return;
+  }
+  if (this->resume_ && address != 0 && address == this->resume_address_) {
+    // the device is still flagged from the last match, every other device stays deselected
+    this->write8(ONE_WIRE_ROM_RESUME);
+    return;
+  }
   this->write8(ONE_WIRE_ROM_SELECT);
   this->write64(address);
+  this->resume_address_ = supports_resume(address) ? address : 0;
+}
+
+uint64_t IRAM_ATTR ESPOneWire::read_rom() {
+  this->write8(ONE_WIRE_ROM_READ);
+  this->resume_address_ = 0;
+  return this->read64();
+}
+
+void IRAM_ATTR ESPOneWire::skip_overdrive() {
+  // command at standard speed, everything after it at overdrive speed
+  this->write8(ONE_WIRE_ROM_OVERDRIVE_SKIP);
+  this->overdrive_ = true;
+  this->resume_address_ = 0;
+}
+
+void IRAM_ATTR ESPOneWire::select_overdrive(uint64_t address) {
+  if (this->single_device_) {
+    this->skip_overdrive();
+    return;
+  }
+  // command at standard speed, ROM and everything after it at overdrive speed
+  this->resume_address_ = 0;
+  this->write8(ONE_WIRE_ROM_OVERDRIVE_SELECT);
+  this->overdrive_ = true;
+  this->write64(address);
+}
+
+void ESPOneWire::set_overdrive_device(uint64_t address, bool overdrive) {
+  auto it = std::find(this->overdrive_devices_.begin(), this->overdrive_devices_.end(), address);
+  if (overdrive && it == this->overdrive_devices_.end()) {
+    this->overdrive_devices_.push_back(address);
+  } else if (!overdrive && it != this->overdrive_devices_.end()) {
+    this->overdrive_devices_.erase(it);
+  }
+}
+
+bool ESPOneWire::is_overdrive_device(uint64_t address) const {
+  for (auto addr : this->overdrive_devices_) {
+    if (addr == address)
+      return true;
+  }
+  return false;
 }
-static int search_count = 0;
 void IRAM_ATTR ESPOneWire::reset_search() {
-  search_count = 0;
+  this->search_count_ = 0;
   this->last_discrepancy_ = 0;
   this->last_device_flag_ = false;
   this->rom_number_ = 0;
+  this->target_family_ = 0;
+}
+void IRAM_ATTR ESPOneWire::reset_search(uint8_t family) {
+  this->reset_search();
+  // target setup: start with the family code and take the 1 branch at the last bit,
+  // so the first device found is the lowest one with that family code
+  this->rom_number_ = family;
+  this->last_discrepancy_ = 64;
+  this->target_family_ = family;
+}
+OneWireSearchState ESPOneWire::get_search_state() const {
+  OneWireSearchState state;
+  state.rom_number = this->rom_number_;
+  state.last_discrepancy = this->last_discrepancy_;
+  state.last_device_flag = this->last_device_flag_;
+  state.target_family = this->target_family_;
+  state.count = this->search_count_;
+  return state;
+}
+void ESPOneWire::set_search_state(const OneWireSearchState &state) {
+  this->rom_number_ = state.rom_number;
+  this->last_discrepancy_ = state.last_discrepancy;
+  this->last_device_flag_ = state.last_device_flag;
+  this->target_family_ = state.target_family;
+  this->search_count_ = state.count;
 }
 uint64_t ESPOneWire::search() {
   return perform_search(ONE_WIRE_ROM_SEARCH);
@@ -180,6 +510,7 @@ uint64_t ESPOneWire::search_select(uint64_t addr, uint8_t cmd) {
   this->last_discrepancy_ = 64;
   this->last_device_flag_ = false;
   this->rom_number_ = addr;
+  this->search_count_ = 0;
   return this->perform_search(cmd);
 }
 
@@ -214,8 +545,14 @@ uint64_t IRAM_ATTR ESPOneWire::perform_search(uint8_t cmd) {
   if (this->last_device_flag_) {
     return 0u;
   }
+  // the search clears the resume flag of all devices
+  this->resume_address_ = 0;
 
-if(search_count++ > 20) return 0u;
+  if (this->max_devices_ != 0 && this->search_count_ >= this->max_devices_) {
+    ESP_LOGW(TAG, "Search stopped after %u devices, increase max_devices", this->search_count_);
+    return 0u;
+  }
+  this->search_count_++;
 
   uint8_t id_bit_number = 1;
   uint8_t last_zero = 0;
@@ -224,7 +561,7 @@ if(search_count++ > 20) return 0u;
   uint8_t rom_byte_mask = 1;
 
   {
-    InterruptLock lock;
+    OneWireLock lock(this);
     // Initiate search
     this->write8(cmd);
     do {
@@ -236,6 +573,8 @@ if(search_count++ > 20) return 0u;
         branch = id_bit_number == this->last_discrepancy_;
       }
 
+      // a search is 192 slots, interrupts may run between the triplets
+      this->yield_lock_(3);
       auto tbit = this->tribit(branch);
 
       // read bit
@@ -283,6 +622,14 @@ if(search_count++ > 20) return 0u;
   }
 
   search_result = search_result && (this->rom_number8_()[0] != 0);
+  if (search_result && this->target_family_ != 0) {
+    // no device of the family, the search ended up on the next family
+    if (this->rom_number8_()[0] != this->target_family_)
+      search_result = false;
+    // the next discrepancy is inside the family code, so this was the last one of the family
+    else if (this->last_discrepancy_ <= 8)
+      this->last_device_flag_ = true;
+  }
   if (!search_result) {
     this->reset_search();
     return 0u;
@@ -296,7 +643,7 @@ std::vector<uint64_t> ESPOneWire::search_vec() {
   this->reset_search();
   while ( true ) {
     {
-      InterruptLock lock;
+      OneWireLock lock(this);
       if (!this->reset()) {
         // Reset failed or no devices present
         this->reset_search();
@@ -312,7 +659,30 @@ std::vector<uint64_t> ESPOneWire::search_vec() {
 }
 
 void IRAM_ATTR ESPOneWire::skip() {
-  this->write8(0xCC);  // skip ROM
+  this->write8(ONE_WIRE_ROM_SKIP);
+  this->resume_address_ = 0;
+}
+
+void OneWireBenchmark::begin(ESPOneWire *wire, const char *op) {
+  this->finish();
+  if (wire == nullptr || !wire->get_benchmark())
+    return;
+  this->wire_ = wire;
+  this->op_ = op;
+  this->count_ = 0;
+  this->start_us_ = micros();
+  this->start_stats_ = wire->get_stats();
+}
+
+void OneWireBenchmark::finish() {
+  if (this->wire_ == nullptr)
+    return;
+  auto &stats = this->wire_->get_stats();
+  ESP_LOGI(TAG, "bench {\"op\":\"%s\",\"n\":%u,\"resets\":%u,\"slots\":%u,\"locked_us\":%u,\"bus_us\":%u,\"wall_us\":%u}",
+           this->op_, this->count_, stats.resets - this->start_stats_.resets, stats.slots - this->start_stats_.slots,
+           stats.locked_us - this->start_stats_.locked_us, stats.bus_us - this->start_stats_.bus_us,
+           micros() - this->start_us_);
+  this->wire_ = nullptr;
 }
 
 uint8_t IRAM_ATTR *ESPOneWire::rom_number8_() { return reinterpret_cast<uint8_t *>(&this->rom_number_); }
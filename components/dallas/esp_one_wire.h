@@ -1,6 +1,9 @@
 #pragma once
 
 #include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "one_wire_histogram.h"
+#include <atomic>
 #include <vector>
 
 namespace esphome {
@@ -9,10 +12,98 @@ namespace dallas {
 extern const uint8_t ONE_WIRE_ROM_SELECT;
 extern const uint8_t ONE_WIRE_ROM_SEARCH;
 extern const uint8_t ONE_WIRE_ROM_ACTIVE_SEARCH;
+extern const uint8_t ONE_WIRE_ROM_OVERDRIVE_SKIP;
+extern const uint8_t ONE_WIRE_ROM_OVERDRIVE_SELECT;
+extern const uint8_t ONE_WIRE_ROM_RESUME;
+extern const uint8_t ONE_WIRE_ROM_SKIP;
+extern const uint8_t ONE_WIRE_ROM_READ;
 
+// tribit() result bits
+extern const uint8_t TRIBIT_SINGLE_BIT;
+extern const uint8_t TRIBIT_SECOND_BIT;
+extern const uint8_t TRIBIT_BRANCH_BIT;
+
+/// Reset and slot timing for one bus speed, in µs. Letters refer to Maxim AN126.
+struct OneWireTiming {
+  uint16_t reset_low;        // H
+  uint16_t presence_sample;  // I
+  uint16_t reset_tail;       // J
+  uint8_t slot;              // minimum time between slot starts
+  uint8_t write0_low;        // C
+  uint8_t write1_low;        // A
+  uint8_t read_low;          // A
+  uint8_t read_sample;       // A+E, measured from the start of the slot
+};
+
+/** A counter written by one thread at a time and read from any.
+ *
+ * With a bus task the counters are written on the task and read from the main loop. The accesses
+ * are relaxed atomics, plain loads and stores, so the time slots don't pay for them.
+ */
+class OneWireCounter {
+ public:
+  OneWireCounter(uint32_t value = 0) : value_(value) {}  // NOLINT(google-explicit-constructor)
+  OneWireCounter(const OneWireCounter &other) : value_(other.get()) {}
+  OneWireCounter &operator=(const OneWireCounter &other) { return *this = other.get(); }
+  OneWireCounter &operator=(uint32_t value) {
+    this->value_.store(value, std::memory_order_relaxed);
+    return *this;
+  }
+  uint32_t get() const { return this->value_.load(std::memory_order_relaxed); }
+  operator uint32_t() const { return this->get(); }  // NOLINT(google-explicit-constructor)
+  OneWireCounter &operator+=(uint32_t value) { return *this = this->get() + value; }
+  OneWireCounter &operator++() { return *this += 1; }
+  uint32_t operator++(int) {
+    uint32_t value = this->get();
+    *this = value + 1;
+    return value;
+  }
+
+ protected:
+  std::atomic<uint32_t> value_;
+};
+
+/// Bus activity counters, used to measure what bus operations cost in bus time and slots.
+struct ESPOneWireStats {
+  OneWireCounter resets{0};
+  OneWireCounter presence_failures{0};
+  OneWireCounter slots{0};
+  OneWireCounter bus_us{0};
+  OneWireCounter locked_us{0};
+  /// Longest single stretch with interrupts disabled.
+  OneWireCounter max_locked_us{0};
+  /// Transfers a device reported as failed, e.g. a CRC mismatch.
+  OneWireCounter transfer_errors{0};
+};
+
+/// How much of a transfer runs with interrupts disabled.
+enum OneWireLockPolicy : uint8_t {
+  /// Each time slot and presence sample on its own.
+  ONE_WIRE_LOCK_SLOT,
+  /// Each byte.
+  ONE_WIRE_LOCK_BYTE,
+  /// Everything inside a OneWireLock, split at byte boundaries to stay within the maximum lock time.
+  ONE_WIRE_LOCK_TRANSACTION,
+};
+
+/// Position of a search, so it can be suspended while the bus is used for something else.
+struct OneWireSearchState {
+  uint64_t rom_number{0};
+  uint8_t last_discrepancy{0};
+  bool last_device_flag{false};
+  uint8_t target_family{0};
+  uint16_t count{0};
+};
+
+/** A 1-Wire bus master.
+ *
+ * The base class bit-bangs a GPIO pin. Bus masters that do the time slots in
+ * hardware override the transport primitives, everything built on them is shared.
+ */
 class ESPOneWire {
  public:
   explicit ESPOneWire(InternalGPIOPin *pin);
+  virtual ~ESPOneWire() = default;
 
   /** Reset the bus, should be done before all write operations.
    *
@@ -22,14 +113,21 @@ class ESPOneWire {
    */
   bool reset();
 
+  /** Reset the bus at overdrive speed.
+   *
+   * Only devices already switched to overdrive see this as a reset, so it
+   * may only be used while the bus is in overdrive.
+   */
+  bool reset_overdrive();
+
   /// Write a single bit to the bus, takes about 70µs.
-  void write_bit(bool bit);
+  virtual void write_bit(bool bit);
 
   /// Read a single bit from the bus, takes about 70µs
-  bool read_bit();
+  virtual bool read_bit();
 
   /// Write a word to the bus. LSB first.
-  void write8(uint8_t val);
+  virtual void write8(uint8_t val);
 
   /// Write a 64 bit unsigned integer to the bus. LSB first.
   void write64(uint64_t val);
@@ -38,20 +136,62 @@ class ESPOneWire {
   void skip();
 
   /// Read an 8 bit word from the bus.
-  uint8_t read8();
+  virtual uint8_t read8();
 
   /// Read an 64-bit unsigned integer from the bus.
   uint64_t read64();
 
+  /// Read several bytes, bus masters that queue slots read them in one go.
+  virtual void read_bytes(uint8_t *data, uint16_t len);
+
+  /// Put slots still queued by the bus master on the bus, called at the end of a transaction.
+  virtual void flush() {}
+
   // read 2 bits, write 1 bit, for search
-  uint8_t tribit(bool dir);
+  virtual uint8_t tribit(bool dir);
 
   /// Select a specific address on the bus for the following command.
+  /// Devices marked as overdrive capable are selected with Overdrive-Match ROM,
+  /// a device that was also the last one matched is selected with Resume ROM when it supports it.
   void select(uint64_t address);
 
+  /// Read the ROM of the only device on the bus, the result is garbage if there is more than one.
+  uint64_t read_rom();
+
+  /// With a single device on the bus, select() addresses it with Skip ROM.
+  void set_single_device(bool single_device) { this->single_device_ = single_device; }
+  bool is_single_device() const { return this->single_device_; }
+
+  /// Use Resume ROM for repeated selects of the same device.
+  void set_resume(bool resume) { this->resume_ = resume; }
+  /// Forget the last matched device, the next select() sends the full ROM.
+  void invalidate_resume() { this->resume_address_ = 0; }
+
+  /// Address all devices and switch the overdrive capable ones to overdrive speed.
+  void skip_overdrive();
+
+  /// Select a device with Overdrive-Match ROM, the rest of the transaction runs at overdrive speed.
+  void select_overdrive(uint64_t address);
+
+  /// Mark a device to be addressed at overdrive speed by select().
+  void set_overdrive_device(uint64_t address, bool overdrive);
+  bool is_overdrive_device(uint64_t address) const;
+  /// Whether the bus is currently running at overdrive speed.
+  bool is_overdrive() const { return this->overdrive_; }
+
   /// Reset the device search.
   void reset_search();
 
+  /// Reset the device search so it only finds devices of one family.
+  void reset_search(uint8_t family);
+
+  /// Stop a search after this many devices, 0 for no limit.
+  void set_max_devices(uint16_t max_devices) { this->max_devices_ = max_devices; }
+
+  /// Save and restore the search position.
+  OneWireSearchState get_search_state() const;
+  void set_search_state(const OneWireSearchState &state);
+
   /// Search for a 1-Wire device on the bus. Returns 0 if all devices have been found.
   uint64_t search();
  
@@ -64,16 +204,148 @@ class ESPOneWire {
   /// Helper that wraps search in a std::vector.
   std::vector<uint64_t> search_vec();
 
+  /// Counters accumulated since construction or the last reset_stats().
+  const ESPOneWireStats &get_stats() const { return this->stats_; }
+  void reset_stats() { this->stats_ = {}; }
+  /// Log a machine-readable line for each benchmarked operation.
+  void set_benchmark(bool benchmark) { this->benchmark_ = benchmark; }
+  bool get_benchmark() const { return this->benchmark_; }
+
+  void set_lock_policy(OneWireLockPolicy lock_policy) { this->lock_policy_ = lock_policy; }
+  OneWireLockPolicy get_lock_policy() const { return this->lock_policy_; }
+  /// Re-enable interrupts between bytes once a transaction held them off this long, 0 for no limit.
+  void set_max_lock_us(uint32_t max_lock_us) { this->max_lock_us_ = max_lock_us; }
+  uint32_t get_max_lock_us() const { return this->max_lock_us_; }
+
+  /// Whether the time slots are generated by the CPU on a pin, only those buses need interrupts disabled.
+  bool is_bit_banged() const { return this->bit_banged_; }
+  virtual std::string dump_summary() const;
+  virtual bool supports_overdrive() const { return true; }
+
+  /** Measure the pin latency and the rise time of the bus and fit the standard speed timing to them.
+   *
+   * The read sample point moves as early as the bus allows, the slot gets longer if the bus
+   * needs more time to recover. Resets the bus before and after. Returns false and keeps the
+   * timing if the bus doesn't rise in time.
+   */
+  bool calibrate();
+  const OneWireTiming &get_timing() const { return this->standard_timing_; }
+  void set_timing(const OneWireTiming &timing) { this->standard_timing_ = timing; }
+  /// Count a transfer that failed its check, a rising count means the timing may be off.
+  void count_transfer_error() { this->stats_.transfer_errors++; }
+
+#ifdef USE_DALLAS_INSTRUMENTATION
+  OneWireInstrumentation &get_instrumentation() { return this->instrumentation_; }
+#endif
+
  protected:
+  /// For bus masters that don't bit-bang a pin.
+  ESPOneWire();
+
+  friend class OneWireLock;
+  friend class ESPOneWireGroup;
+  friend class ESPOneWireAsync;
+
   /// Helper to get the internal 64-bit unsigned rom number as a 8-bit integer pointer.
   inline uint8_t *rom_number8_();
   // search implementation
   uint64_t perform_search(uint8_t cmd);
+  /// Reset at standard or overdrive speed, returns whether a device answered with a presence pulse.
+  virtual bool reset_(bool overdrive);
+  /// First half of a split standard speed reset: pull the bus low if it is idle.
+  bool reset_start_();
+  /// Second half of a split reset: release the bus and sample the presence pulse, with interrupts disabled.
+  bool reset_presence_();
+  const OneWireTiming &timing_() const;
+  /// Disable interrupts unless already disabled, returns whether this call did it.
+  bool lock_();
+  void unlock_();
+  /// Called at byte and search triplet boundaries, lets pending interrupts run if the next slots would exceed
+  /// the lock budget.
+  void yield_lock_(uint8_t slots = 8);
 
+  /// Standard speed timing, calibrate() adjusts it to the bus.
+  OneWireTiming standard_timing_;
   ISRInternalGPIOPin pin_;
+  uint8_t pin_number_{0xFF};
+  bool bit_banged_{true};
+  /// Start of the last time slot, slots are paced per bus.
+  uint32_t last_slot_{0};
   uint8_t last_discrepancy_{0};
   bool last_device_flag_{false};
   uint64_t rom_number_{0};
+  uint8_t target_family_{0};
+  /// Devices found since the search was reset, limited to max_devices_.
+  uint16_t search_count_{0};
+  uint16_t max_devices_{255};
+  bool overdrive_{false};
+  bool resume_{true};
+  bool single_device_{false};
+  /// Last device matched that has its resume flag set, 0 if none.
+  uint64_t resume_address_{0};
+  std::vector<uint64_t> overdrive_devices_;
+  ESPOneWireStats stats_;
+  bool benchmark_{false};
+  OneWireLockPolicy lock_policy_{ONE_WIRE_LOCK_TRANSACTION};
+  uint32_t max_lock_us_{0};
+  /// Nesting depth of OneWireLock.
+  uint8_t transaction_depth_{0};
+  bool locked_{false};
+  uint32_t lock_start_{0};
+  alignas(InterruptLock) uint8_t lock_storage_[sizeof(InterruptLock)];
+#ifdef USE_DALLAS_INSTRUMENTATION
+  OneWireInstrumentation instrumentation_;
+  uint32_t transaction_start_{0};
+#endif
+};
+
+/** Marks a bus transaction.
+ *
+ * Depending on the lock policy of the bus interrupts are disabled for the whole
+ * transaction, or only per byte or slot.
+ */
+class OneWireLock {
+ public:
+  explicit OneWireLock(ESPOneWire *wire) : wire_(wire) {
+    if (wire->transaction_depth_++ != 0)
+      return;
+#ifdef USE_DALLAS_INSTRUMENTATION
+    wire->transaction_start_ = micros();
+#endif
+    if (wire->lock_policy_ == ONE_WIRE_LOCK_TRANSACTION)
+      wire->lock_();
+  }
+  ~OneWireLock() {
+    if (--this->wire_->transaction_depth_ == 0) {
+      this->wire_->flush();
+      this->wire_->unlock_();
+      ONE_WIRE_RECORD(this->wire_, transaction, micros() - this->wire_->transaction_start_);
+    }
+  }
+
+ protected:
+  ESPOneWire *wire_;
+};
+
+/// Measures the bus cost of one operation and logs it when the bus has benchmarking enabled.
+class OneWireBenchmark {
+ public:
+  OneWireBenchmark() = default;
+  OneWireBenchmark(ESPOneWire *wire, const char *op) { this->begin(wire, op); }
+  ~OneWireBenchmark() { this->finish(); }
+
+  void begin(ESPOneWire *wire, const char *op);
+  void set_count(uint32_t count) { this->count_ = count; }
+  uint32_t get_count() const { return this->count_; }
+  /// Log the operation, does nothing if already finished or benchmarking is disabled.
+  void finish();
+
+ protected:
+  ESPOneWire *wire_{nullptr};
+  const char *op_{nullptr};
+  uint32_t count_{0};
+  uint32_t start_us_{0};
+  ESPOneWireStats start_stats_;
 };
 
 }  // namespace dallas
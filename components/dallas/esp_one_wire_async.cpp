@@ -0,0 +1,124 @@
+#include "esp_one_wire_async.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace dallas {
+
+static const char *const TAG = "dallas.one_wire_async";
+
+// the bus has to be idle before a reset, give up after this long
+static const uint32_t ASYNC_IDLE_TIMEOUT_US = 250;
+
+bool ESPOneWireAsync::start(std::vector<uint8_t> write, uint8_t read_len, callback_t &&callback) {
+  if (this->is_busy())
+    return false;
+  this->write_ = std::move(write);
+  this->read_.assign(read_len, 0);
+  this->read_len_ = read_len;
+  this->callback_ = std::move(callback);
+  this->bit_ = 0;
+  this->phase_ = PHASE_WAIT_IDLE;
+  this->phase_start_ = micros();
+  this->high_freq_.start();
+  return true;
+}
+
+bool ESPOneWireAsync::step() {
+  auto *wire = this->wire_;
+  // the reset puts the bus back to standard speed, whatever it ran at before
+  auto &timing = wire->standard_timing_;
+  uint32_t now = micros();
+
+  switch (this->phase_) {
+    case PHASE_IDLE:
+      return true;
+
+    case PHASE_WAIT_IDLE:
+      if (!wire->reset_start_()) {
+        if (now - this->phase_start_ > ASYNC_IDLE_TIMEOUT_US) {
+          wire->stats_.resets++;
+          wire->stats_.presence_failures++;
+          wire->resume_address_ = 0;
+          this->complete_(false);
+          return true;
+        }
+        return false;
+      }
+      {
+        // The low is waited out here with interrupts enabled, as the one busy wait of a transaction.
+        // Other components run between two step() calls for milliseconds, and a low that long
+        // power-on-resets devices like the DS2408, so the low can't span calls.
+        uint32_t low_start = micros();
+        while (micros() - low_start < timing.reset_low)
+          ;
+        bool present = wire->reset_presence_();
+        wire->stats_.bus_us += micros() - low_start;
+        if (!present) {
+          ESP_LOGV(TAG, "No presence pulse");
+          this->complete_(false);
+          return true;
+        }
+      }
+      this->phase_ = PHASE_RECOVERY;
+      this->phase_start_ = micros();
+      return false;
+
+    case PHASE_RECOVERY:
+      // devices ignore slots until the end of the presence pulse
+      if (now - this->phase_start_ < timing.reset_tail)
+        return false;
+      wire->stats_.bus_us += now - this->phase_start_;
+      this->phase_ = this->write_.empty() ? PHASE_READ : PHASE_WRITE;
+      return this->step();
+
+    case PHASE_WRITE: {
+      // one slot per call, recovery between slots has no upper limit
+      bool bit = (this->write_[this->bit_ / 8] >> (this->bit_ % 8)) & 1;
+      {
+        OneWireLock lock(wire);
+        wire->write_bit(bit);
+      }
+      if (++this->bit_ == this->write_.size() * 8) {
+        this->bit_ = 0;
+        this->phase_ = PHASE_READ;
+      }
+      return false;
+    }
+
+    case PHASE_READ: {
+      if (this->bit_ == this->read_len_ * 8) {
+        this->complete_(true);
+        return true;
+      }
+      bool bit;
+      {
+        OneWireLock lock(wire);
+        bit = wire->read_bit();
+      }
+      if (bit)
+        this->read_[this->bit_ / 8] |= 1 << (this->bit_ % 8);
+      this->bit_++;
+      return false;
+    }
+  }
+  return true;
+}
+
+void ESPOneWireAsync::finish() {
+  while (!this->step())
+    ;
+}
+
+void ESPOneWireAsync::complete_(bool present) {
+  this->phase_ = PHASE_IDLE;
+  this->high_freq_.stop();
+  // the callback may start the next transaction
+  auto callback = std::move(this->callback_);
+  auto data = std::move(this->read_);
+  this->callback_ = nullptr;
+  if (callback)
+    callback(present, data);
+}
+
+}  // namespace dallas
+}  // namespace esphome
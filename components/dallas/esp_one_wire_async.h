@@ -0,0 +1,56 @@
+#pragma once
+
+#include "esp_one_wire.h"
+#include <functional>
+#include <vector>
+
+namespace esphome {
+namespace dallas {
+
+/** Runs a transaction on a bus in timed phases instead of blocking.
+ *
+ * A transaction is a standard speed reset, then a number of bytes written and
+ * then read. step() is called from the component loop and does whatever is
+ * due: the reset pulse is sent in one call, which busy waits its 480µs low,
+ * the recovery time is waited out between calls, and interrupts are only
+ * disabled while sampling the presence pulse and for single bit slots.
+ */
+class ESPOneWireAsync {
+ public:
+  using callback_t = std::function<void(bool present, const std::vector<uint8_t> &data)>;
+
+  explicit ESPOneWireAsync(ESPOneWire *wire) : wire_(wire) {}
+
+  /// Start a transaction, false if one is still running.
+  bool start(std::vector<uint8_t> write, uint8_t read_len, callback_t &&callback);
+  bool is_busy() const { return this->phase_ != PHASE_IDLE; }
+  /// Advance the running transaction, returns true when there is nothing left to do.
+  bool step();
+  /// Run the current transaction to the end, for when the bus is needed right away.
+  void finish();
+
+ protected:
+  enum Phase : uint8_t {
+    PHASE_IDLE,
+    PHASE_WAIT_IDLE,
+    PHASE_RECOVERY,
+    PHASE_WRITE,
+    PHASE_READ,
+  };
+
+  void complete_(bool present);
+
+  ESPOneWire *wire_;
+  Phase phase_{PHASE_IDLE};
+  uint32_t phase_start_{0};
+  std::vector<uint8_t> write_;
+  std::vector<uint8_t> read_;
+  uint8_t read_len_{0};
+  /// Position in the write or read buffer, in bits.
+  uint16_t bit_{0};
+  callback_t callback_;
+  HighFrequencyLoopRequester high_freq_;
+};
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,305 @@
+#include "esp_one_wire_group.h"
+#include "esphome/core/log.h"
+
+#include <algorithm>
+
+#ifdef USE_ESP32
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+#endif
+
+namespace esphome {
+namespace dallas {
+
+static const char *const TAG = "dallas.one_wire_group";
+
+#if defined(USE_ESP32)
+static const uint8_t GROUP_DIRECT_PINS = 32;
+#elif defined(USE_ESP8266)
+static const uint8_t GROUP_DIRECT_PINS = 16;
+#else
+static const uint8_t GROUP_DIRECT_PINS = 0;
+#endif
+
+uint8_t ESPOneWireGroup::add_bus(ESPOneWire *bus) {
+  uint8_t index = this->buses_.size();
+  if (index >= MAX_BUSES) {
+    ESP_LOGE(TAG, "A group holds at most %u buses", MAX_BUSES);
+    return 0xFF;
+  }
+  if (!bus->is_bit_banged()) {
+    ESP_LOGE(TAG, "Only buses on a GPIO pin can be grouped");
+    return 0xFF;
+  }
+  this->buses_.push_back(bus);
+  if (bus->pin_number_ < GROUP_DIRECT_PINS) {
+    this->gpio_masks_.push_back(1u << bus->pin_number_);
+  } else {
+    this->gpio_masks_.push_back(0);
+    if (this->direct_)
+      ESP_LOGD(TAG, "GPIO%u can't be switched together, group uses per pin access", bus->pin_number_);
+    this->direct_ = false;
+  }
+  return index;
+}
+
+uint32_t ESPOneWireGroup::gpio_mask_(uint32_t mask) const {
+  uint32_t r = 0;
+  for (uint8_t i = 0; i < this->buses_.size(); i++) {
+    if (mask & (1u << i))
+      r |= this->gpio_masks_[i];
+  }
+  return r;
+}
+
+void HOT IRAM_ATTR ESPOneWireGroup::drive_low_(uint32_t pins) {
+  if (!this->direct_) {
+    for (uint8_t i = 0; i < this->buses_.size(); i++) {
+      if (pins & (1u << i)) {
+        this->buses_[i]->pin_.pin_mode(gpio::FLAG_OUTPUT);
+        this->buses_[i]->pin_.digital_write(false);
+      }
+    }
+    return;
+  }
+#if defined(USE_ESP32)
+  REG_WRITE(GPIO_OUT_W1TC_REG, pins);
+  REG_WRITE(GPIO_ENABLE_W1TS_REG, pins);
+#elif defined(USE_ESP8266)
+  GPOC = pins;
+  GPES = pins;
+#endif
+}
+
+void HOT IRAM_ATTR ESPOneWireGroup::release_(uint32_t pins) {
+  if (!this->direct_) {
+    for (uint8_t i = 0; i < this->buses_.size(); i++) {
+      if (pins & (1u << i))
+        this->buses_[i]->pin_.pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
+    }
+    return;
+  }
+#if defined(USE_ESP32)
+  REG_WRITE(GPIO_ENABLE_W1TC_REG, pins);
+#elif defined(USE_ESP8266)
+  GPEC = pins;
+#endif
+}
+
+// returns the bus mask with a bit set for every bus that reads high
+uint32_t HOT IRAM_ATTR ESPOneWireGroup::sample_(uint32_t mask) {
+  uint32_t r = 0;
+  if (!this->direct_) {
+    for (uint8_t i = 0; i < this->buses_.size(); i++) {
+      if ((mask & (1u << i)) && this->buses_[i]->pin_.digital_read())
+        r |= 1u << i;
+    }
+    return r;
+  }
+#if defined(USE_ESP32)
+  uint32_t in = REG_READ(GPIO_IN_REG);
+#elif defined(USE_ESP8266)
+  uint32_t in = GPI;
+#else
+  uint32_t in = 0;
+#endif
+  for (uint8_t i = 0; i < this->buses_.size(); i++) {
+    if ((mask & (1u << i)) && (in & this->gpio_masks_[i]))
+      r |= 1u << i;
+  }
+  return r;
+}
+
+void ESPOneWireGroup::prepare_timing_(uint32_t mask) {
+  // the group only runs at standard speed, each time is the longest any bus in mask needs
+  bool first = true;
+  this->sample_points_ = 0;
+  for (uint8_t i = 0; i < this->buses_.size(); i++) {
+    if (!(mask & (1u << i)))
+      continue;
+    auto &timing = this->buses_[i]->get_timing();
+    if (first) {
+      this->timing_ = timing;
+      first = false;
+    } else {
+      auto &t = this->timing_;
+      t.reset_low = std::max(t.reset_low, timing.reset_low);
+      t.presence_sample = std::max(t.presence_sample, timing.presence_sample);
+      t.reset_tail = std::max(t.reset_tail, timing.reset_tail);
+      t.slot = std::max(t.slot, timing.slot);
+      t.write0_low = std::max(t.write0_low, timing.write0_low);
+      t.write1_low = std::max(t.write1_low, timing.write1_low);
+      t.read_low = std::max(t.read_low, timing.read_low);
+    }
+    // reads are sampled at each bus' own point, sorted by time
+    uint8_t point = 0;
+    while (point < this->sample_points_ && this->sample_us_[point] < timing.read_sample)
+      point++;
+    if (point == this->sample_points_ || this->sample_us_[point] != timing.read_sample) {
+      for (uint8_t j = this->sample_points_; j > point; j--) {
+        this->sample_us_[j] = this->sample_us_[j - 1];
+        this->sample_masks_[j] = this->sample_masks_[j - 1];
+      }
+      this->sample_us_[point] = timing.read_sample;
+      this->sample_masks_[point] = 0;
+      this->sample_points_++;
+    }
+    this->sample_masks_[point] |= 1u << i;
+  }
+}
+
+void HOT IRAM_ATTR ESPOneWireGroup::wait_slot_() {
+  while ((micros() - this->last_slot_) < this->timing_.slot)
+    ;
+  this->last_slot_ = micros();
+}
+
+void ESPOneWireGroup::account_(uint32_t mask, uint32_t slots, uint32_t start, uint32_t locked_start) {
+  uint32_t now = micros();
+  for (uint8_t i = 0; i < this->buses_.size(); i++) {
+    if (!(mask & (1u << i)))
+      continue;
+    auto *bus = this->buses_[i];
+    bus->stats_.slots += slots;
+    bus->stats_.bus_us += now - start;
+    if (locked_start != 0) {
+      bus->stats_.locked_us += now - locked_start;
+      bus->stats_.max_locked_us = std::max(bus->stats_.max_locked_us.get(), now - locked_start);
+      ONE_WIRE_RECORD(bus, lock, now - locked_start);
+    }
+    bus->last_slot_ = this->last_slot_;
+    // the group addresses devices behind the bus' back
+    bus->resume_address_ = 0;
+  }
+}
+
+uint32_t ESPOneWireGroup::reset(uint32_t mask) {
+  uint32_t start = micros();
+  uint32_t pins = this->direct_ ? this->gpio_mask_(mask) : mask;
+  this->prepare_timing_(mask);
+  for (uint8_t i = 0; i < this->buses_.size(); i++) {
+    if (mask & (1u << i)) {
+      this->buses_[i]->stats_.resets++;
+      this->buses_[i]->overdrive_ = false;
+    }
+  }
+
+  // wait for all buses to be idle
+  this->release_(pins);
+  uint32_t idle = mask;
+  uint8_t retries = 125;
+  while ((this->sample_(idle) & idle) != idle) {
+    if (--retries == 0) {
+      idle = this->sample_(mask);
+      break;
+    }
+    delayMicroseconds(2);
+  }
+
+  uint32_t presence;
+  {
+    uint32_t idle_pins = this->direct_ ? this->gpio_mask_(idle) : idle;
+    this->drive_low_(idle_pins);
+    delayMicroseconds(this->timing_.reset_low);
+    InterruptLock lock;
+    this->release_(idle_pins);
+    delayMicroseconds(this->timing_.presence_sample);
+    presence = idle & ~this->sample_(idle);
+  }
+  delayMicroseconds(this->timing_.reset_tail);
+
+  for (uint8_t i = 0; i < this->buses_.size(); i++) {
+    if ((mask & (1u << i)) && !(presence & (1u << i))) {
+      this->buses_[i]->stats_.presence_failures++;
+      this->buses_[i]->resume_address_ = 0;
+    }
+  }
+  this->account_(mask, 0, start, 0);
+  return presence;
+}
+
+void HOT IRAM_ATTR ESPOneWireGroup::write_slot_(uint32_t mask, uint32_t ones) {
+  uint32_t pins = this->direct_ ? this->gpio_mask_(mask) : mask;
+  uint32_t one_pins = this->direct_ ? this->gpio_mask_(ones & mask) : ones & mask;
+  this->wait_slot_();
+  this->drive_low_(pins);
+  delayMicroseconds(this->timing_.write1_low);
+  this->release_(one_pins);
+  delayMicroseconds(this->timing_.write0_low - this->timing_.write1_low);
+  this->release_(pins);
+  delayMicroseconds(1);
+}
+
+uint32_t HOT IRAM_ATTR ESPOneWireGroup::read_slot_(uint32_t mask) {
+  uint32_t pins = this->direct_ ? this->gpio_mask_(mask) : mask;
+  this->wait_slot_();
+  uint32_t start = micros();
+  this->drive_low_(pins);
+  delayMicroseconds(this->timing_.read_low);
+  this->release_(pins);
+  uint32_t r = 0;
+  for (uint8_t point = 0; point < this->sample_points_; point++) {
+    while (micros() - start < this->sample_us_[point])
+      ;
+    r |= this->sample_(mask & this->sample_masks_[point]);
+  }
+  return r;
+}
+
+void ESPOneWireGroup::write8(uint32_t mask, uint8_t value) {
+  uint8_t values[MAX_BUSES];
+  for (uint8_t i = 0; i < this->buses_.size(); i++)
+    values[i] = value;
+  this->write8(mask, values);
+}
+
+void ESPOneWireGroup::write8(uint32_t mask, const uint8_t *values) {
+  uint32_t start = micros();
+  this->prepare_timing_(mask);
+  uint32_t locked_start;
+  {
+    InterruptLock lock;
+    locked_start = micros();
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      uint32_t ones = 0;
+      for (uint8_t i = 0; i < this->buses_.size(); i++) {
+        if (values[i] & (1u << bit))
+          ones |= 1u << i;
+      }
+      this->write_slot_(mask, ones);
+    }
+  }
+  this->account_(mask, 8, start, locked_start);
+}
+
+void ESPOneWireGroup::write64(uint32_t mask, const uint64_t *values) {
+  uint8_t bytes[MAX_BUSES];
+  for (uint8_t b = 0; b < 8; b++) {
+    for (uint8_t i = 0; i < this->buses_.size(); i++)
+      bytes[i] = values[i] >> (b * 8);
+    this->write8(mask, bytes);
+  }
+}
+
+void ESPOneWireGroup::read8(uint32_t mask, uint8_t *values) {
+  for (uint8_t i = 0; i < this->buses_.size(); i++)
+    values[i] = 0;
+  uint32_t start = micros();
+  this->prepare_timing_(mask);
+  uint32_t locked_start;
+  {
+    InterruptLock lock;
+    locked_start = micros();
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      uint32_t ones = this->read_slot_(mask);
+      for (uint8_t i = 0; i < this->buses_.size(); i++) {
+        if (ones & (1u << i))
+          values[i] |= 1u << bit;
+      }
+    }
+  }
+  this->account_(mask, 8, start, locked_start);
+}
+
+}  // namespace dallas
+}  // namespace esphome
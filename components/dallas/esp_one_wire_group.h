@@ -0,0 +1,64 @@
+#pragma once
+
+#include "esp_one_wire.h"
+#include <vector>
+
+namespace esphome {
+namespace dallas {
+
+/** Drives several buses in the same standard speed time slots.
+ *
+ * Buses are identified by their index, operations take a mask of the buses
+ * to run on. Where the pins allow it, all buses are switched with a single
+ * GPIO register write, otherwise the pins are switched one after the other.
+ */
+class ESPOneWireGroup {
+ public:
+  static const uint8_t MAX_BUSES = 32;
+
+  /// Add a bus, returns its index or 0xFF when the group is full.
+  uint8_t add_bus(ESPOneWire *bus);
+  size_t size() const { return this->buses_.size(); }
+  ESPOneWire *get_bus(uint8_t index) { return this->buses_[index]; }
+  uint32_t all() const { return this->buses_.size() >= 32 ? 0xFFFFFFFF : (1u << this->buses_.size()) - 1; }
+
+  /// Reset the buses in mask, returns the buses that got a presence pulse.
+  uint32_t reset(uint32_t mask);
+  /// Write the same byte to the buses in mask.
+  void write8(uint32_t mask, uint8_t value);
+  /// Write one byte per bus, indexed by bus.
+  void write8(uint32_t mask, const uint8_t *values);
+  /// Write one 64 bit value per bus, indexed by bus.
+  void write64(uint32_t mask, const uint64_t *values);
+  /// Read one byte per bus, indexed by bus.
+  void read8(uint32_t mask, uint8_t *values);
+
+ protected:
+  /// One write slot, the buses in ones write a 1, the rest of mask a 0.
+  void write_slot_(uint32_t mask, uint32_t ones);
+  /// One read slot, returns the buses in mask that read a 1.
+  uint32_t read_slot_(uint32_t mask);
+  /// Set up the timing for the buses in mask from their own timing.
+  void prepare_timing_(uint32_t mask);
+  void wait_slot_();
+  void account_(uint32_t mask, uint32_t slots, uint32_t start, uint32_t locked_start);
+
+  uint32_t gpio_mask_(uint32_t mask) const;
+  void drive_low_(uint32_t mask);
+  void release_(uint32_t mask);
+  uint32_t sample_(uint32_t mask);
+
+  std::vector<ESPOneWire *> buses_;
+  std::vector<uint32_t> gpio_masks_;
+  /// All pins can be switched through the GPIO registers.
+  bool direct_{true};
+  uint32_t last_slot_{0};
+  OneWireTiming timing_{};
+  /// Read sample points of the buses, earliest first, with the buses sampled at each.
+  uint8_t sample_us_[MAX_BUSES];
+  uint32_t sample_masks_[MAX_BUSES];
+  uint8_t sample_points_{0};
+};
+
+}  // namespace dallas
+}  // namespace esphome
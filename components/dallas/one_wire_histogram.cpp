@@ -0,0 +1,30 @@
+#include "one_wire_histogram.h"
+#include "esphome/core/log.h"
+
+#include <cstdio>
+
+namespace esphome {
+namespace dallas {
+
+static const char *const TAG = "dallas.histogram";
+
+void OneWireHistogram::dump(const char *name) const {
+  if (this->count == 0) {
+    ESP_LOGCONFIG(TAG, "  %s: none", name);
+    return;
+  }
+  // bucket lower bounds with their counts, empty buckets left out
+  char buckets[BUCKETS * 16];
+  size_t pos = 0;
+  buckets[0] = '\0';
+  for (uint8_t i = 0; i < BUCKETS && pos < sizeof(buckets); i++) {
+    if (this->counts[i] == 0)
+      continue;
+    uint32_t low = i == 0 ? 0 : 1u << (i - 1);
+    pos += snprintf(buckets + pos, sizeof(buckets) - pos, " %u+:%u", low, this->counts[i]);
+  }
+  ESP_LOGCONFIG(TAG, "  %s: n=%u mean=%uus max=%uus%s", name, this->count, this->mean(), this->max, buckets);
+}
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#include <cstdint>
+
+namespace esphome {
+namespace dallas {
+
+/// Durations in µs, counted in power of two buckets: 0, 1, 2-3, 4-7, ... and 1024µs and up.
+struct OneWireHistogram {
+  static const uint8_t BUCKETS = 12;
+
+  uint32_t counts[BUCKETS]{};
+  uint32_t count{0};
+  uint64_t sum{0};
+  uint32_t max{0};
+  /// Largest value since the last take_recent_max().
+  uint32_t recent_max{0};
+
+  void record(uint32_t us) {
+    uint8_t bucket = us == 0 ? 0 : 32 - __builtin_clz(us);
+    if (bucket >= BUCKETS)
+      bucket = BUCKETS - 1;
+    this->counts[bucket]++;
+    this->count++;
+    this->sum += us;
+    if (us > this->max)
+      this->max = us;
+    if (us > this->recent_max)
+      this->recent_max = us;
+  }
+  uint32_t take_recent_max() {
+    uint32_t value = this->recent_max;
+    this->recent_max = 0;
+    return value;
+  }
+  uint32_t mean() const { return this->count == 0 ? 0 : this->sum / this->count; }
+  /// Log the counts with dump_config.
+  void dump(const char *name) const;
+};
+
+/// Timing as the bus actually ran it.
+struct OneWireInstrumentation {
+  /// Time slots from pulling the bus low to the end of the slot.
+  OneWireHistogram slot;
+  /// Read sample point measured from the start of the slot.
+  OneWireHistogram read_sample;
+  OneWireHistogram reset;
+  /// Each stretch with interrupts disabled.
+  OneWireHistogram lock;
+  /// Each OneWireLock transaction.
+  OneWireHistogram transaction;
+};
+
+// only evaluates its arguments when instrumentation is compiled in
+#ifdef USE_DALLAS_INSTRUMENTATION
+#define ONE_WIRE_RECORD(wire, histogram, us) (wire)->instrumentation_.histogram.record(us)
+#else
+#define ONE_WIRE_RECORD(wire, histogram, us)
+#endif
+
+}  // namespace dallas
+}  // namespace esphome
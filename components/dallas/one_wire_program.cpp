@@ -0,0 +1,127 @@
+#include "one_wire_program.h"
+#include "dallas_crc.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace dallas {
+
+OneWireProgram &OneWireProgram::add_(Op op, uint8_t len) {
+  if (this->step_count_ >= MAX_STEPS || this->length_ + len > MAX_BYTES) {
+    this->overflow_ = true;
+    return *this;
+  }
+  this->steps_[this->step_count_++] = {op, this->length_, len, this->check_from_, 0};
+  this->length_ += len;
+  return *this;
+}
+
+OneWireProgram &OneWireProgram::write(uint8_t value) { return this->write(&value, 1); }
+
+OneWireProgram &OneWireProgram::write(const uint8_t *data, uint8_t len) {
+  uint8_t offset = this->length_;
+  this->add_(OP_WRITE, len);
+  if (!this->overflow_)
+    memcpy(this->bytes_ + offset, data, len);
+  return *this;
+}
+
+OneWireProgram &OneWireProgram::write_inverted(uint8_t value) {
+  uint8_t data[2] = {value, uint8_t(~value)};
+  return this->write(data, 2);
+}
+
+OneWireProgram &OneWireProgram::read(uint8_t len) { return this->add_(OP_READ, len); }
+
+OneWireProgram &OneWireProgram::check_crc8() {
+  // CRC8 only covers the data read
+  for (uint8_t i = this->step_count_; i > 0; i--) {
+    auto &step = this->steps_[i - 1];
+    if (step.op != OP_READ || step.offset < this->check_from_)
+      break;
+    this->check_from_ = step.offset;
+  }
+  this->add_(OP_CRC8, 1);
+  this->check_from_ = this->length_;
+  return *this;
+}
+
+OneWireProgram &OneWireProgram::check_crc16() {
+  this->add_(OP_CRC16, 2);
+  this->check_from_ = this->length_;
+  return *this;
+}
+
+OneWireProgram &OneWireProgram::confirm(uint8_t value) {
+  this->add_(OP_CONFIRM, 1);
+  if (!this->overflow_)
+    this->steps_[this->step_count_ - 1].expected = value;
+  this->check_from_ = this->length_;
+  return *this;
+}
+
+bool OneWireProgram::execute(ESPOneWire *wire, uint64_t address) {
+  this->error_ = nullptr;
+  if (this->overflow_) {
+    this->error_ = "program too long";
+    return false;
+  }
+
+  {
+    OneWireLock lock(wire);
+    wire->select(address);
+    for (uint8_t i = 0; i < this->step_count_; i++) {
+      auto &step = this->steps_[i];
+      uint8_t *data = this->bytes_ + step.offset;
+      if (step.op == OP_WRITE) {
+        for (uint8_t n = 0; n < step.len; n++)
+          wire->write8(data[n]);
+      } else {
+        wire->read_bytes(data, step.len);
+      }
+    }
+  }
+
+  for (uint8_t i = 0; i < this->step_count_; i++) {
+    auto &step = this->steps_[i];
+    const uint8_t *data = this->bytes_ + step.offset;
+    uint8_t *covered = this->bytes_ + step.check_from;
+    uint8_t covered_len = step.offset - step.check_from;
+    switch (step.op) {
+      case OP_CRC8:
+        if (crc8(covered, covered_len) != data[0]) {
+          this->error_ = "bad crc8";
+          return false;
+        }
+        break;
+      case OP_CRC16: {
+        uint16_t crc = crc16(covered, covered_len, 0, 0xA001, false, true);
+        if ((crc & 0xff) != data[0] || (crc >> 8) != data[1]) {
+          this->error_ = "bad crc16";
+          return false;
+        }
+        break;
+      }
+      case OP_CONFIRM:
+        if (data[0] != step.expected) {
+          this->error_ = "not confirmed";
+          return false;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+const uint8_t *OneWireProgram::get_read(uint8_t n) const {
+  for (uint8_t i = 0; i < this->step_count_; i++) {
+    if (this->steps_[i].op == OP_READ && n-- == 0)
+      return this->bytes_ + this->steps_[i].offset;
+  }
+  return nullptr;
+}
+
+}  // namespace dallas
+}  // namespace esphome
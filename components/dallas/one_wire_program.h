@@ -0,0 +1,76 @@
+#pragma once
+
+#include "esp_one_wire.h"
+
+namespace esphome {
+namespace dallas {
+
+/** A device transaction described as a list of steps.
+ *
+ * execute() addresses the device and runs all steps in one locked pass,
+ * the checks are verified afterwards:
+ *
+ *   OneWireProgram program;
+ *   program.write(0xF0).write(addr, 2).read(8).check_crc16();
+ *   if (wire != nullptr && program.execute(wire, address))
+ *     use(program.get_read());
+ */
+class OneWireProgram {
+ public:
+  static const uint8_t MAX_STEPS = 12;
+  /// Bytes written and read by one program, including check bytes.
+  static const uint8_t MAX_BYTES = 64;
+
+  OneWireProgram &write(uint8_t value);
+  OneWireProgram &write(const uint8_t *data, uint8_t len);
+  /// Write a byte followed by its complement, as PIO and channel writes expect.
+  OneWireProgram &write_inverted(uint8_t value);
+  OneWireProgram &read(uint8_t len);
+  /// Read a CRC8 and check it against the bytes read since the last check.
+  OneWireProgram &check_crc8();
+  /// Read an inverted CRC16 and check it against the bytes written and read since the last check.
+  OneWireProgram &check_crc16();
+  /// Read a byte that has to be value, like the confirmation of a PIO write.
+  OneWireProgram &confirm(uint8_t value = 0xAA);
+
+  /// Address the device on a freshly reset bus and run the steps, false if a check failed.
+  bool execute(ESPOneWire *wire, uint64_t address);
+
+  /// Data of the n-th read step.
+  const uint8_t *get_read(uint8_t n = 0) const;
+  /// Step that failed, nullptr if none did.
+  const char *get_error() const { return this->error_; }
+
+ protected:
+  enum Op : uint8_t {
+    OP_WRITE,
+    OP_READ,
+    OP_CRC8,
+    OP_CRC16,
+    OP_CONFIRM,
+  };
+  struct Step {
+    Op op;
+    /// Position in the transcript.
+    uint8_t offset;
+    uint8_t len;
+    /// Start of the bytes covered by a check.
+    uint8_t check_from;
+    /// Value a confirm step has to read, kept here as the read overwrites the transcript.
+    uint8_t expected;
+  };
+
+  OneWireProgram &add_(Op op, uint8_t len);
+
+  Step steps_[MAX_STEPS];
+  uint8_t step_count_{0};
+  /// All bytes on the wire in order, writes are filled in when building.
+  uint8_t bytes_[MAX_BYTES];
+  uint8_t length_{0};
+  uint8_t check_from_{0};
+  bool overflow_{false};
+  const char *error_{nullptr};
+};
+
+}  // namespace dallas
+}  // namespace esphome
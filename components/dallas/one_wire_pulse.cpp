@@ -0,0 +1,60 @@
+#include "one_wire_pulse.h"
+
+namespace esphome {
+namespace dallas {
+
+// same slot timing as the bit-banged bus, the slot stretched to 70µs for recovery
+static const OneWirePulse PULSE_WRITE_1 = {6, 64};
+static const OneWirePulse PULSE_WRITE_0 = {60, 10};
+static const OneWirePulse PULSE_READ = {3, 67};
+const OneWirePulse OneWirePulseTrain::RESET = {480, 480};
+
+bool OneWirePulseTrain::add_write(bool bit) {
+  if (this->is_full())
+    return false;
+  this->reads_[this->count_ / 8] &= ~(1u << (this->count_ % 8));
+  this->pulses_[this->count_++] = bit ? PULSE_WRITE_1 : PULSE_WRITE_0;
+  return true;
+}
+
+bool OneWirePulseTrain::add_write8(uint8_t value) {
+  if (this->count_ + 8 > MAX_SLOTS)
+    return false;
+  for (uint8_t i = 0; i < 8; i++)
+    this->add_write(value & (1u << i));
+  return true;
+}
+
+bool OneWirePulseTrain::add_read() {
+  if (this->is_full())
+    return false;
+  this->reads_[this->count_ / 8] |= 1u << (this->count_ % 8);
+  this->pulses_[this->count_++] = PULSE_READ;
+  this->read_count_++;
+  return true;
+}
+
+bool OneWirePulseTrain::decode(const uint16_t *low_us, uint8_t count) {
+  if (count < this->count_)
+    return false;
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < this->count_; i++) {
+    if (!(this->reads_[i / 8] & (1u << (i % 8))))
+      continue;
+    if (low_us[i] < READ_ZERO_LOW_US) {
+      this->read_bits_[n / 8] |= 1u << (n % 8);
+    } else {
+      this->read_bits_[n / 8] &= ~(1u << (n % 8));
+    }
+    n++;
+  }
+  return true;
+}
+
+bool OneWirePulseTrain::decode_presence(const uint16_t *low_us, uint8_t count) {
+  // a bus held low shows as one long pulse
+  return count >= 2 && low_us[0] >= RESET.low_us / 2 && low_us[1] < RESET.low_us / 2;
+}
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace dallas {
+
+/// One time slot or reset as it is put on the bus: low, then released. In µs.
+struct OneWirePulse {
+  uint16_t low_us;
+  uint16_t high_us;
+};
+
+/** A run of standard speed time slots compiled to pulses for a peripheral to send.
+ *
+ * The captured bus shows one low pulse per slot, a device answering 0 stretches
+ * the low pulse of a read slot. decode() turns those back into the read bits.
+ * Plain C++ so it doesn't depend on the peripheral.
+ */
+class OneWirePulseTrain {
+ public:
+  static const uint8_t MAX_SLOTS = 64;
+  /// A read slot with a longer low time was held low by a device.
+  static const uint16_t READ_ZERO_LOW_US = 15;
+  /// Line released this long ends a captured frame, longer than any high time inside a slot.
+  static const uint16_t SLOT_IDLE_US = 80;
+  /// The receiver ends a frame on any level held this long, so for the reset frame it has
+  /// to outlast the 480µs reset pulse; it then ends after the presence pulse.
+  static const uint16_t RESET_IDLE_US = 600;
+  static const OneWirePulse RESET;
+
+  void clear() {
+    this->count_ = 0;
+    this->read_count_ = 0;
+  }
+  bool empty() const { return this->count_ == 0; }
+  bool is_full() const { return this->count_ >= MAX_SLOTS; }
+  uint8_t size() const { return this->count_; }
+  uint8_t get_read_count() const { return this->read_count_; }
+  const OneWirePulse *get_pulses() const { return this->pulses_; }
+
+  /// Append slots, returns false if the train is full.
+  bool add_write(bool bit);
+  bool add_write8(uint8_t value);
+  bool add_read();
+
+  /// Decode the captured low times, one per slot. Returns false if slots are missing.
+  bool decode(const uint16_t *low_us, uint8_t count);
+  /// A read bit after decode().
+  bool get_read(uint8_t n) const { return this->read_bits_[n / 8] & (1u << (n % 8)); }
+  /// Decode a captured reset: the reset pulse itself, then the presence pulse.
+  static bool decode_presence(const uint16_t *low_us, uint8_t count);
+
+ protected:
+  OneWirePulse pulses_[MAX_SLOTS];
+  /// Which slots are read slots, one bit each.
+  uint8_t reads_[(MAX_SLOTS + 7) / 8];
+  uint8_t read_bits_[(MAX_SLOTS + 7) / 8];
+  uint8_t count_{0};
+  uint8_t read_count_{0};
+};
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,144 @@
+#include "one_wire_sweep.h"
+#include "esphome/core/log.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace dallas {
+
+static const char *const TAG = "dallas.sweep";
+
+static const uint8_t SWEEP_SLOTS[OneWireTimingSweep::SLOT_COUNT] = {60, 62, 65, 70};
+// a device holding the bus for a 0 may release it 15µs after the slot start
+static const uint8_t SWEEP_LAST_SAMPLE = 14;
+
+bool OneWireTimingSweep::start(ESPOneWire *wire, uint64_t address) {
+  this->original_ = wire->get_timing();
+  if (this->original_.read_low >= SWEEP_LAST_SAMPLE) {
+    ESP_LOGW(TAG, "Read low time %uus leaves no sample point before %uus, not sweeping", this->original_.read_low,
+             SWEEP_LAST_SAMPLE);
+    this->wire_ = nullptr;
+    return false;
+  }
+  this->wire_ = wire;
+  this->address_ = address;
+  // a 1 sampled too early reads as a 0, which a search following the ROM takes as a discrepancy and
+  // goes on along the ROM anyway. So a point only counts as error free if it reads the same bits.
+  if (!this->follow_(this->ids_, this->complements_) || (this->ids_ & this->complements_) != 0) {
+    ESP_LOGW(TAG, "Device %s doesn't answer the search, not sweeping", format_hex(address).c_str());
+    this->wire_ = nullptr;
+    return false;
+  }
+  this->first_sample_ = this->original_.read_low + 1;
+  this->sample_count_ = std::min<uint8_t>(SWEEP_LAST_SAMPLE - this->first_sample_ + 1, uint8_t(MAX_SAMPLES));
+  this->point_ = 0;
+  this->round_ = 0;
+  this->found_ = false;
+  ESP_LOGI(TAG, "Sweeping %u sample points and %u slot lengths on %s", this->sample_count_, SLOT_COUNT,
+           wire->dump_summary().c_str());
+  return true;
+}
+
+bool OneWireTimingSweep::follow_(uint64_t &ids, uint64_t &complements) {
+  auto *wire = this->wire_;
+  OneWireLock lock(wire);
+  if (!wire->reset())
+    return false;
+  wire->write8(ONE_WIRE_ROM_SEARCH);
+  ids = 0;
+  complements = 0;
+  for (uint8_t i = 0; i < 64; i++) {
+    bool bit = (this->address_ >> i) & 1;
+    uint8_t result = wire->tribit(bit);
+    // the other devices took the search somewhere else
+    if (bool(result & TRIBIT_BRANCH_BIT) != bit)
+      return false;
+    if (result & TRIBIT_SINGLE_BIT)
+      ids |= uint64_t(1) << i;
+    if (result & TRIBIT_SECOND_BIT)
+      complements |= uint64_t(1) << i;
+  }
+  return true;
+}
+
+OneWireTiming OneWireTimingSweep::point_timing_(uint8_t sample, uint8_t slot) const {
+  OneWireTiming timing = this->original_;
+  timing.read_sample = this->first_sample_ + sample;
+  timing.slot = SWEEP_SLOTS[slot];
+  return timing;
+}
+
+bool OneWireTimingSweep::step() {
+  if (this->wire_ == nullptr)
+    return false;
+  uint8_t slot = this->point_ / this->sample_count_;
+  uint8_t sample = this->point_ % this->sample_count_;
+  auto *wire = this->wire_;
+  wire->set_timing(this->point_timing_(sample, slot));
+  if (this->round_ == 0) {
+    this->errors_[slot][sample] = 0;
+    this->bus_us_[slot][sample] = 0;
+  }
+
+  uint32_t bus_us = wire->get_stats().bus_us;
+  for (uint8_t i = 0; i < ROUNDS_PER_STEP && this->round_ < ROUNDS; i++, this->round_++) {
+    uint64_t ids, complements;
+    if (!this->follow_(ids, complements) || ids != this->ids_ || complements != this->complements_)
+      this->errors_[slot][sample]++;
+  }
+  this->bus_us_[slot][sample] += wire->get_stats().bus_us - bus_us;
+  // the other bus work between steps runs with the normal timing
+  wire->set_timing(this->original_);
+  if (this->round_ < ROUNDS)
+    return true;
+
+  this->round_ = 0;
+  ESP_LOGI(TAG, "sweep {\"sample\":%u,\"slot\":%u,\"errors\":%u,\"n\":%u,\"bus_us\":%u}",
+           this->first_sample_ + sample, SWEEP_SLOTS[slot], this->errors_[slot][sample], ROUNDS,
+           this->bus_us_[slot][sample] / ROUNDS);
+
+  if (++this->point_ < this->sample_count_ * SLOT_COUNT)
+    return true;
+  this->finish_();
+  return false;
+}
+
+void OneWireTimingSweep::finish_() {
+  this->wire_->set_timing(this->original_);
+  this->wire_ = nullptr;
+
+  // bus time hardly depends on the sample point, so the slot length decides the speed. The slots
+  // are sorted, the first one with at least three error free sample points in a row wins and
+  // samples in the middle of its longest error free run.
+  uint8_t best_slot = 0;
+  for (uint8_t slot = 0; slot < SLOT_COUNT && !this->found_; slot++) {
+    uint8_t run_start = 0;
+    uint8_t best_start = 0;
+    uint8_t best_length = 0;
+    for (uint8_t sample = 0; sample <= this->sample_count_; sample++) {
+      if (sample < this->sample_count_ && this->errors_[slot][sample] == 0)
+        continue;
+      if (sample - run_start > best_length) {
+        best_start = run_start;
+        best_length = sample - run_start;
+      }
+      run_start = sample + 1;
+    }
+    if (best_length < 3)
+      continue;
+    this->best_ = this->point_timing_(best_start + (best_length - 1) / 2, slot);
+    this->found_ = true;
+    best_slot = slot;
+  }
+  if (this->found_) {
+    uint8_t best_sample = this->best_.read_sample - this->first_sample_;
+    ESP_LOGI(TAG, "Fastest safe timing: sample=%uus slot=%uus, %uus per search", this->best_.read_sample,
+             this->best_.slot, this->bus_us_[best_slot][best_sample] / ROUNDS);
+  } else {
+    ESP_LOGW(TAG, "No timing read reliably, keeping sample=%uus slot=%uus", this->original_.read_sample,
+             this->original_.slot);
+  }
+}
+
+}  // namespace dallas
+}  // namespace esphome
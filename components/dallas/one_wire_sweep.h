@@ -0,0 +1,56 @@
+#pragma once
+
+#include "esp_one_wire.h"
+
+namespace esphome {
+namespace dallas {
+
+/** Tries a grid of read sample points and slot lengths on a live bus.
+ *
+ * Each grid point follows a known device's ROM with a search a few times and
+ * counts the searches whose bits differ from a reference pass at the normal
+ * timing. Results are logged as one line per point. At
+ * the end the shortest slot with error free sample points around one is
+ * picked, sampling in the middle of its longest error free run.
+ */
+class OneWireTimingSweep {
+ public:
+  static const uint8_t ROUNDS = 10;
+  /// Searches per step(), so a step doesn't hold up the loop for long.
+  static const uint8_t ROUNDS_PER_STEP = 2;
+  static const uint8_t MAX_SAMPLES = 12;
+  static const uint8_t SLOT_COUNT = 4;
+
+  /// Start sweeping, false if the read low time leaves no sample point to try or the device doesn't answer.
+  bool start(ESPOneWire *wire, uint64_t address);
+  /// Run the next searches of the current grid point, returns false when the sweep is done.
+  bool step();
+  bool is_running() const { return this->wire_ != nullptr; }
+  /// The fastest safe timing, only valid when found() after the sweep.
+  bool found() const { return this->found_; }
+  const OneWireTiming &get_best() const { return this->best_; }
+
+ protected:
+  void finish_();
+  /// Follow the ROM with a search, recording the id and complement bits read, false if it went elsewhere.
+  bool follow_(uint64_t &ids, uint64_t &complements);
+  OneWireTiming point_timing_(uint8_t sample, uint8_t slot) const;
+
+  ESPOneWire *wire_{nullptr};
+  uint64_t address_{0};
+  /// What following the ROM reads at the normal timing.
+  uint64_t ids_{0};
+  uint64_t complements_{0};
+  OneWireTiming original_;
+  uint8_t first_sample_{0};
+  uint8_t sample_count_{0};
+  uint8_t point_{0};
+  uint8_t round_{0};
+  uint8_t errors_[SLOT_COUNT][MAX_SAMPLES];
+  uint32_t bus_us_[SLOT_COUNT][MAX_SAMPLES];
+  OneWireTiming best_;
+  bool found_{false};
+};
+
+}  // namespace dallas
+}  // namespace esphome
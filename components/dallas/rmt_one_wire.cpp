@@ -0,0 +1,221 @@
+#include "esphome/core/defines.h"
+
+#ifdef USE_DALLAS_RMT
+
+#include "rmt_one_wire.h"
+#include "esphome/core/log.h"
+#include <driver/gpio.h>
+#include <algorithm>
+
+namespace esphome {
+namespace dallas {
+
+static const char *const TAG = "dallas.rmt";
+
+// 80MHz APB clock, 1µs per tick
+static const uint8_t RMT_CLOCK_DIVIDER = 80;
+// ignore glitches shorter than 1.25µs, in APB clock cycles
+static const uint8_t RMT_FILTER_TICKS = 100;
+// a frame holds MAX_SLOTS items, takes two memory blocks
+static const uint8_t RMT_RX_MEMORY_BLOCKS = 2;
+static const size_t RMT_RX_BUFFER_SIZE = 1024;
+static const uint32_t RMT_RX_TIMEOUT_MS = 20;
+
+RMTOneWire::RMTOneWire(InternalGPIOPin *pin, rmt_channel_t tx_channel, rmt_channel_t rx_channel)
+    : tx_channel_(tx_channel), rx_channel_(rx_channel) {
+  this->gpio_ = pin->get_pin();
+  this->pin_number_ = this->gpio_;
+}
+
+bool RMTOneWire::setup() {
+  auto gpio = static_cast<gpio_num_t>(this->gpio_);
+  rmt_config_t tx_config = RMT_DEFAULT_CONFIG_TX(gpio, this->tx_channel_);
+  tx_config.clk_div = RMT_CLOCK_DIVIDER;
+  tx_config.tx_config.idle_output_en = true;
+  tx_config.tx_config.idle_level = RMT_IDLE_LEVEL_HIGH;
+  if (rmt_config(&tx_config) != ESP_OK || rmt_driver_install(this->tx_channel_, 0, 0) != ESP_OK) {
+    ESP_LOGE(TAG, "RMT channel %u can't transmit", this->tx_channel_);
+    return false;
+  }
+
+  rmt_config_t rx_config = RMT_DEFAULT_CONFIG_RX(gpio, this->rx_channel_);
+  rx_config.clk_div = RMT_CLOCK_DIVIDER;
+  rx_config.mem_block_num = RMT_RX_MEMORY_BLOCKS;
+  rx_config.rx_config.filter_en = true;
+  rx_config.rx_config.filter_ticks_thresh = RMT_FILTER_TICKS;
+  rx_config.rx_config.idle_threshold = OneWirePulseTrain::SLOT_IDLE_US;
+  if (rmt_config(&rx_config) != ESP_OK || rmt_driver_install(this->rx_channel_, RMT_RX_BUFFER_SIZE, 0) != ESP_OK ||
+      rmt_get_ringbuf_handle(this->rx_channel_, &this->rx_buffer_) != ESP_OK) {
+    ESP_LOGE(TAG, "RMT channel %u can't receive", this->rx_channel_);
+    rmt_driver_uninstall(this->tx_channel_);
+    return false;
+  }
+
+  // both channels stay connected, the pin is turned into an open drain input and output
+  gpio_set_pull_mode(gpio, GPIO_PULLUP_ONLY);
+  gpio_set_direction(gpio, GPIO_MODE_INPUT_OUTPUT_OD);
+  return true;
+}
+
+uint8_t RMTOneWire::transfer_(const OneWirePulse *pulses, uint8_t count, uint16_t idle_us, uint16_t *low_us) {
+  for (uint8_t i = 0; i < count; i++) {
+    this->items_[i].level0 = 0;
+    this->items_[i].duration0 = pulses[i].low_us;
+    this->items_[i].level1 = 1;
+    this->items_[i].duration1 = pulses[i].high_us;
+  }
+  rmt_set_rx_idle_thresh(this->rx_channel_, idle_us);
+  rmt_rx_start(this->rx_channel_, true);
+  rmt_write_items(this->tx_channel_, this->items_, count, true);
+
+  size_t size = 0;
+  auto *captured = static_cast<rmt_item32_t *>(
+      xRingbufferReceive(this->rx_buffer_, &size, pdMS_TO_TICKS(RMT_RX_TIMEOUT_MS)));
+  uint8_t n = 0;
+  if (captured != nullptr) {
+    // the capture alternates levels, a zero duration ends it
+    for (size_t i = 0; i < size / sizeof(rmt_item32_t) && n < OneWirePulseTrain::MAX_SLOTS; i++) {
+      if (captured[i].duration0 == 0)
+        break;
+      if (captured[i].level0 == 0)
+        low_us[n++] = captured[i].duration0;
+      if (captured[i].duration1 == 0)
+        break;
+      if (captured[i].level1 == 0 && n < OneWirePulseTrain::MAX_SLOTS)
+        low_us[n++] = captured[i].duration1;
+    }
+    vRingbufferReturnItem(this->rx_buffer_, captured);
+  }
+  rmt_rx_stop(this->rx_channel_);
+  return n;
+}
+
+bool RMTOneWire::reset_(bool overdrive) {
+  this->flush();
+  uint32_t start = micros();
+  this->stats_.resets++;
+  uint8_t count = this->transfer_(&OneWirePulseTrain::RESET, 1, OneWirePulseTrain::RESET_IDLE_US, this->low_us_);
+  bool r = OneWirePulseTrain::decode_presence(this->low_us_, count);
+  if (!r)
+    this->stats_.presence_failures++;
+  this->stats_.bus_us += micros() - start;
+  ONE_WIRE_RECORD(this, reset, micros() - start);
+  return r;
+}
+
+bool RMTOneWire::run_train_() {
+  if (this->train_.empty())
+    return true;
+  uint32_t start = micros();
+  uint8_t count = this->transfer_(this->train_.get_pulses(), this->train_.size(), OneWirePulseTrain::SLOT_IDLE_US,
+                                  this->low_us_);
+  bool ok = this->train_.decode(this->low_us_, count);
+  if (!ok)
+    ESP_LOGW(TAG, "Captured %u of %u slots", count, this->train_.size());
+  this->stats_.slots += this->train_.size();
+  this->stats_.bus_us += micros() - start;
+  return ok;
+}
+
+void RMTOneWire::flush() {
+  this->run_train_();
+  this->train_.clear();
+}
+
+void RMTOneWire::write_bit(bool bit) {
+  if (!this->train_.add_write(bit)) {
+    this->flush();
+    this->train_.add_write(bit);
+  }
+  // outside a transaction nothing would send it later
+  if (this->transaction_depth_ == 0)
+    this->flush();
+}
+
+void RMTOneWire::write8(uint8_t val) {
+  if (!this->train_.add_write8(val)) {
+    this->flush();
+    this->train_.add_write8(val);
+  }
+  if (this->transaction_depth_ == 0)
+    this->flush();
+}
+
+void RMTOneWire::read_train_(uint8_t *data, uint8_t len) {
+  // the queued writes go out in the same train, the reads are the last slots
+  if (this->train_.size() + len * 8 > OneWirePulseTrain::MAX_SLOTS)
+    this->flush();
+  for (uint8_t i = 0; i < len * 8; i++)
+    this->train_.add_read();
+  bool ok = this->run_train_();
+  for (uint8_t i = 0; i < len; i++) {
+    uint8_t value = 0;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      if (!ok || this->train_.get_read(i * 8 + bit))
+        value |= 1u << bit;
+    }
+    data[i] = value;
+  }
+  this->train_.clear();
+}
+
+uint8_t RMTOneWire::read8() {
+  uint8_t value;
+  this->read_train_(&value, 1);
+  return value;
+}
+
+void RMTOneWire::read_bytes(uint8_t *data, uint16_t len) {
+  static const uint8_t MAX_BYTES = OneWirePulseTrain::MAX_SLOTS / 8;
+  while (len > 0) {
+    uint8_t chunk = std::min<uint16_t>(len, MAX_BYTES);
+    this->read_train_(data, chunk);
+    data += chunk;
+    len -= chunk;
+  }
+}
+
+bool RMTOneWire::read_bit() {
+  if (this->train_.is_full())
+    this->flush();
+  this->train_.add_read();
+  bool r = !this->run_train_() || this->train_.get_read(0);
+  this->train_.clear();
+  return r;
+}
+
+uint8_t RMTOneWire::tribit(bool dir) {
+  if (this->train_.size() + 2 > OneWirePulseTrain::MAX_SLOTS)
+    this->flush();
+  this->train_.add_read();
+  this->train_.add_read();
+  bool ok = this->run_train_();
+  bool id_bit = !ok || this->train_.get_read(0);
+  bool cmp_id_bit = !ok || this->train_.get_read(1);
+  this->train_.clear();
+
+  if (id_bit != cmp_id_bit) {
+    dir = id_bit;
+  } else if (id_bit) {
+    // no one there
+    dir = true;
+  }
+  // the direction goes out with the next two read slots
+  this->write_bit(dir);
+
+  uint8_t res = 0;
+  if (id_bit)
+    res |= TRIBIT_SINGLE_BIT;
+  if (cmp_id_bit)
+    res |= TRIBIT_SECOND_BIT;
+  if (dir)
+    res |= TRIBIT_BRANCH_BIT;
+  return res;
+}
+
+std::string RMTOneWire::dump_summary() const { return str_sprintf("GPIO%u via RMT", this->gpio_); }
+
+}  // namespace dallas
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#ifdef USE_DALLAS_RMT
+
+#include "esp_one_wire.h"
+#include "one_wire_pulse.h"
+#include <driver/rmt.h>
+
+namespace esphome {
+namespace dallas {
+
+/** 1-Wire bus on the ESP32 RMT peripheral.
+ *
+ * One RMT channel sends the slots and another one on the same open drain pin
+ * captures the bus, interrupts stay enabled. Writes are queued until a read,
+ * a reset or the end of the transaction, so a select, command and payload go
+ * out as one pulse train. Standard speed only.
+ */
+class RMTOneWire : public ESPOneWire {
+ public:
+  RMTOneWire(InternalGPIOPin *pin, rmt_channel_t tx_channel, rmt_channel_t rx_channel);
+
+  /// Install the RMT drivers, returns false if a channel isn't available.
+  bool setup();
+
+  void write_bit(bool bit) override;
+  bool read_bit() override;
+  void write8(uint8_t val) override;
+  uint8_t read8() override;
+  void read_bytes(uint8_t *data, uint16_t len) override;
+  uint8_t tribit(bool dir) override;
+  void flush() override;
+  std::string dump_summary() const override;
+  bool supports_overdrive() const override { return false; }
+
+ protected:
+  bool reset_(bool overdrive) override;
+  /// Send the pulses and collect the low time of every captured pulse.
+  uint8_t transfer_(const OneWirePulse *pulses, uint8_t count, uint16_t idle_us, uint16_t *low_us);
+  /// Send the queued slots and decode the read slots.
+  bool run_train_();
+  /// Queue read slots for len bytes, send them and unpack the bits.
+  void read_train_(uint8_t *data, uint8_t len);
+
+  uint8_t gpio_;
+  rmt_channel_t tx_channel_;
+  rmt_channel_t rx_channel_;
+  RingbufHandle_t rx_buffer_{nullptr};
+  OneWirePulseTrain train_;
+  rmt_item32_t items_[OneWirePulseTrain::MAX_SLOTS];
+  uint16_t low_us_[OneWirePulseTrain::MAX_SLOTS];
+};
+
+}  // namespace dallas
+}  // namespace esphome
+
+#endif
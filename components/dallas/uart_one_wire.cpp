@@ -0,0 +1,107 @@
+#include "esphome/core/defines.h"
+
+#ifdef USE_DALLAS_UART
+
+#include "uart_one_wire.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace dallas {
+
+static const char *const TAG = "dallas.uart";
+
+static const uint32_t UART_RESET_BAUD_RATE = 9600;
+static const uint32_t UART_SLOT_BAUD_RATE = 115200;
+// start bit and the low bits form the reset pulse, presence pulls the high bits low
+static const uint8_t UART_RESET_BYTE = 0xF0;
+// the start bit is the write 1 / read low time
+static const uint8_t UART_SLOT_ONE = 0xFF;
+static const uint8_t UART_SLOT_ZERO = 0x00;
+
+void UARTOneWire::set_baud_rate_(uint32_t baud_rate) {
+  if (this->baud_rate_ == baud_rate)
+    return;
+  this->uart::UARTDevice::flush();
+  this->parent_->set_baud_rate(baud_rate);
+  this->parent_->load_settings(false);
+  this->baud_rate_ = baud_rate;
+}
+
+bool UARTOneWire::transfer_(const uint8_t *tx, uint8_t *rx, uint8_t len) {
+  // drop anything left over from a failed transfer
+  while (this->available() > 0)
+    this->read();
+  this->write_array(tx, len);
+  if (!this->read_array(rx, len)) {
+    ESP_LOGW(TAG, "No echo, is RX connected to the bus?");
+    return false;
+  }
+  return true;
+}
+
+bool UARTOneWire::reset_(bool overdrive) {
+  uint32_t start = micros();
+  this->stats_.resets++;
+  this->set_baud_rate_(UART_RESET_BAUD_RATE);
+  uint8_t echo;
+  // an unchanged echo means nothing answered, all zero means the bus is shorted
+  bool r = this->transfer_(&UART_RESET_BYTE, &echo, 1) && echo != UART_RESET_BYTE && echo != 0;
+  this->set_baud_rate_(UART_SLOT_BAUD_RATE);
+  if (!r)
+    this->stats_.presence_failures++;
+  this->stats_.bus_us += micros() - start;
+  ONE_WIRE_RECORD(this, reset, micros() - start);
+  return r;
+}
+
+void UARTOneWire::write_bit(bool bit) {
+  uint32_t start = micros();
+  uint8_t tx = bit ? UART_SLOT_ONE : UART_SLOT_ZERO;
+  uint8_t echo;
+  this->transfer_(&tx, &echo, 1);
+  this->stats_.slots++;
+  this->stats_.bus_us += micros() - start;
+}
+
+bool UARTOneWire::read_bit() {
+  uint32_t start = micros();
+  uint8_t echo = 0xFF;
+  this->transfer_(&UART_SLOT_ONE, &echo, 1);
+  this->stats_.slots++;
+  this->stats_.bus_us += micros() - start;
+  return echo == UART_SLOT_ONE;
+}
+
+void UARTOneWire::write8(uint8_t val) {
+  uint32_t start = micros();
+  uint8_t tx[8];
+  uint8_t echo[8];
+  for (uint8_t i = 0; i < 8; i++)
+    tx[i] = (val & (1u << i)) ? UART_SLOT_ONE : UART_SLOT_ZERO;
+  this->transfer_(tx, echo, 8);
+  this->stats_.slots += 8;
+  this->stats_.bus_us += micros() - start;
+}
+
+uint8_t UARTOneWire::read8() {
+  uint32_t start = micros();
+  uint8_t tx[8];
+  uint8_t echo[8];
+  memset(tx, UART_SLOT_ONE, sizeof(tx));
+  uint8_t ret = 0xFF;
+  if (this->transfer_(tx, echo, 8)) {
+    ret = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      if (echo[i] == UART_SLOT_ONE)
+        ret |= 1u << i;
+    }
+  }
+  this->stats_.slots += 8;
+  this->stats_.bus_us += micros() - start;
+  return ret;
+}
+
+}  // namespace dallas
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#ifdef USE_DALLAS_UART
+
+#include "esphome/components/uart/uart.h"
+#include "esp_one_wire.h"
+
+namespace esphome {
+namespace dallas {
+
+/** 1-Wire bus driven by a UART with TX and RX tied to the bus.
+ *
+ * A reset is one byte at 9600 baud, each time slot one byte at 115200 baud.
+ * The UART generates the timing, bytes go through the FIFO as 8 slots at once.
+ * Standard speed only.
+ */
+class UARTOneWire : public ESPOneWire, public uart::UARTDevice {
+ public:
+  explicit UARTOneWire(uart::UARTComponent *parent) : UARTDevice(parent) {}
+
+  void write_bit(bool bit) override;
+  bool read_bit() override;
+  void write8(uint8_t val) override;
+  uint8_t read8() override;
+  std::string dump_summary() const override { return "UART"; }
+  bool supports_overdrive() const override { return false; }
+
+ protected:
+  bool reset_(bool overdrive) override;
+  /// Send slots and read back their echo, a device pulling the bus low shows in the echo.
+  bool transfer_(const uint8_t *tx, uint8_t *rx, uint8_t len);
+  void set_baud_rate_(uint32_t baud_rate);
+
+  uint32_t baud_rate_{0};
+};
+
+}  // namespace dallas
+}  // namespace esphome
+
+#endif
@@ -34,13 +34,30 @@ bool DallasTemperatureSensor::is_supported(uint8_t *address8) {
         address8[0] == DALLAS_MODEL_DS28EA00);
 }
 
+bool DallasTemperatureSensor::get_family_codes(std::vector<uint8_t> &families) {
+  families.insert(families.end(), {DALLAS_MODEL_DS18S20, DALLAS_MODEL_DS1822, DALLAS_MODEL_DS18B20,
+                                   DALLAS_MODEL_DS1825, DALLAS_MODEL_DS28EA00});
+  return true;
+}
+
 uint8_t DallasTemperatureSensor::get_resolution() const { return this->resolution_; }
 void DallasTemperatureSensor::set_resolution(uint8_t resolution) { this->resolution_ = resolution; }
 
-void DallasTemperatureSensor::read_conversion() {
-  bool res = this->read_scratch_pad();
+void DallasTemperatureSensor::read_conversion() { this->process_scratch_pad_(this->read_scratch_pad()); }
+
+uint8_t DallasTemperatureSensor::get_conversion_read(uint8_t &command) {
+  command = DALLAS_COMMAND_READ_SCRATCH_PAD;
+  return sizeof(this->scratch_pad_);
+}
+
+void DallasTemperatureSensor::finish_conversion_read(const uint8_t *data, bool ok) {
+  if (ok)
+    memcpy(this->scratch_pad_, data, sizeof(this->scratch_pad_));
+  this->process_scratch_pad_(ok);
+}
 
-  if (!res) {
+void DallasTemperatureSensor::process_scratch_pad_(bool read) {
+  if (!read) {
     ESP_LOGW(TAG, "'%s' - Resetting bus for read failed!", this->get_name().c_str());
     this->publish_state(NAN);
     status_set_warning();
@@ -70,7 +87,7 @@ bool IRAM_ATTR DallasTemperatureSensor::read_scratch_pad() {
   }
 
   {
-    InterruptLock lock;
+    OneWireLock lock(wire);
 
     wire->select(this->address_);
     wire->write8(DALLAS_COMMAND_READ_SCRATCH_PAD);
@@ -89,7 +106,7 @@ bool DallasTemperatureSensor::write_scatch_pad() {
     return false;
   }
   {
-    InterruptLock lock;
+    OneWireLock lock(wire);
     wire->select(this->address_);
     wire->write8(DALLAS_COMMAND_WRITE_SCRATCH_PAD);
     wire->write8(this->scratch_pad_[2]);  // high alarm temp
@@ -127,24 +144,30 @@ bool DallasTemperatureSensor::setup_sensor() {
   if (!this->check_scratch_pad())
     return false;
 
-  if (this->scratch_pad_[4] == this->resolution_)
+  // DS18S20 doesn't support resolution.
+  if (this->get_address8()[0] == DALLAS_MODEL_DS18S20)
     return false;
 
+  uint8_t config;
   switch (this->resolution_) {
     case 12:
-      this->scratch_pad_[4] = 0x7F;
+      config = 0x7F;
       break;
     case 11:
-      this->scratch_pad_[4] = 0x5F;
+      config = 0x5F;
       break;
     case 10:
-      this->scratch_pad_[4] = 0x3F;
+      config = 0x3F;
       break;
     case 9:
     default:
-      this->scratch_pad_[4] = 0x1F;
+      config = 0x1F;
       break;
   }
+  // only write, and wear the EEPROM, when the configured resolution differs
+  if (this->scratch_pad_[4] == config)
+    return false;
+  this->scratch_pad_[4] = config;
 
   this->scratch_pad_[2] = 125;
   this->scratch_pad_[3] = -55;
@@ -173,8 +196,11 @@ bool DallasTemperatureSensor::check_scratch_pad() {
 #endif
   if (!chksum_validity) {
     ESP_LOGW(TAG, "'%s' - Scratch pad checksum invalid!", this->get_name().c_str());
+    this->transfer_failed_();
   } else if (!config_validity) {
     ESP_LOGW(TAG, "'%s' - Scratch pad config register invalid!", this->get_name().c_str());
+  } else {
+    this->transfer_ok_();
   }
   return chksum_validity && config_validity;
 }
@@ -182,7 +208,7 @@ float DallasTemperatureSensor::get_temp_c() {
   int16_t temp = (int16_t(this->scratch_pad_[1]) << 11) | (int16_t(this->scratch_pad_[0]) << 3);
   if (this->get_address8()[0] == DALLAS_MODEL_DS18S20) {
     int diff = (this->scratch_pad_[7] - this->scratch_pad_[6]) << 7;
-    temp = ((temp & 0xFFF0) << 3) - 16 + (diff / this->scratch_pad_[7]);
+    temp = ((temp & 0xFFF0) << 3) - 32 + (diff / this->scratch_pad_[7]);
   }
 
   return temp / 128.0f;
@@ -18,9 +18,12 @@ class DallasTemperatureSensor : public DallasSensor {
   uint16_t millis_to_wait_for_conversion() const override;
 
   bool is_supported(uint8_t *address8) override;
+  bool get_family_codes(std::vector<uint8_t> &families) override;
   bool setup_sensor() override;
   void dump_config() override;
   void read_conversion() override;
+  uint8_t get_conversion_read(uint8_t &command) override;
+  void finish_conversion_read(const uint8_t *data, bool ok) override;
 
   bool read_scratch_pad();
   bool write_scatch_pad();
@@ -30,6 +33,9 @@ class DallasTemperatureSensor : public DallasSensor {
   float get_temp_c();
 
  protected:
+  /// Publish the temperature from the scratch pad, read tells whether reading it worked.
+  void process_scratch_pad_(bool read);
+
   uint8_t resolution_;
   uint8_t scratch_pad_[9] = {
       0,
@@ -12,6 +12,11 @@ bool DS2405Device::is_supported(uint8_t *address8) {
 	return address8[0] == DALLAS_MODEL_DS2405;
 }
 
+bool DS2405Device::get_family_codes(std::vector<uint8_t> &families) {
+	families.push_back(DALLAS_MODEL_DS2405);
+	return true;
+}
+
 bool DS2405Device::setup_sensor() {
     this->current_state_ = this->search(false);
     this->current_ctrl_ = !this->search(true);
@@ -19,13 +24,17 @@ bool DS2405Device::setup_sensor() {
 }
 
 bool DS2405Device::set_state(bool state) {
-    if (this->current_ctrl_ != state) {
-        bool cur = this->toggle_pin();
-        if(cur == state) {
-            ESP_LOGD(TAG, "State error state=%d cur=%d", state, cur);
+    this->target_ctrl_ = state;
+    this->submit_(DALLAS_KEY_WRITE, DALLAS_PRIORITY_ACTUATOR, [this]() {
+        bool state = this->target_ctrl_;
+        if (this->current_ctrl_ != state) {
+            bool cur = this->toggle_pin();
+            if(cur != state) {
+                ESP_LOGD(TAG, "State error state=%d cur=%d", state, cur);
+            }
+            this->current_ctrl_ = state;
         }
-        this->current_ctrl_ = state;
-    }
+    });
     return state;
 }
 
@@ -54,7 +63,7 @@ bool DS2405Device::toggle_pin() {
 
     bool bit1,bit2;
     {
-        InterruptLock lock;
+        OneWireLock lock(wire);
 
         wire->select(this->address_);
         bit1 = wire->read_bit();
@@ -76,7 +85,7 @@ bool DS2405Device::search(bool active) {
 
     uint64_t sel;
     {
-        InterruptLock lock;
+        OneWireLock lock(wire);
         sel = wire->search_select(this->address_, cmd);
         if ( sel == this->address_ )
             bit = wire->read_bit();
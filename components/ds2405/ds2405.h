@@ -12,11 +12,16 @@ class DS2405Device : public DallasDevice, public DallasPinComponent {
  public:
   bool setup_sensor() override;
   bool is_supported(uint8_t *address8) override;
+  bool get_family_codes(std::vector<uint8_t> &families) override;
   void dump_config() override;
+  /// No Skip ROM, the match itself toggles the PIO.
+  bool needs_match_rom() const override { return true; }
 
  protected:
   bool current_state_;
   bool current_ctrl_;
+  /// State of the last write, the toggle is queued.
+  bool target_ctrl_;
 
   // gpio pin component
   bool digital_read_(uint8_t pin) override;
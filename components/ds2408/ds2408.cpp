@@ -17,6 +17,11 @@ bool DS2408Component::is_supported(uint8_t *address8) {
 	return address8[0] == DALLAS_MODEL_DS2408;
 }
 
+bool DS2408Component::get_family_codes(std::vector<uint8_t> &families) {
+	families.push_back(DALLAS_MODEL_DS2408);
+	return true;
+}
+
 void DS2408Component::setup() {
   ESP_LOGD(TAG,"reading");
   uint16_t addr = 0x88;
@@ -67,9 +72,11 @@ bool DS2408Component::digital_read_(uint8_t pin) {
     return (this->read_value_ & (1<<pin)) != 0;
 }
 void DS2408Component::update() {
-  auto pio = read_channel();
-  if(pio.has_value())
-    this->read_value_ = pio.value();
+  this->submit_(DALLAS_KEY_READ, DALLAS_PRIORITY_SENSOR, [this]() {
+    auto pio = read_channel();
+    if(pio.has_value())
+      this->read_value_ = pio.value();
+  });
 }
 float DS2408Component::get_setup_priority() const { return setup_priority::IO; }
 
@@ -84,8 +91,9 @@ void DS2408Component::digital_write_(uint8_t pin, bool value) {
     this->value_ |= 1<<pin;
   else
     this->value_ &= ~(1<<pin);
-  
-  write_channel(this->value_);
+
+  // a write still queued picks up this change too
+  this->submit_(DALLAS_KEY_WRITE, DALLAS_PRIORITY_ACTUATOR, [this]() { this->write_channel(this->value_); });
 }
 
 /// Helper function to set the pin mode of a pin.
@@ -115,53 +123,26 @@ ESP_LOGD(TAG,"Updating cond");
 }
 
 optional<uint8_t> DS2408Component::read_channel() {
-  auto *wire = this->get_reset_one_wire_();
-  if(wire == nullptr){
+  OneWireProgram program;
+  program.write(DALLAS_CHANNEL_ACCESS_READ).read(1);
+  if (!this->run_program_(program))
     return {};
-  }
-  {
-    InterruptLock lock;
-
-    wire->select(this->address_);
-    wire->write8(DALLAS_CHANNEL_ACCESS_READ);
-    return wire->read8();
-  }
+  return program.get_read()[0];
 }
 
 void DS2408Component::write_channel(uint8_t value) {
-  auto *wire = this->get_reset_one_wire_();
-  if(wire == nullptr){
-    return;
-  }
-  uint8_t chk, val;
-  {
-    InterruptLock lock;
-
-    wire->select(this->address_);
-    wire->write8(DALLAS_CHANNEL_ACCESS_WRITE);
-    wire->write8(value);
-    wire->write8(~value);
-    chk = wire->read8();
-    val = wire->read8();
-  }
-
-  if(chk != 0xAA && val != value) {
-    ESP_LOGD(TAG,"Write chk:%02x val:%02x", chk, val);
-  }
+  OneWireBenchmark bench(this->get_one_wire_(), "ds2408.write_channel");
+  OneWireProgram program;
+  // the byte after the confirmation is the new pin state
+  program.write(DALLAS_CHANNEL_ACCESS_WRITE).write_inverted(value).confirm().read(1);
+  this->run_program_(program);
 }
 
 
 void DS2408Component::reset_activity() {
-  auto *wire = this->get_reset_one_wire_();
-  if(wire == nullptr){
-    return;
-  }
-  {
-    InterruptLock lock;
-
-    wire->select(this->address_);
-    wire->write8(DALLAS_RESET_ACTIVITY_LATCHES);
-  }
+  OneWireProgram program;
+  program.write(DALLAS_RESET_ACTIVITY_LATCHES).confirm();
+  this->run_program_(program);
 }
 
 void DS2408Component::write_channel_search_register(uint8_t mask, uint8_t pol, uint8_t config) {
@@ -173,62 +154,26 @@ ESP_LOGD(TAG,"Set pin mode mask=%02x pol=%02x config=%02x read=%02x", this->pin_
 bool DS2408Component::read_registers(uint8_t cmd, uint16_t addr, uint8_t *buffer, uint8_t len) {
   if (addr < 0x88 || (addr+len) > 0x90)
     return false;
-  auto *wire = this->get_reset_one_wire_();
-  if(wire == nullptr){
-    return false;
-  }
-
   uint8_t req[3] = { cmd,
     (uint8_t)(addr & 0xff),
     (uint8_t)((addr>>8) & 0xff )};
 
-  bool calc_crc = addr+len == 0x90;
-  uint8_t response[len + (calc_crc ? 2 : 0)];
-
-  {
-    InterruptLock lock;
-
-    wire->select(this->address_);
-    wire->write8( req[0] ); //cmd
-    wire->write8( req[1] );
-    wire->write8( req[2] );
-    for (unsigned char &i : response) {
-      i = wire->read8();
-	  }
-  }
-
-  if (calc_crc) {
-    uint16_t crc_res = buffer[len] | (buffer[len+1]<<8);
-    uint16_t crc = dallas::crc16(req, 3, 0, 0xa001, false, false);
-    crc = dallas::crc16(response, len, crc, 0xa001, false, true);
-
-    if ( crc != crc_res ) {
-      ESP_LOGW(TAG, "Failed to read reg - bad crc");
-      return false;
-    }
-  }
+  OneWireProgram program;
+  program.write(req, 3).read(len);
+  // the crc only follows a read up to the end of the register page
+  if (addr+len == 0x90)
+    program.check_crc16();
+  if (!this->run_program_(program))
+    return false;
 
-  memcpy(buffer, response, len);
+  memcpy(buffer, program.get_read(), len);
   return true;
 }
 
 void DS2408Component::write_registers(uint8_t cmd, uint8_t addr, uint8_t const* buffer, uint8_t len) {
-  auto *wire = this->get_reset_one_wire_();
-  if(wire == nullptr){
-    return;
-  }
-
-  {
-    InterruptLock lock;
-
-    wire->select(this->address_);
-    wire->write8(cmd);
-    wire->write8(addr);
-    wire->write8(0); // addr high
-    for( uint8_t i = 0; i < len; i++) {
-      wire->write8(buffer[i]);
-    }
-  }
+  OneWireProgram program;
+  program.write(cmd).write(addr).write(0).write(buffer, len); // addr high
+  this->run_program_(program);
 }
 
 }
@@ -11,6 +11,7 @@ class DS2408GPIOPin;
 class DS2408Component : public PollingComponent, public dallas::DallasDevice, public dallas::DallasPinComponent {
  public:
   bool is_supported(uint8_t *address8);
+  bool get_family_codes(std::vector<uint8_t> &families) override;
 
   /// Check dallas availability and setup masks
   void setup() override;
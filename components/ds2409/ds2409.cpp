@@ -15,7 +15,15 @@ static const uint8_t DALLAS_SMART_ON_MAIN = 0xcc;
 static const uint8_t DALLAS_SMART_ON_AUX = 0x33;
 
 ESPOneWire *DS2409Network::get_reset_one_wire_() { return this->parent_->get_reset_one_wire_child_(this->main_); }
+ESPOneWire *DS2409Network::get_one_wire_() { return this->parent_->get_one_wire_(); }
 Component *DS2409Network::get_component() { return this->parent_; }
+uint32_t DS2409Network::get_rom_cache_hash_() {
+    return fnv1_hash("dallas_rom_" + this->parent_->get_address_name() + (this->main_ ? "_main" : "_aux"));
+}
+DallasNetwork *DS2409Network::get_root_network() {
+    auto *network = this->parent_->parent_;
+    return network != nullptr ? network->get_root_network() : this;
+}
 void DS2409Network::component_set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f)
 {
     parent_->set_timeout(name, timeout, std::move(f));
@@ -37,6 +45,11 @@ bool DS2409Component::is_supported(uint8_t *address8) {
 	return address8[0] == DALLAS_MODEL_DS2409;
 }
 
+bool DS2409Component::get_family_codes(std::vector<uint8_t> &families) {
+	families.push_back(DALLAS_MODEL_DS2409);
+	return true;
+}
+
 float DS2409Component::get_setup_priority() const { return setup_priority::IO + 1.f; }
 
 bool DS2409Component::setup_sensor() {
@@ -52,12 +65,31 @@ bool DS2409Component::setup_sensor() {
     auto info = this->status_update(state_reg);
     this->current_state_ = info & 0x40;
 
-    this->main.setup_sensors();
-    this->aux.setup_sensors();
+    bool rom_cache = this->parent_ != nullptr && this->parent_->get_rom_cache();
+    this->main.set_rom_cache(rom_cache);
+    this->aux.set_rom_cache(rom_cache);
+    // the branches are enumerated from loop(), main first then aux
+    this->main.start_discovery();
 
     return true;
 }
 
+void DS2409Component::loop() {
+    // wait for the bus above to be done, a switched on branch would show up in its search
+    if (this->parent_ != nullptr && !this->parent_->is_discovery_done())
+        return;
+    // searching a branch is the lowest priority bus work
+    if (this->parent_ != nullptr && !this->parent_->is_bus_idle())
+        return;
+    if (this->main.is_discovering()) {
+        if (this->main.discovery_step())
+            this->aux.start_discovery();
+    } else if (this->aux.is_discovering()) {
+        if (this->aux.discovery_step())
+            this->all_off();
+    }
+}
+
 void DS2409Component::dump_config() {
   DallasDevice::dump_config();
   ESP_LOGCONFIG(TAG, "    Device: ds2409");
@@ -72,9 +104,13 @@ void DS2409Component::dump_config() {
 void DS2409Component::update() {
 //    this->current_state_ = search(false);
 //    this->publish_state(this->current_state_);
-    this->main.update_conversions();
-    this->aux.update_conversions();
-    this->all_off();
+    this->main.publish_device_stats();
+    this->aux.publish_device_stats();
+    this->submit_(DALLAS_KEY_READ, DALLAS_PRIORITY_SENSOR, [this]() {
+        this->main.update_conversions();
+        this->aux.update_conversions();
+        this->all_off();
+    });
 }
 
 void DS2409Component::set_alert_activity(bool f) { this->alert_activity_ = f; }
@@ -86,12 +122,14 @@ void DS2409Component::notify_alerting() {
 }
 
 void DS2409Component::write_state(bool state) {
-    if (this->current_ctrl_ != state) {
-        uint8_t info = this->status_update( 0x20 | (state ? 0x80 : 0));
-        state = !!(info & 0x40);
-        this->current_ctrl_ = state;
-        this->publish_state(state);
-    }
+    this->submit_(DALLAS_KEY_WRITE, DALLAS_PRIORITY_ACTUATOR, [this, state]() {
+        if (this->current_ctrl_ != state) {
+            uint8_t info = this->status_update( 0x20 | (state ? 0x80 : 0));
+            bool result = !!(info & 0x40);
+            this->current_ctrl_ = result;
+            this->publish_state(result);
+        }
+    });
 }
 
 bool DS2409Component::digital_read_(uint8_t pin) {
@@ -114,7 +152,7 @@ uint8_t DS2409Component::status_update(uint8_t config) {
 
     uint8_t info, info_chk;
     {
-        InterruptLock lock;
+        OneWireLock lock(wire);
 
         wire->select(this->address_);
         wire->write8(DALLAS_STATUS_CMD);
@@ -141,7 +179,7 @@ bool DS2409Component::direct_onmain() {
     }
 
     {
-        InterruptLock lock;
+        OneWireLock lock(wire);
         wire->select(this->address_);
         wire->write8(DALLAS_DIRECT_ON_MAIN);
         auto confirm = wire->read8();
@@ -155,6 +193,7 @@ bool DS2409Component::direct_onmain() {
 }
 
 ESPOneWire *DS2409Component::smart_on(bool main) {
+    OneWireBenchmark bench(this->get_one_wire_(), "ds2409.smart_on");
     auto *wire = this->get_reset_one_wire_();
     if(wire == nullptr){
         return nullptr;
@@ -166,7 +205,7 @@ ESPOneWire *DS2409Component::smart_on(bool main) {
 
     uint8_t presence;
     {
-        InterruptLock lock;
+        OneWireLock lock(wire);
         wire->select(this->address_);
         wire->write8(cmd);
         wire->write8(0xff); // reset
@@ -193,7 +232,7 @@ void DS2409Component::all_off() {
     this->direct_main = false;
 
     {
-        InterruptLock lock;
+        OneWireLock lock(wire);
 
         wire->select(this->address_);
         wire->write8(DALLAS_ALL_OFF_CMD);
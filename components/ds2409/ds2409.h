@@ -19,7 +19,12 @@ class DS2409Network : public DallasNetwork {
     bool main_;
 
   ESPOneWire *get_reset_one_wire_() override;
+  ESPOneWire *get_one_wire_() override;
+ public:
+  DallasNetwork *get_root_network() override;
+ protected:
   Component *get_component() override;
+  uint32_t get_rom_cache_hash_() override;
   void component_set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) override;
 
 };
@@ -28,8 +33,11 @@ class DS2409Component : public DallasDevice, public PollingComponent, public swi
  public:
   bool setup_sensor() override;
   bool is_supported(uint8_t *address8) override;
+  bool get_family_codes(std::vector<uint8_t> &families) override;
+  bool has_branches() const override { return true; }
   void dump_config() override;
   float get_setup_priority() const override;
+  void loop() override;
   void update() override;
   
   void notify_alerting() override;
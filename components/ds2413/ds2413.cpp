@@ -14,6 +14,11 @@ bool DS2413Device::is_supported(uint8_t *address8) {
 	return address8[0] == DALLAS_MODEL_DS2413;
 }
 
+bool DS2413Device::get_family_codes(std::vector<uint8_t> &families) {
+	families.push_back(DALLAS_MODEL_DS2413);
+	return true;
+}
+
 bool DS2413Device::setup_sensor() {
     auto state = this->pio_access_read();
     if (!state) {
@@ -40,11 +45,13 @@ void DS2413Device::digital_write_(uint8_t pin, bool value) {
     this->current_latch_ &= ~bit;
     if (value)
         this->current_latch_ |= bit;
+    this->submit_(DALLAS_KEY_WRITE, DALLAS_PRIORITY_ACTUATOR, [this]() {
 ESP_LOGD(TAG,"setting to %02x",this->current_latch_);
-    auto state = this->pio_access_write(this->current_latch_);
+        auto state = this->pio_access_write(this->current_latch_);
 ESP_LOGD(TAG,"state = %02x", state ? state.value() : -1);
-    if (state)
-        this->current_state_ = state.value();
+        if (state)
+            this->current_state_ = state.value();
+    });
 }
 
 void DS2413Device::pin_mode_(uint8_t pin, gpio::Flags flags) {
@@ -52,54 +59,31 @@ void DS2413Device::pin_mode_(uint8_t pin, gpio::Flags flags) {
 }
 
 optional<uint8_t> DS2413Device::pio_access_read() {
-    auto *wire = this->get_reset_one_wire_();
-    if(wire == nullptr){
+    OneWireProgram program;
+    program.write(DALLAS_PIO_ACCESS_READ_CMD).read(1);
+    if (!this->run_program_(program))
         return {};
-    }
-
-    uint8_t data;
-    {
-        InterruptLock lock;
-
-        wire->select(this->address_);
-        wire->write8(DALLAS_PIO_ACCESS_READ_CMD);
-        data = wire->read8();
-    }
 
+    // the high nibble is the complement of the low nibble
+    uint8_t data = program.get_read()[0];
     if ((((data & 0xf0) ^ 0xf0)>>4) != (data & 0x0f) ) {
         ESP_LOGW(TAG, "Bad data %02x", data);
+        this->transfer_failed_();
         return {};
     }
     return data & 0x0f;
 }
 
 optional<uint8_t> DS2413Device::pio_access_write(uint8_t data) {
-    auto *wire = this->get_reset_one_wire_();
-    if(wire == nullptr){
+    OneWireProgram program;
+    program.write(DALLAS_PIO_ACCESS_WRITE_CMD).write_inverted(data | 0xfc).confirm().read(1);
+    if (!this->run_program_(program))
         return {};
-    }
-
-    uint8_t confirm;
-    {
-        InterruptLock lock;
-
-        wire->select(this->address_);
-        wire->write8(DALLAS_PIO_ACCESS_WRITE_CMD);
-        data |= 0xfc;
-        wire->write8(data);
-        data ^= 0xff;
-        wire->write8(data);
-        confirm = wire->read8();
-        data = wire->read8();
-    }
-
-    if (confirm != 0xaa) {
-        ESP_LOGW(TAG, "Confirm error %02x", confirm);
-        return {};
-    }
 
+    data = program.get_read()[0];
     if ((((data & 0xf0) ^ 0xf0)>>4) != (data & 0x0f) ) {
         ESP_LOGW(TAG, "Bad data %02x", data);
+        this->transfer_failed_();
         return {};
     }
     return data & 0x0f;
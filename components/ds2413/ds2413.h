@@ -14,6 +14,7 @@ class DS2413Device : public DallasDevice, public DallasPinComponent {
  public:
   bool setup_sensor() override;
   bool is_supported(uint8_t *address8) override;
+  bool get_family_codes(std::vector<uint8_t> &families) override;
   void dump_config() override;
 
  protected:
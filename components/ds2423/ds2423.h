@@ -10,6 +10,7 @@ class DallasCounterComponent : public PollingComponent, public DallasDevice {
   DallasCounterComponent() : PollingComponent(15000) {}
   
   bool is_supported(uint8_t *address8) override;
+  bool get_family_codes(std::vector<uint8_t> &families) override;
   void update() override;
   void dump_config() override;
 
@@ -1,4 +1,5 @@
 #include "ds2438.h"
+#include "../dallas/dallas_sequence.h"
 #include "esphome/core/log.h"
 
 namespace esphome {
@@ -18,6 +19,11 @@ bool DS2438Component::is_supported(uint8_t *address8) {
 	return address8[0] == DALLAS_MODEL_DS2438;
 }
 
+bool DS2438Component::get_family_codes(std::vector<uint8_t> &families) {
+	families.push_back(DALLAS_MODEL_DS2438);
+	return true;
+}
+
 void DS2438Component::setup() {
     uint8_t buffer[8] = {0};
     // ctrl
@@ -29,13 +35,22 @@ void DS2438Component::setup() {
 void DS2438Component::update() {
   ESP_LOGD(TAG, "updating battery");
 
-    this->start_volt_conversion(false);
-    this->set_timeout("volt", 10, [this]() {this->read_volt(false);});
+    // the other devices get the bus during the 10ms conversions
+    DallasSequence(this, DALLAS_PRIORITY_SENSOR)
+        .then([this]() { return this->start_volt_conversion(false); })
+        .sleep(10)
+        .then([this]() { return this->read_volt(false); })
+        .then([this]() { return this->start_volt_conversion(true); })
+        .sleep(10)
+        .then([this]() { return this->read_volt(true); })
+        .run();
 }
 
-void DS2438Component::read_volt(bool vcc) {
+bool DS2438Component::read_volt(bool vcc) {
+    OneWireBenchmark bench(this->get_one_wire_(), "ds2438.read_volt");
     uint8_t buffer[8];
-    this->read_mem(0, buffer);
+    if (!this->read_mem(0, buffer))
+        return false;
 
     float volt = (buffer[4]<<8) + buffer[3];
     volt /= 100.0f;
@@ -45,11 +60,8 @@ void DS2438Component::read_volt(bool vcc) {
         sensor->publish_state(volt);
     }
 
-    if (!vcc) {
-        this->start_volt_conversion(true);
-        this->set_timeout("volt", 10, [this]() {this->read_volt(true);});
-        return;
-    }
+    if (!vcc)
+        return true;
 
     float current = (((int8_t)buffer[6]) << 8) + buffer[5];
     current /= 4096;
@@ -61,13 +73,14 @@ void DS2438Component::read_volt(bool vcc) {
 
     if(this->ica_sensor_ != nullptr) {
         if ( !this->read_mem(1,buffer))
-            return;
+            return false;
         float ica = buffer[4];
         ica /= 2048;
         if ( this->shunt_resistance_ != 0.0f)
             ica /= this->shunt_resistance_;
         this->ica_sensor_->publish_state(ica);
     }
+    return true;
 }
 
 void DS2438Component::dump_config() {
@@ -77,7 +90,8 @@ void DS2438Component::dump_config() {
 
 void DS2438Component::read_conversion() {
     uint8_t buffer[8];
-    bool res = this->read_mem(0, buffer);
+    if (!this->read_mem(0, buffer))
+        return;
 
     float temp = (((int8_t)buffer[2]) << 8) + buffer[1];
     temp /= 256.0f;
@@ -99,7 +113,7 @@ bool DS2438Component::start_volt_conversion(bool vcc) {
         return false;
     }
   {
-    InterruptLock lock;
+    OneWireLock lock(wire);
 
     wire->select(this->address_);
     wire->write8(DALLAS_CONVERT_VOLT_CMD);
@@ -108,73 +122,28 @@ bool DS2438Component::start_volt_conversion(bool vcc) {
 }
 
 bool DS2438Component::read_mem(uint8_t page, uint8_t *buffer) {
-    auto *wire = this->get_reset_one_wire_();
-
-    if (wire == nullptr) {
+    OneWireProgram recall;
+    recall.write(DALLAS_RECALL_MEMORY_CMD).write(page);
+    if (!this->run_program_(recall))
         return false;
-    }
-  {
-    InterruptLock lock;
 
-    wire->select(this->address_);
-    wire->write8(DALLAS_RECALL_MEMORY_CMD);
-    wire->write8(page);
-  }
-  wire = this->get_reset_one_wire_();
-
-  if (wire == nullptr) {
-    return false;
-  }
-
-  uint8_t crc;
-  {
-    InterruptLock lock;
-
-    wire->select(this->address_);
-    wire->write8(DALLAS_READ_SCATCH_PAD_CMD);
-    wire->write8(page);
-    for(uint8_t n = 0; n < 8; n++)
-        buffer[n] = wire->read8();
-    crc = wire->read8();
-  }
-
-  uint8_t crcdata = crc8(buffer, 8);
-  if ( crc != crcdata ) {
-    ESP_LOGW(TAG, "bad crc %02x %02x", crc, crcdata);
-    return false;
-  }
-  return true;
+    OneWireProgram program;
+    program.write(DALLAS_READ_SCATCH_PAD_CMD).write(page).read(8).check_crc8();
+    if (!this->run_program_(program))
+        return false;
+    memcpy(buffer, program.get_read(), 8);
+    return true;
 }
 
 bool DS2438Component::write_mem(uint8_t page, uint8_t *buffer) {
-    auto *wire = this->get_reset_one_wire_();
-
-    if (wire == nullptr) {
+    OneWireProgram program;
+    program.write(DALLAS_WRITE_SCATCH_PAD_CMD).write(page).write(buffer, 8);
+    if (!this->run_program_(program))
         return false;
-    }
-  {
-    InterruptLock lock;
-
-    wire->select(this->address_);
-    wire->write8(DALLAS_WRITE_SCATCH_PAD_CMD);
-    wire->write8(page);
-    for(uint8_t n = 0; n < 8; n++)
-        wire->write8(buffer[n]);
-  }
-  wire = this->get_reset_one_wire_();
-
-  if (wire == nullptr) {
-    return false;
-  }
-  {
-    InterruptLock lock;
-
-    wire->select(this->address_);
-    wire->write8(DALLAS_COPY_SCATCH_PAD_CMD);
-    wire->write8(page);
-  }
 
-  return true;
+    OneWireProgram copy;
+    copy.write(DALLAS_COPY_SCATCH_PAD_CMD).write(page);
+    return this->run_program_(copy);
 }
 
 }
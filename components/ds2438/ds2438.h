@@ -13,6 +13,7 @@ class DS2438Component : public PollingComponent, public DallasDevice {
   DS2438Component() : PollingComponent(15000) {}
   
   bool is_supported(uint8_t *address8) override;
+  bool get_family_codes(std::vector<uint8_t> &families) override;
   void setup() override;
   void update() override;
   void dump_config() override;
@@ -31,7 +32,7 @@ class DS2438Component : public PollingComponent, public DallasDevice {
   float shunt_resistance_;
   uint8_t threshold_;
 
-  void read_volt(bool vcc);
+  bool read_volt(bool vcc);
 
   bool read_mem(uint8_t page, uint8_t *buffer);
   bool write_mem(uint8_t page, uint8_t *buffer);
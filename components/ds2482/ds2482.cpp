@@ -0,0 +1,225 @@
+#include "ds2482.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace dallas {
+
+static const char *const TAG = "dallas.ds2482";
+
+static const uint8_t DS2482_DEVICE_RESET = 0xF0;
+static const uint8_t DS2482_SET_READ_POINTER = 0xE1;
+static const uint8_t DS2482_WRITE_CONFIG = 0xD2;
+static const uint8_t DS2482_CHANNEL_SELECT = 0xC3;
+static const uint8_t DS2482_ONE_WIRE_RESET = 0xB4;
+static const uint8_t DS2482_ONE_WIRE_SINGLE_BIT = 0x87;
+static const uint8_t DS2482_ONE_WIRE_WRITE_BYTE = 0xA5;
+static const uint8_t DS2482_ONE_WIRE_READ_BYTE = 0x96;
+static const uint8_t DS2482_ONE_WIRE_TRIPLET = 0x78;
+
+static const uint8_t DS2482_REGISTER_DATA = 0xE1;
+
+static const uint8_t DS2482_STATUS_BUSY = 0x01;
+static const uint8_t DS2482_STATUS_PRESENCE = 0x02;
+static const uint8_t DS2482_STATUS_SHORT = 0x04;
+static const uint8_t DS2482_STATUS_RESET = 0x10;
+static const uint8_t DS2482_STATUS_SINGLE_BIT = 0x20;
+// the triplet result bits line up with the ones tribit() returns
+static const uint8_t DS2482_STATUS_TRIPLET = 0xE0;
+
+static const uint8_t DS2482_CONFIG_ACTIVE_PULLUP = 0x01;
+static const uint8_t DS2482_CONFIG_OVERDRIVE = 0x08;
+
+// channel select codes and what the channel register reads back
+static const uint8_t DS2482_CHANNEL_CODES[8] = {0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87};
+static const uint8_t DS2482_CHANNEL_READBACK[8] = {0xB8, 0xB1, 0xAA, 0xA3, 0x9C, 0x95, 0x8E, 0x87};
+
+// a standard speed reset takes 1.2ms, the rest is less
+static const uint32_t DS2482_TIMEOUT_US = 5000;
+
+void DS2482Component::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up DS2482...");
+  uint8_t status;
+  if (!this->write_command_(DS2482_DEVICE_RESET) || this->read(&status, 1) != i2c::ERROR_OK ||
+      !(status & DS2482_STATUS_RESET)) {
+    ESP_LOGE(TAG, "DS2482 not found");
+    this->mark_failed();
+    return;
+  }
+  this->channel_ = 0;
+  this->config_ = 0;
+  if (!this->write_config_(this->active_pullup_ ? DS2482_CONFIG_ACTIVE_PULLUP : 0)) {
+    this->mark_failed();
+    return;
+  }
+  this->ok_ = true;
+}
+
+void DS2482Component::dump_config() {
+  ESP_LOGCONFIG(TAG, "DS2482:");
+  LOG_I2C_DEVICE(this);
+  if (this->is_failed()) {
+    ESP_LOGE(TAG, "  Communication failed");
+    return;
+  }
+  ESP_LOGCONFIG(TAG, "  Active pullup: %s", YESNO(this->active_pullup_));
+  for (uint8_t i = 0; i < 8; i++) {
+    if (this->channels_[i] != nullptr)
+      ESP_LOGCONFIG(TAG, "  Channel %u", i);
+  }
+  if (this->i2c_errors_ != 0)
+    ESP_LOGCONFIG(TAG, "  I2C errors: %u", this->i2c_errors_);
+}
+
+DS2482Channel *DS2482Component::get_channel(uint8_t channel) {
+  if (channel >= 8)
+    return nullptr;
+  if (this->channels_[channel] == nullptr)
+    this->channels_[channel] = new DS2482Channel(this, channel);  // NOLINT(cppcoreguidelines-owning-memory)
+  if (channel != 0)
+    this->multi_channel_ = true;
+  return this->channels_[channel];
+}
+
+bool DS2482Component::write_command_(uint8_t cmd, const uint8_t *param) {
+  uint8_t data[2] = {cmd, param != nullptr ? *param : uint8_t(0)};
+  if (this->write(data, param != nullptr ? 2 : 1) == i2c::ERROR_OK)
+    return true;
+  this->i2c_errors_++;
+  ESP_LOGW(TAG, "Command %02x failed", cmd);
+  return false;
+}
+
+bool DS2482Component::wait_idle_(uint8_t *status) {
+  // the read pointer is on the status register after a 1-Wire command
+  uint32_t start = micros();
+  do {
+    if (this->read(status, 1) != i2c::ERROR_OK) {
+      this->i2c_errors_++;
+      return false;
+    }
+    if (!(*status & DS2482_STATUS_BUSY))
+      return true;
+  } while (micros() - start < DS2482_TIMEOUT_US);
+  ESP_LOGW(TAG, "1-Wire command timed out");
+  return false;
+}
+
+bool DS2482Component::read_register_(uint8_t reg, uint8_t *value) {
+  if (!this->write_command_(DS2482_SET_READ_POINTER, &reg))
+    return false;
+  if (this->read(value, 1) == i2c::ERROR_OK)
+    return true;
+  this->i2c_errors_++;
+  return false;
+}
+
+bool DS2482Component::write_config_(uint8_t config) {
+  // the upper nibble is the complement of the lower one
+  uint8_t param = config | (~config << 4);
+  uint8_t readback;
+  if (!this->write_command_(DS2482_WRITE_CONFIG, &param) || this->read(&readback, 1) != i2c::ERROR_OK ||
+      readback != config) {
+    ESP_LOGW(TAG, "Writing configuration %02x failed", config);
+    return false;
+  }
+  this->config_ = config;
+  return true;
+}
+
+bool DS2482Component::prepare_(uint8_t channel, bool overdrive) {
+  if (!this->ok_)
+    return false;
+  if (this->multi_channel_ && channel != this->channel_) {
+    uint8_t readback;
+    if (!this->write_command_(DS2482_CHANNEL_SELECT, &DS2482_CHANNEL_CODES[channel]) ||
+        this->read(&readback, 1) != i2c::ERROR_OK || readback != DS2482_CHANNEL_READBACK[channel]) {
+      ESP_LOGW(TAG, "Selecting channel %u failed", channel);
+      return false;
+    }
+    this->channel_ = channel;
+  }
+  uint8_t config = this->config_ & ~DS2482_CONFIG_OVERDRIVE;
+  if (overdrive)
+    config |= DS2482_CONFIG_OVERDRIVE;
+  if (config != this->config_)
+    return this->write_config_(config);
+  return true;
+}
+
+bool DS2482Channel::command_(uint8_t cmd, const uint8_t *param, uint8_t *status) {
+  return this->parent_->prepare_(this->channel_, this->overdrive_) && this->parent_->write_command_(cmd, param) &&
+         this->parent_->wait_idle_(status);
+}
+
+void DS2482Channel::account_(uint32_t start, uint8_t slots) {
+  this->stats_.slots += slots;
+  this->stats_.bus_us += micros() - start;
+}
+
+bool DS2482Channel::reset_(bool overdrive) {
+  // the bridge takes the speed from overdrive_, which reset() and reset_overdrive() set to overdrive
+  uint32_t start = micros();
+  this->stats_.resets++;
+  uint8_t status;
+  bool r = this->command_(DS2482_ONE_WIRE_RESET, nullptr, &status) && (status & DS2482_STATUS_PRESENCE);
+  if (r && (status & DS2482_STATUS_SHORT)) {
+    ESP_LOGW(TAG, "Short detected on channel %u", this->channel_);
+    r = false;
+  }
+  if (!r)
+    this->stats_.presence_failures++;
+  this->stats_.bus_us += micros() - start;
+  ONE_WIRE_RECORD(this, reset, micros() - start);
+  return r;
+}
+
+bool DS2482Channel::bit_(bool bit) {
+  uint32_t start = micros();
+  uint8_t param = bit ? 0x80 : 0x00;
+  uint8_t status;
+  // a failed transfer reads as an idle bus
+  bool r = !this->command_(DS2482_ONE_WIRE_SINGLE_BIT, &param, &status) || (status & DS2482_STATUS_SINGLE_BIT);
+  this->account_(start, 1);
+  return r;
+}
+
+void DS2482Channel::write_bit(bool bit) { this->bit_(bit); }
+
+bool DS2482Channel::read_bit() { return this->bit_(true); }
+
+void DS2482Channel::write8(uint8_t val) {
+  uint32_t start = micros();
+  uint8_t status;
+  this->command_(DS2482_ONE_WIRE_WRITE_BYTE, &val, &status);
+  this->account_(start, 8);
+}
+
+uint8_t DS2482Channel::read8() {
+  uint32_t start = micros();
+  uint8_t status;
+  uint8_t val = 0xFF;
+  if (this->command_(DS2482_ONE_WIRE_READ_BYTE, nullptr, &status) &&
+      !this->parent_->read_register_(DS2482_REGISTER_DATA, &val))
+    val = 0xFF;
+  this->account_(start, 8);
+  return val;
+}
+
+uint8_t DS2482Channel::tribit(bool dir) {
+  uint32_t start = micros();
+  uint8_t param = dir ? 0x80 : 0x00;
+  uint8_t status;
+  // both bits set ends the search, like an empty bus
+  uint8_t r = DS2482_STATUS_TRIPLET;
+  if (this->command_(DS2482_ONE_WIRE_TRIPLET, &param, &status))
+    r = status & DS2482_STATUS_TRIPLET;
+  this->account_(start, 3);
+  return r;
+}
+
+std::string DS2482Channel::dump_summary() const {
+  return str_sprintf("DS2482 0x%02X channel %u", this->parent_->get_i2c_address(), this->channel_);
+}
+
+}  // namespace dallas
+}  // namespace esphome
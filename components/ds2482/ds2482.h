@@ -0,0 +1,74 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/i2c/i2c.h"
+#include "../dallas/esp_one_wire.h"
+
+namespace esphome {
+namespace dallas {
+
+class DS2482Component;
+
+/// One 1-Wire channel of a DS2482, the bridge does the time slots.
+class DS2482Channel : public ESPOneWire {
+ public:
+  DS2482Channel(DS2482Component *parent, uint8_t channel) : parent_(parent), channel_(channel) {}
+
+  void write_bit(bool bit) override;
+  bool read_bit() override;
+  void write8(uint8_t val) override;
+  uint8_t read8() override;
+  /// Uses the 1-Wire Triplet command, a search costs one command per ROM bit.
+  uint8_t tribit(bool dir) override;
+  std::string dump_summary() const override;
+
+ protected:
+  bool reset_(bool overdrive) override;
+  /// Single bit command, returns the bit sampled in the slot.
+  bool bit_(bool bit);
+  /// Select this channel and the bus speed, then send a 1-Wire command and wait for it.
+  bool command_(uint8_t cmd, const uint8_t *param, uint8_t *status);
+  void account_(uint32_t start, uint8_t slots);
+
+  DS2482Component *parent_;
+  uint8_t channel_;
+};
+
+/** DS2482-100 and DS2482-800 I2C to 1-Wire bridge.
+ *
+ * Each channel is a bus for a dallas hub, the -800 has 8 of them.
+ */
+class DS2482Component : public Component, public i2c::I2CDevice {
+ public:
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::BUS; }
+
+  void set_active_pullup(bool active_pullup) { this->active_pullup_ = active_pullup; }
+  /// Bus for a channel, created on first use.
+  DS2482Channel *get_channel(uint8_t channel);
+
+ protected:
+  friend class DS2482Channel;
+
+  /// Send a bridge command with an optional parameter byte.
+  bool write_command_(uint8_t cmd, const uint8_t *param = nullptr);
+  /// Poll the status register until the 1-Wire command finished.
+  bool wait_idle_(uint8_t *status);
+  bool read_register_(uint8_t reg, uint8_t *value);
+  /// Switch to a channel and bus speed unless already there.
+  bool prepare_(uint8_t channel, bool overdrive);
+  bool write_config_(uint8_t config);
+
+  DS2482Channel *channels_[8]{};
+  bool active_pullup_{true};
+  /// Only the -800 has the channel select command.
+  bool multi_channel_{false};
+  uint8_t channel_{0};
+  uint8_t config_{0};
+  bool ok_{false};
+  uint32_t i2c_errors_{0};
+};
+
+}  // namespace dallas
+}  // namespace esphome
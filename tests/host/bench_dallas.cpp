@@ -0,0 +1,218 @@
+// Bus cost of the discovery, the update cycle, the alert poll and the driver hot calls on a
+// simulated bus, as JSON lines:
+//   {"case":"discovery/50","op":"discovery","n":50,"resets":..,"slots":..,"locked_us":..,"bus_us":..,"wall_us":..}
+// The numbers come from the benchmark logging of the real code and are in virtual time, so they
+// are the same on every run and a change between two builds is a change in the bus work. Every
+// case logs its setup too, e.g. the discovery, pick the lines by "op".
+//
+//   bench_dallas [max devices]
+
+#include "../../components/ds1820/ds1820.h"
+#include "../../components/ds2408/ds2408.h"
+#include "../../components/ds2409/ds2409.h"
+#include "../../components/ds2423/ds2423.h"
+#include "../../components/ds2438/ds2438.h"
+#include "esphome/core/log.h"
+#include "sim_hub.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static std::string bench_case;
+static uint32_t bench_lines = 0;
+static int bench_failures = 0;
+
+static void on_log(const char *tag, const char *message) {
+  if (std::strncmp(message, "bench {", 7) != 0)
+    return;
+  std::printf("{\"case\":\"%s\",%s\n", bench_case.c_str(), message + 7);
+  bench_lines++;
+}
+
+/// Run until done, counting a failure if it doesn't get there.
+static void run_until(const char *what, const std::function<bool()> &done, uint32_t max_ms) {
+  if (!host_app.run_until(done, max_ms)) {
+    std::fprintf(stderr, "%s: %s timed out\n", bench_case.c_str(), what);
+    bench_failures++;
+  }
+}
+
+/// A hub with count DS18B20 on its bus, set up and discovered.
+struct TemperatureBus {
+  explicit TemperatureBus(size_t count) {
+    this->sim.hub.set_benchmark(true);
+    this->sim.hub.set_update_interval(SCHEDULER_DONT_RUN);
+    for (size_t i = 0; i < count; i++) {
+      uint64_t rom = sim_rom(0x28, 0x100000 + i * 7919);
+      this->devices.emplace_back(rom);
+      this->sim.bus.add_device(&this->devices.back());
+      this->sensors.emplace_back();
+      this->sensors.back().set_resolution(12);
+      this->sim.add(&this->sensors.back(), rom);
+    }
+  }
+
+  void setup() {
+    host_app.setup();
+    run_until("discovery", [this]() { return this->sim.hub.is_discovery_done(); }, 60000);
+  }
+
+  /// Run the conversion and read cycle of update().
+  void update() {
+    uint32_t published = 0;
+    for (auto &sensor : this->sensors)
+      published += sensor.publish_count;
+    this->sim.hub.update();
+    run_until("update", [this, published]() {
+      uint32_t now = 0;
+      for (auto &sensor : this->sensors)
+        now += sensor.publish_count;
+      return now >= published + this->sensors.size();
+    }, 60000);
+  }
+
+  SimHub sim;
+  std::deque<SimDS18B20> devices;
+  std::deque<DallasTemperatureSensor> sensors;
+};
+
+static void bench_discovery(size_t count) {
+  bench_case = "discovery/" + std::to_string(count);
+  TemperatureBus bus(count);
+  bus.setup();
+}
+
+static void bench_update(size_t count) {
+  bench_case = "update/" + std::to_string(count);
+  TemperatureBus bus(count);
+  bus.setup();
+  bus.update();
+}
+
+static void bench_update_alert(size_t count, size_t alerting) {
+  bench_case = "update_alert/" + std::to_string(count) + "/" + std::to_string(alerting);
+  TemperatureBus bus(count);
+  for (size_t i = 0; i < count; i++) {
+    bus.devices[i].set_alarms(75, -10);
+    bus.devices[i].temperature = i < alerting ? 80.0f : 20.0f;
+  }
+  bus.setup();
+  bus.update();
+  bus.sim.hub.update_alert();
+  host_app.run_for(100);
+}
+
+static void bench_ds2423() {
+  bench_case = "ds2423.read_counter";
+  SimHub sim;
+  sim.hub.set_benchmark(true);
+  SimDS2423 device(sim_rom(0x1D, 0xABCD));
+  sim.bus.add_device(&device);
+  DallasCounterComponent counter;
+  counter.set_update_interval(SCHEDULER_DONT_RUN);
+  sensor::Sensor counter_a;
+  counter.set_counter_a_sensor(&counter_a);
+  sim.add(&counter, device.get_rom());
+  host_app.register_component(&counter);
+  host_app.setup();
+  run_until("discovery", [&]() { return counter.is_attached(); }, 1000);
+
+  counter.update();
+  run_until("read", [&]() { return counter_a.publish_count > 0; }, 1000);
+}
+
+static void bench_ds2438() {
+  bench_case = "ds2438.read_volt";
+  SimHub sim;
+  sim.hub.set_benchmark(true);
+  SimDS2438 device(sim_rom(0x26, 0x765432));
+  sim.bus.add_device(&device);
+  DS2438Component battery;
+  battery.set_update_interval(SCHEDULER_DONT_RUN);
+  sensor::Sensor vcc, vad;
+  battery.set_vcc_sensor(&vcc);
+  battery.set_vad_sensor(&vad);
+  sim.add(&battery, device.get_rom());
+  host_app.register_component(&battery);
+  host_app.setup();
+  run_until("discovery", [&]() { return battery.is_attached(); }, 1000);
+
+  battery.update();
+  run_until("read", [&]() { return vcc.publish_count > 0 && vad.publish_count > 0; }, 1000);
+}
+
+static void bench_ds2408() {
+  bench_case = "ds2408.write_channel";
+  SimHub sim;
+  sim.hub.set_benchmark(true);
+  SimDS2408 device(sim_rom(0x29, 0x1234AB));
+  sim.bus.add_device(&device);
+  DS2408Component gpio;
+  gpio.set_update_interval(SCHEDULER_DONT_RUN);
+  sim.add(&gpio, device.get_rom());
+  host_app.register_component(&gpio);
+  DS2408GPIOPin out;
+  out.set_parent(&gpio);
+  out.set_pin(0);
+  out.set_inverted(false);
+  out.set_flags(gpio::FLAG_OUTPUT);
+  host_app.setup();
+  out.setup();
+  run_until("discovery", [&]() { return gpio.is_attached(); }, 1000);
+
+  out.digital_write(false);
+  run_until("write", [&]() { return device.latch == 0xFE; }, 1000);
+}
+
+static void bench_ds2409() {
+  bench_case = "ds2409.smart_on";
+  SimHub sim;
+  sim.hub.set_benchmark(true);
+  SimDS2409 coupler(sim_rom(0x1F, 0xAB09));
+  SimDS18B20 device(sim_rom(0x28, 0xA1B2C3E));
+  sim.bus.add_device(&coupler);
+  sim.bus.add_device(&device);
+  coupler.add_aux(&device);
+  DS2409Component branch;
+  branch.set_update_interval(SCHEDULER_DONT_RUN);
+  sim.add(&branch, coupler.get_rom());
+  host_app.register_component(&branch);
+  DallasTemperatureSensor sensor;
+  sensor.set_resolution(12);
+  sensor.set_address(device.get_rom());
+  sensor.set_parent(branch.get_network(false));
+  branch.get_network(false)->register_sensor(&sensor);
+  host_app.setup();
+  run_until("discovery", [&]() { return sensor.is_attached() && !coupler.aux_on(); }, 5000);
+
+  branch.update();
+  run_until("read", [&]() { return sensor.publish_count > 0; }, 5000);
+}
+
+int main(int argc, char **argv) {
+  size_t max_devices = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  host_log_listener = on_log;
+  for (size_t count : {1, 10, 50, 200}) {
+    if (count <= max_devices)
+      bench_discovery(count);
+  }
+  for (size_t count : {1, 10, 50}) {
+    if (count <= max_devices)
+      bench_update(count);
+  }
+  for (size_t alerting : {0, 1, 5})
+    bench_update_alert(10, alerting);
+  bench_ds2423();
+  bench_ds2438();
+  bench_ds2408();
+  bench_ds2409();
+  if (bench_lines == 0)
+    bench_failures++;
+  return bench_failures;
+}
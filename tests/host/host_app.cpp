@@ -0,0 +1,118 @@
+#include "esphome/core/component.h"
+
+#include <algorithm>
+
+namespace esphome {
+
+namespace setup_priority {
+const float BUS = 1000.0f;
+const float IO = 900.0f;
+const float HARDWARE = 800.0f;
+const float DATA = 600.0f;
+const float PROCESSOR = 400.0f;
+const float LATE = -100.0f;
+}  // namespace setup_priority
+
+HostApplication host_app;
+
+void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {
+  host_app.cancel_timer(this, name, true);
+  if (interval != SCHEDULER_DONT_RUN)
+    host_app.set_timer(this, name, interval, true, std::move(f));
+}
+bool Component::cancel_interval(const std::string &name) { return host_app.cancel_timer(this, name, true); }
+void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {
+  host_app.cancel_timer(this, name, false);
+  if (timeout != SCHEDULER_DONT_RUN)
+    host_app.set_timer(this, name, timeout, false, std::move(f));
+}
+void Component::set_timeout(uint32_t timeout, std::function<void()> &&f) {
+  host_app.set_timer(this, "", timeout, false, std::move(f));
+}
+bool Component::cancel_timeout(const std::string &name) { return host_app.cancel_timer(this, name, false); }
+
+void HostApplication::setup() {
+  std::stable_sort(this->components_.begin(), this->components_.end(), [](Component *a, Component *b) {
+    return a->get_setup_priority() > b->get_setup_priority();
+  });
+  for (auto *component : this->components_)
+    component->call_setup();
+}
+
+void HostApplication::set_timer(Component *component, const std::string &name, uint32_t ms, bool repeat,
+                                std::function<void()> &&f) {
+  this->timers_.push_back({component, name, this->now_us_() + uint64_t(ms) * 1000, ms, repeat, false, std::move(f)});
+}
+
+bool HostApplication::cancel_timer(Component *component, const std::string &name, bool repeat) {
+  if (name.empty())
+    return false;
+  bool found = false;
+  for (auto &timer : this->timers_) {
+    if (!timer.removed && timer.component == component && timer.repeat == repeat && timer.name == name) {
+      timer.removed = true;
+      found = true;
+    }
+  }
+  return found;
+}
+
+void HostApplication::loop() {
+  // due timers in order, a timer may add or cancel others
+  while (true) {
+    uint64_t now = this->now_us_();
+    Timer *next = nullptr;
+    for (auto &timer : this->timers_) {
+      if (!timer.removed && timer.due_us <= now && (next == nullptr || timer.due_us < next->due_us))
+        next = &timer;
+    }
+    if (next == nullptr)
+      break;
+    std::function<void()> f;
+    if (next->repeat) {
+      next->due_us = now + std::max<uint64_t>(uint64_t(next->interval_ms) * 1000, 1);
+      f = next->f;
+    } else {
+      next->removed = true;
+      f = std::move(next->f);
+    }
+    f();
+  }
+  this->timers_.erase(std::remove_if(this->timers_.begin(), this->timers_.end(), [](const Timer &t) { return t.removed; }),
+                      this->timers_.end());
+
+  for (auto *component : this->components_)
+    component->call_loop();
+
+  if (HighFrequencyLoopRequester::is_high_frequency()) {
+    delayMicroseconds(this->loop_overhead_us);
+    return;
+  }
+  uint64_t wake = this->now_us_() + uint64_t(this->loop_interval_ms) * 1000;
+  for (auto &timer : this->timers_)
+    wake = std::min(wake, std::max(timer.due_us, this->now_us_()));
+  host_advance_ns((wake - this->now_us_()) * 1000 + this->loop_overhead_us * 1000);
+}
+
+void HostApplication::run_for(uint32_t ms) {
+  uint64_t end = this->now_us_() + uint64_t(ms) * 1000;
+  while (this->now_us_() < end)
+    this->loop();
+}
+
+bool HostApplication::run_until(const std::function<bool()> &done, uint32_t max_ms) {
+  uint64_t end = this->now_us_() + uint64_t(max_ms) * 1000;
+  while (!done()) {
+    if (this->now_us_() >= end)
+      return false;
+    this->loop();
+  }
+  return true;
+}
+
+void HostApplication::clear() {
+  this->components_.clear();
+  this->timers_.clear();
+}
+
+}  // namespace esphome
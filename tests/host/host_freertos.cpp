@@ -0,0 +1,70 @@
+#include <freertos/task.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct HostTask {
+  std::mutex mutex;
+  std::condition_variable notified;
+  uint32_t notifications{0};
+};
+
+namespace {
+
+/// Handle of the task running on this thread, the main thread has one too.
+thread_local HostTask *current_task = nullptr;
+bool fail_next_create = false;
+
+}  // namespace
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_size, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+  if (fail_next_create) {
+    fail_next_create = false;
+    return pdFAIL;
+  }
+  // tasks never end, their handle stays valid like the one of a task that is never deleted
+  auto *task = new HostTask();
+  *handle = task;
+  std::thread([function, arg, task]() {
+    current_task = task;
+    function(arg);
+  }).detach();
+  return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  if (current_task == nullptr)
+    current_task = new HostTask();
+  return current_task;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+  std::lock_guard<std::mutex> lock(task->mutex);
+  task->notifications++;
+  task->notified.notify_one();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+  HostTask *task = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(task->mutex);
+  auto has_notification = [task]() { return task->notifications != 0; };
+  if (ticks_to_wait == portMAX_DELAY) {
+    task->notified.wait(lock, has_notification);
+  } else {
+    task->notified.wait_for(lock, std::chrono::milliseconds(ticks_to_wait), has_notification);
+  }
+  uint32_t count = task->notifications;
+  if (clear_on_exit) {
+    task->notifications = 0;
+  } else if (count != 0) {
+    task->notifications--;
+  }
+  return count;
+}
+
+void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+
+void host_task_fail_next_create() { fail_next_create = true; }
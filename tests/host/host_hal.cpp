@@ -0,0 +1,108 @@
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
+
+#include <cctype>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+namespace esphome {
+
+static uint64_t host_ns = 0;
+static uint32_t host_micros_cost_ns = 250;
+static HostPinListener *host_pins[64] = {};
+static int high_frequency_requests = 0;
+
+bool host_log_enabled = std::getenv("HOST_LOG") != nullptr;
+void (*host_log_listener)(const char *tag, const char *message) = nullptr;
+
+static ESPPreferences host_preferences;
+ESPPreferences *global_preferences = &host_preferences;
+
+uint64_t host_now_ns() { return host_ns; }
+void host_advance_ns(uint64_t ns) { host_ns += ns; }
+void host_set_micros_cost_ns(uint32_t ns) { host_micros_cost_ns = ns; }
+
+uint32_t micros() {
+  uint32_t now = host_ns / 1000;
+  host_ns += host_micros_cost_ns;
+  return now;
+}
+uint32_t millis() { return host_ns / 1000000; }
+void delayMicroseconds(uint32_t us) { host_ns += uint64_t(us) * 1000; }
+void delay(uint32_t ms) { host_ns += uint64_t(ms) * 1000000; }
+void yield() {}
+
+void host_attach_pin(uint8_t pin, HostPinListener *listener) { host_pins[pin % 64] = listener; }
+
+void ISRInternalGPIOPin::pin_mode(gpio::Flags flags) {
+  if (auto *listener = host_pins[this->pin_ % 64])
+    listener->pin_mode(flags);
+}
+bool ISRInternalGPIOPin::digital_read() {
+  auto *listener = host_pins[this->pin_ % 64];
+  return listener == nullptr || listener->digital_read();
+}
+void ISRInternalGPIOPin::digital_write(bool value) {
+  if (auto *listener = host_pins[this->pin_ % 64])
+    listener->digital_write(value);
+}
+std::string HostGPIOPin::dump_summary() const { return str_sprintf("GPIO%u", this->pin_); }
+
+void HighFrequencyLoopRequester::start() {
+  if (!this->started_)
+    high_frequency_requests++;
+  this->started_ = true;
+}
+void HighFrequencyLoopRequester::stop() {
+  if (this->started_)
+    high_frequency_requests--;
+  this->started_ = false;
+}
+bool HighFrequencyLoopRequester::is_high_frequency() { return high_frequency_requests > 0; }
+
+uint8_t crc8(uint8_t *data, uint8_t len) {
+  uint8_t crc = 0;
+  while ((len--) != 0u) {
+    uint8_t inbyte = *data++;
+    for (uint8_t i = 8; i != 0u; i--) {
+      bool mix = (crc ^ inbyte) & 0x01;
+      crc >>= 1;
+      if (mix)
+        crc ^= 0x8C;
+      inbyte >>= 1;
+    }
+  }
+  return crc;
+}
+
+std::string str_sprintf(const char *fmt, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(buffer, sizeof(buffer), fmt, args);
+  va_end(args);
+  return buffer;
+}
+
+std::string format_hex(uint64_t value) { return str_sprintf("%016llx", (unsigned long long) value); }
+
+std::string str_lower_case(const std::string &str) {
+  std::string res = str;
+  for (auto &c : res)
+    c = std::tolower(c);
+  return res;
+}
+
+uint32_t fnv1_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+  for (char c : str) {
+    hash *= 16777619UL;
+    hash ^= c;
+  }
+  return hash;
+}
+
+}  // namespace esphome
@@ -0,0 +1,208 @@
+#include <driver/rmt.h>
+#include "esphome/core/hal.h"
+
+#include <deque>
+#include <utility>
+
+using esphome::host_advance_ns;
+using esphome::host_now_ns;
+
+namespace {
+
+// a frame that doesn't end within this long is dropped, like a receiver stuck in a held low bus
+const uint32_t MAX_FRAME_US = 20000;
+const uint32_t MAX_DURATION = 0x7FFF;
+
+struct Channel {
+  rmt_config_t config{};
+  bool installed{false};
+  bool receiving{false};
+  std::deque<std::vector<rmt_item32_t>> frames;
+  /// The frame handed out by xRingbufferReceive(), until it is returned.
+  std::vector<rmt_item32_t> out;
+  std::vector<rmt_item32_t> capture;
+  bool has_capture{false};
+};
+
+Channel channels[RMT_CHANNEL_MAX];
+
+/// Level runs a receiver saw, from the first low on.
+struct Recording {
+  Channel *channel;
+  std::vector<std::pair<bool, uint32_t>> runs;
+  bool done{false};
+
+  void add(bool level) {
+    if (this->done)
+      return;
+    if (this->runs.empty()) {
+      if (!level)
+        this->runs.push_back({false, 1});
+      return;
+    }
+    auto &last = this->runs.back();
+    if (last.first != level) {
+      this->runs.push_back({level, 1});
+      return;
+    }
+    last.second++;
+    if (last.second >= this->channel->config.rx_config.idle_threshold)
+      this->done = true;
+  }
+
+  std::vector<rmt_item32_t> items() const {
+    // the filter drops pulses shorter than its threshold, in APB clock cycles
+    uint32_t filter_us = this->channel->config.rx_config.filter_en
+                             ? (this->channel->config.rx_config.filter_ticks_thresh + 79) / 80
+                             : 0;
+    std::vector<std::pair<bool, uint32_t>> runs;
+    for (auto &run : this->runs) {
+      if (!runs.empty() && (run.second < filter_us || runs.back().first == run.first)) {
+        runs.back().second += run.second;
+        continue;
+      }
+      runs.push_back(run);
+    }
+    // the idle level at the end is stored with a zero duration
+    runs.back().second = 0;
+    if (runs.size() % 2 != 0)
+      runs.push_back({true, 0});
+    std::vector<rmt_item32_t> items(runs.size() / 2);
+    for (size_t i = 0; i < items.size(); i++) {
+      items[i].level0 = runs[i * 2].first;
+      items[i].duration0 = std::min(runs[i * 2].second, MAX_DURATION);
+      items[i].level1 = runs[i * 2 + 1].first;
+      items[i].duration1 = std::min(runs[i * 2 + 1].second, MAX_DURATION);
+    }
+    return items;
+  }
+};
+
+}  // namespace
+
+esp_err_t rmt_config(const rmt_config_t *config) {
+  if (config->channel >= RMT_CHANNEL_MAX)
+    return ESP_FAIL;
+  channels[config->channel].config = *config;
+  return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags) {
+  if (channel >= RMT_CHANNEL_MAX || channels[channel].installed)
+    return ESP_FAIL;
+  channels[channel].installed = true;
+  return ESP_OK;
+}
+
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel) {
+  channels[channel] = Channel();
+  return ESP_OK;
+}
+
+esp_err_t rmt_get_ringbuf_handle(rmt_channel_t channel, RingbufHandle_t *buf_handle) {
+  if (!channels[channel].installed || channels[channel].config.rmt_mode != RMT_MODE_RX)
+    return ESP_FAIL;
+  *buf_handle = &channels[channel];
+  return ESP_OK;
+}
+
+esp_err_t rmt_set_rx_idle_thresh(rmt_channel_t channel, uint16_t thresh) {
+  channels[channel].config.rx_config.idle_threshold = thresh;
+  return ESP_OK;
+}
+
+esp_err_t rmt_rx_start(rmt_channel_t channel, bool rx_idx_rst) {
+  channels[channel].receiving = true;
+  if (rx_idx_rst)
+    channels[channel].frames.clear();
+  return ESP_OK;
+}
+
+esp_err_t rmt_rx_stop(rmt_channel_t channel) {
+  channels[channel].receiving = false;
+  return ESP_OK;
+}
+
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t *rmt_item, int item_num, bool wait_tx_done) {
+  auto &tx = channels[channel];
+  if (!tx.installed || tx.config.rmt_mode != RMT_MODE_TX)
+    return ESP_FAIL;
+
+  // levels to send, a zero duration ends the items early
+  std::vector<std::pair<bool, uint32_t>> runs;
+  uint32_t total = 0;
+  for (int i = 0; i < item_num; i++) {
+    if (rmt_item[i].duration0 == 0)
+      break;
+    runs.push_back({rmt_item[i].level0, rmt_item[i].duration0});
+    total += rmt_item[i].duration0;
+    if (rmt_item[i].duration1 == 0)
+      break;
+    runs.push_back({rmt_item[i].level1, rmt_item[i].duration1});
+    total += rmt_item[i].duration1;
+  }
+
+  std::vector<Recording> recordings;
+  for (auto &rx : channels) {
+    if (rx.installed && rx.receiving && rx.config.rmt_mode == RMT_MODE_RX && rx.config.gpio_num == tx.config.gpio_num)
+      recordings.push_back({&rx});
+  }
+
+  // open drain: the output pulls low or lets go, the pull-up and the devices decide the rest
+  esphome::ISRInternalGPIOPin pin(tx.config.gpio_num);
+  pin.digital_write(false);
+  bool pulling = false;
+  size_t run = 0;
+  uint32_t run_end = runs.empty() ? 0 : runs[0].second;
+  uint64_t start = host_now_ns();
+  for (uint32_t us = 0; us < total + MAX_FRAME_US; us++) {
+    uint64_t at = start + uint64_t(us) * 1000;
+    if (host_now_ns() < at)
+      host_advance_ns(at - host_now_ns());
+    while (run < runs.size() && us >= run_end && ++run < runs.size())
+      run_end += runs[run].second;
+    bool pull = run < runs.size() ? !runs[run].first : tx.config.tx_config.idle_level == RMT_IDLE_LEVEL_LOW;
+    if (pull != pulling) {
+      pin.pin_mode(pull ? esphome::gpio::FLAG_OUTPUT : esphome::gpio::FLAG_INPUT);
+      pulling = pull;
+    }
+    bool level = pin.digital_read();
+    bool done = true;
+    for (auto &recording : recordings) {
+      recording.add(level);
+      done = done && recording.done;
+    }
+    if (us >= total && done)
+      break;
+  }
+
+  for (auto &recording : recordings) {
+    auto &rx = *recording.channel;
+    if (rx.has_capture) {
+      rx.frames.push_back(rx.capture);
+      rx.has_capture = false;
+    } else if (recording.done) {
+      rx.frames.push_back(recording.items());
+    }
+  }
+  return ESP_OK;
+}
+
+void *xRingbufferReceive(RingbufHandle_t buffer, size_t *item_size, TickType_t ticks_to_wait) {
+  auto *rx = static_cast<Channel *>(buffer);
+  if (rx->frames.empty()) {
+    host_advance_ns(uint64_t(ticks_to_wait) * 1000000);
+    return nullptr;
+  }
+  rx->out = std::move(rx->frames.front());
+  rx->frames.pop_front();
+  *item_size = rx->out.size() * sizeof(rmt_item32_t);
+  return rx->out.data();
+}
+
+void vRingbufferReturnItem(RingbufHandle_t buffer, void *item) { static_cast<Channel *>(buffer)->out.clear(); }
+
+void host_rmt_set_capture(rmt_channel_t channel, const std::vector<rmt_item32_t> &items) {
+  channels[channel].capture = items;
+  channels[channel].has_capture = true;
+}
@@ -0,0 +1,354 @@
+#include "sim_bus.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace dallas {
+
+static const uint8_t ROM_READ = 0x33;
+static const uint8_t ROM_MATCH = 0x55;
+static const uint8_t ROM_SKIP = 0xCC;
+static const uint8_t ROM_SEARCH = 0xF0;
+static const uint8_t ROM_ALARM_SEARCH = 0xEC;
+static const uint8_t ROM_RESUME = 0xA5;
+static const uint8_t ROM_OVERDRIVE_SKIP = 0x3C;
+static const uint8_t ROM_OVERDRIVE_MATCH = 0x69;
+
+/// How a slave times the bus, in ns. Values are typical ones from the DS18B20 and DS2408 datasheets.
+struct SimSpeed {
+  /// A low at least this long is a reset.
+  uint64_t reset_min;
+  uint64_t presence_wait;
+  uint64_t presence_low;
+  /// Write slots are sampled this long after the falling edge.
+  uint64_t sample;
+  /// A 0 is answered by holding the line this long.
+  uint64_t hold;
+};
+static const SimSpeed SIM_STANDARD = {400000, 30000, 120000, 30000, 30000};
+static const SimSpeed SIM_OVERDRIVE = {48000, 3000, 10000, 3000, 4000};
+
+void SimDevice::set_connected(bool connected) {
+  this->connected_ = connected;
+  // a slot in progress is cut off
+  this->sample_at_ = 0;
+  this->slot_tx_ = -1;
+  this->hold_until_ = 0;
+}
+
+void SimDevice::branch_reset() {
+  this->overdrive_ = false;
+  this->reset_(host_now_ns(), false);
+}
+
+void SimDevice::fall_(uint64_t t) {
+  this->event_ns_ = t;
+  if (this->sample_at_ != 0) {
+    // still in the last slot, the master started this one too early
+    this->missed_slots++;
+    return;
+  }
+  if (this->state_ == STATE_IDLE)
+    return;
+  auto &speed = this->overdrive_ ? SIM_OVERDRIVE : SIM_STANDARD;
+  this->slot_tx_ = this->tx_bit_();
+  if (this->slot_tx_ == 0) {
+    this->hold_from_ = t;
+    this->hold_until_ = t + speed.hold;
+  }
+  this->sample_at_ = t + speed.sample;
+}
+
+void SimDevice::release_(uint64_t low_start, uint64_t t) {
+  this->event_ns_ = t;
+  uint64_t low = t - low_start;
+  if (low >= SIM_STANDARD.reset_min) {
+    this->overdrive_ = false;
+    this->reset_(t, true);
+  } else if (this->overdrive_ && low_start >= this->overdrive_from_ && low >= SIM_OVERDRIVE.reset_min) {
+    this->reset_(t, true);
+  }
+}
+
+void SimDevice::reset_(uint64_t t, bool presence) {
+  this->event_ns_ = t;
+  this->resets++;
+  this->state_ = STATE_ROM_COMMAND;
+  this->value_ = 0;
+  this->bits_ = 0;
+  this->sample_at_ = 0;
+  this->slot_tx_ = -1;
+  this->transmitting_ = false;
+  this->rx_after_tx_ = false;
+  this->tx_.clear();
+  this->tx_bit_index_ = 0;
+  this->hold_until_ = 0;
+  if (presence) {
+    auto &speed = this->overdrive_ ? SIM_OVERDRIVE : SIM_STANDARD;
+    this->hold_from_ = t + speed.presence_wait;
+    this->hold_until_ = this->hold_from_ + speed.presence_low;
+  }
+}
+
+void SimDevice::sample_(bool level) {
+  int tx = this->slot_tx_;
+  this->slot_tx_ = -1;
+  if (tx < 0)
+    this->rx_bit_(level);
+  this->on_slot_end_();
+}
+
+int SimDevice::tx_bit_() {
+  switch (this->state_) {
+    case STATE_SEARCH: {
+      bool bit = (this->rom_ >> this->search_bit_) & 1;
+      if (this->search_phase_ == 0) {
+        this->search_phase_ = 1;
+        return bit;
+      }
+      if (this->search_phase_ == 1) {
+        this->search_phase_ = 2;
+        return !bit;
+      }
+      return -1;
+    }
+    case STATE_FUNCTION: {
+      if (!this->transmitting_)
+        return -1;
+      if (this->tx_.empty()) {
+        if (this->rx_after_tx_) {
+          this->transmitting_ = false;
+          this->rx_after_tx_ = false;
+          return -1;
+        }
+        this->fill_tx_();
+      }
+      if (this->tx_.empty())
+        return this->idle_bit_();
+      bool bit = (this->tx_.front() >> this->tx_bit_index_) & 1;
+      if (++this->tx_bit_index_ == 8) {
+        this->tx_bit_index_ = 0;
+        this->tx_.pop_front();
+      }
+      return bit;
+    }
+    default:
+      return -1;
+  }
+}
+
+void SimDevice::rx_bit_(bool bit) {
+  switch (this->state_) {
+    case STATE_ROM_COMMAND:
+      if (bit)
+        this->value_ |= 1u << this->bits_;
+      if (++this->bits_ == 8)
+        this->rom_command_(this->value_);
+      break;
+    case STATE_MATCH:
+      if (bit)
+        this->value_ |= uint64_t(1) << this->bits_;
+      if (++this->bits_ < 64)
+        break;
+      if (this->value_ == this->rom_) {
+        this->select_(this->rom_command_value_);
+        this->resume_flag_ = this->supports_resume_();
+      } else {
+        this->resume_flag_ = false;
+        // only the matched device stays at overdrive speed
+        if (this->rom_command_value_ == ROM_OVERDRIVE_MATCH)
+          this->overdrive_ = this->was_overdrive_;
+        this->deselect_();
+      }
+      break;
+    case STATE_SEARCH:
+      if (this->search_phase_ != 2)
+        break;
+      // the master's choice, the devices with the other bit drop out
+      if (bit != bool((this->rom_ >> this->search_bit_) & 1)) {
+        this->deselect_();
+        break;
+      }
+      this->search_phase_ = 0;
+      if (++this->search_bit_ == 64)
+        this->select_(this->rom_command_value_);
+      break;
+    case STATE_FUNCTION:
+      if (this->transmitting_)
+        break;
+      if (bit)
+        this->value_ |= 1u << this->bits_;
+      if (++this->bits_ == 8) {
+        uint8_t value = this->value_;
+        this->value_ = 0;
+        this->bits_ = 0;
+        this->on_byte_(value);
+      }
+      break;
+    case STATE_IDLE:
+      break;
+  }
+}
+
+void SimDevice::rom_command_(uint8_t command) {
+  this->rom_command_value_ = command;
+  this->value_ = 0;
+  this->bits_ = 0;
+  if (command != ROM_MATCH && command != ROM_OVERDRIVE_MATCH && command != ROM_RESUME)
+    this->resume_flag_ = false;
+
+  if (command == ROM_READ) {
+    this->select_(command);
+    for (uint8_t i = 0; i < 8; i++)
+      this->send_(this->rom_ >> (i * 8));
+    this->send_then_receive_();
+    this->transmit_();
+  } else if (command == ROM_MATCH) {
+    this->state_ = STATE_MATCH;
+  } else if (command == ROM_OVERDRIVE_MATCH && this->supports_overdrive_()) {
+    this->was_overdrive_ = this->overdrive_;
+    this->set_overdrive_();
+    this->state_ = STATE_MATCH;
+  } else if (command == ROM_SKIP && this->supports_skip_()) {
+    this->select_(command);
+  } else if (command == ROM_OVERDRIVE_SKIP && this->supports_overdrive_()) {
+    this->set_overdrive_();
+    this->select_(command);
+  } else if (command == ROM_SEARCH || (command == ROM_ALARM_SEARCH && this->alarm_())) {
+    this->state_ = STATE_SEARCH;
+    this->searches++;
+    this->search_bit_ = 0;
+    this->search_phase_ = 0;
+  } else if (command == ROM_RESUME && this->resume_flag_) {
+    this->select_(command);
+  } else {
+    this->deselect_();
+  }
+}
+
+void SimDevice::set_overdrive_() {
+  if (this->overdrive_)
+    return;
+  // the slot that carried the last command bit is still a standard speed one, its low is no reset
+  this->overdrive_ = true;
+  this->overdrive_from_ = host_now_ns();
+}
+
+void SimDevice::select_(uint8_t rom_command) {
+  this->state_ = STATE_FUNCTION;
+  this->selects++;
+  if (rom_command == ROM_MATCH || rom_command == ROM_OVERDRIVE_MATCH || rom_command == ROM_RESUME)
+    this->addressed_selects++;
+  this->transmitting_ = false;
+  this->rx_after_tx_ = false;
+  this->tx_.clear();
+  this->tx_bit_index_ = 0;
+  this->value_ = 0;
+  this->bits_ = 0;
+  this->on_select_(rom_command);
+}
+
+void SimBus::add_device(SimDevice *device) {
+  device->bus_ = this;
+  this->devices_.push_back(device);
+}
+
+void SimBus::remove_device(SimDevice *device) {
+  this->devices_.erase(std::remove(this->devices_.begin(), this->devices_.end(), device), this->devices_.end());
+  device->bus_ = nullptr;
+}
+
+bool SimBus::level_at(uint64_t t) const {
+  if (this->output_ && !this->latch_)
+    return false;
+  uint64_t last_low = this->released_at_;
+  for (auto *device : this->devices_) {
+    if (!device->connected_)
+      continue;
+    if (device->holds_(t))
+      return false;
+    if (device->hold_until_ <= t && device->hold_until_ > last_low)
+      last_low = device->hold_until_;
+  }
+  // driven high, or pulled up through the bus capacitance
+  return this->output_ || t >= last_low + this->rise_ns_;
+}
+
+void SimBus::advance_to(uint64_t t) {
+  while (true) {
+    SimDevice *next = nullptr;
+    for (auto *device : this->devices_) {
+      if (!device->connected_ || device->sample_at_ == 0 || device->sample_at_ > t)
+        continue;
+      if (next == nullptr || device->sample_at_ < next->sample_at_)
+        next = device;
+    }
+    if (next == nullptr)
+      return;
+    uint64_t at = next->sample_at_;
+    next->sample_at_ = 0;
+    next->event_ns_ = at;
+    next->sample_(this->level_at(at));
+  }
+}
+
+void SimBus::idle(uint32_t us) {
+  host_advance_ns(uint64_t(us) * 1000);
+  this->advance_to(host_now_ns());
+}
+
+void SimBus::update_master_(bool output, bool latch) {
+  uint64_t t = host_now_ns();
+  this->advance_to(t);
+  bool was_low = this->output_ && !this->latch_;
+  bool was_driven_high = this->output_ && this->latch_;
+  bool low = output && !latch;
+  bool line_high = this->level_at(t);
+
+  this->output_ = output;
+  this->latch_ = latch;
+  if (low && !was_low) {
+    this->low_start_ = t;
+    if (line_high) {
+      this->falls++;
+      for (auto *device : this->devices_) {
+        if (device->connected_)
+          device->fall_(t);
+      }
+    } else {
+      this->early_falls++;
+    }
+  } else if (!low && was_low) {
+    this->released_at_ = t;
+    for (auto *device : this->devices_) {
+      if (device->connected_)
+        device->release_(this->low_start_, t);
+    }
+  } else if (was_driven_high && !output && line_high) {
+    // the line is already up, letting go of it doesn't start a rise
+    this->released_at_ = t >= this->rise_ns_ ? t - this->rise_ns_ : 0;
+  }
+
+  if (output && latch && !was_driven_high) {
+    for (auto *device : this->devices_) {
+      if (device->connected_ && device->holds_(t))
+        this->contentions++;
+    }
+  }
+  host_advance_ns(this->pin_op_ns_);
+}
+
+void SimBus::pin_mode(gpio::Flags flags) { this->update_master_((flags & gpio::FLAG_OUTPUT) != 0, this->latch_); }
+
+void SimBus::digital_write(bool value) { this->update_master_(this->output_, value); }
+
+bool SimBus::digital_read() {
+  uint64_t t = host_now_ns();
+  this->advance_to(t);
+  bool level = this->level_at(t);
+  host_advance_ns(this->pin_op_ns_);
+  return level;
+}
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "esphome/core/hal.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace esphome {
+namespace dallas {
+
+class SimBus;
+
+/** A 1-Wire slave on the simulated bus.
+ *
+ * The slave only sees the line: it times the low pulses the master sends,
+ * samples write slots about 30µs (3µs at overdrive) after the falling edge and
+ * answers a read slot with a 0 by holding the line. The ROM layer is done here,
+ * the device models implement the function commands on top of it.
+ */
+class SimDevice {
+ public:
+  explicit SimDevice(uint64_t rom) : rom_(rom) {}
+  virtual ~SimDevice() = default;
+
+  uint64_t get_rom() const { return this->rom_; }
+  bool is_overdrive() const { return this->overdrive_; }
+  /// A device behind a closed coupler branch doesn't see the bus.
+  void set_connected(bool connected);
+  bool is_connected() const { return this->connected_; }
+  /// A reset generated by a coupler on the branch, without a presence pulse on the bus.
+  void branch_reset();
+
+  /// Resets seen, selects by any ROM command.
+  uint32_t resets{0};
+  uint32_t selects{0};
+  /// Selects of this device alone by Match ROM, Overdrive-Match ROM or Resume ROM.
+  uint32_t addressed_selects{0};
+  /// Searches the device took part in.
+  uint32_t searches{0};
+  /// Falls that came before the device was done with the last slot.
+  uint32_t missed_slots{0};
+
+ protected:
+  friend SimBus;
+
+  enum State : uint8_t {
+    STATE_IDLE,
+    STATE_ROM_COMMAND,
+    STATE_MATCH,
+    STATE_SEARCH,
+    STATE_FUNCTION,
+  };
+
+  /// The device was selected by rom_command, the function command comes next.
+  virtual void on_select_(uint8_t rom_command) {}
+  /// A function command or data byte was received.
+  virtual void on_byte_(uint8_t value) {}
+  /// The queued bytes are sent, queue more or leave it empty to send idle_bit_().
+  virtual void fill_tx_() {}
+  /// A slot ended, after the device sampled or answered it.
+  virtual void on_slot_end_() {}
+  /// What read slots return when nothing is queued.
+  virtual bool idle_bit_() { return true; }
+  /// Whether the device takes part in a conditional search.
+  virtual bool alarm_() { return false; }
+  /// Whether the device knows Skip ROM, the DS2405 doesn't.
+  virtual bool supports_skip_() const { return true; }
+  virtual bool supports_overdrive_() const { return false; }
+  virtual bool supports_resume_() const { return false; }
+
+  /// Queue bytes for the following read slots.
+  void send_(uint8_t value) { this->tx_.push_back(value); }
+  void send_(const uint8_t *data, size_t len) { this->tx_.insert(this->tx_.end(), data, data + len); }
+  /// Send the queued bytes, then receive again.
+  void send_then_receive_() { this->rx_after_tx_ = true; }
+  /// Start answering read slots.
+  void transmit_() { this->transmitting_ = true; }
+  /// Whether all queued bytes went out.
+  bool sent_() const { return this->tx_.empty(); }
+  /// Ignore everything until the next reset.
+  void deselect_() { this->state_ = STATE_IDLE; }
+  /// Virtual time of the slot or reset being handled, in µs; slots are handled at the next pin change.
+  uint64_t now_us_() const { return this->event_ns_ / 1000; }
+
+  // called by the bus
+  void fall_(uint64_t t);
+  void release_(uint64_t low_start, uint64_t t);
+  void sample_(bool level);
+  bool holds_(uint64_t t) const { return t >= this->hold_from_ && t < this->hold_until_; }
+
+  void reset_(uint64_t t, bool presence);
+  /// Bit for the next slot, -1 to receive.
+  int tx_bit_();
+  void rx_bit_(bool bit);
+  void rom_command_(uint8_t command);
+  void select_(uint8_t rom_command);
+  void set_overdrive_();
+
+  uint64_t rom_;
+  SimBus *bus_{nullptr};
+  bool connected_{true};
+  State state_{STATE_IDLE};
+  bool overdrive_{false};
+  uint64_t event_ns_{0};
+  /// Overdrive before an Overdrive-Match ROM, a device that isn't matched goes back to it.
+  bool was_overdrive_{false};
+  /// When the device switched to overdrive, lows that started before are standard speed slots.
+  uint64_t overdrive_from_{0};
+  bool resume_flag_{false};
+  uint8_t rom_command_value_{0};
+
+  // slot in progress
+  uint64_t sample_at_{0};
+  int slot_tx_{-1};
+  uint64_t hold_from_{0};
+  uint64_t hold_until_{0};
+
+  // bit collection
+  uint64_t value_{0};
+  uint8_t bits_{0};
+  uint8_t search_bit_{0};
+  uint8_t search_phase_{0};
+
+  // function layer transmit queue
+  bool transmitting_{false};
+  bool rx_after_tx_{false};
+  std::deque<uint8_t> tx_;
+  uint8_t tx_bit_index_{0};
+};
+
+/** An open-drain 1-Wire bus on a host pin, with a pull-up and the devices on it.
+ *
+ * Time is the virtual host clock in ns. The master's pin operations and reads
+ * come in as they happen; device slot events before that time are handled
+ * first, so every sample sees the line as it was at its own time.
+ */
+class SimBus : public HostPinListener {
+ public:
+  explicit SimBus(uint8_t pin = 4) : pin_(pin) { host_attach_pin(pin, this); }
+  ~SimBus() override { host_attach_pin(this->pin_, nullptr); }
+
+  void add_device(SimDevice *device);
+  void remove_device(SimDevice *device);
+  uint8_t get_pin() const { return this->pin_; }
+
+  /// Time the line takes to rise after being released, set by the pull-up and the bus capacitance.
+  void set_rise_ns(uint32_t rise_ns) { this->rise_ns_ = rise_ns; }
+  /// Time each pin operation of the master takes.
+  void set_pin_op_ns(uint32_t pin_op_ns) { this->pin_op_ns_ = pin_op_ns; }
+
+  /// Level of the line at t, for t not before the last pin operation.
+  bool level_at(uint64_t t) const;
+  /// Handle the device slot events up to t.
+  void advance_to(uint64_t t);
+  /// Let the bus sit idle for us, the devices finish the last slot.
+  void idle(uint32_t us);
+
+  /// Falling edges the devices saw.
+  uint32_t falls{0};
+  /// Master pulls that came while the line was still low or rising, the devices didn't see them.
+  uint32_t early_falls{0};
+  /// Times the master drove the line high while a device held it low.
+  uint32_t contentions{0};
+
+  // HostPinListener
+  void pin_mode(gpio::Flags flags) override;
+  void digital_write(bool value) override;
+  bool digital_read() override;
+
+ protected:
+  void update_master_(bool output, bool latch);
+
+  uint8_t pin_;
+  std::vector<SimDevice *> devices_;
+  uint32_t rise_ns_{500};
+  uint32_t pin_op_ns_{100};
+  bool output_{false};
+  bool latch_{false};
+  /// When the master started pulling low, valid while it does.
+  uint64_t low_start_{0};
+  /// When the master last stopped pulling low.
+  uint64_t released_at_{0};
+};
+
+}  // namespace dallas
+}  // namespace esphome
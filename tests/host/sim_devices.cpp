@@ -0,0 +1,613 @@
+#include "sim_devices.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace esphome {
+namespace dallas {
+
+static const uint8_t ROM_MATCH = 0x55;
+static const uint8_t ROM_SEARCH = 0xF0;
+static const uint8_t ROM_ALARM_SEARCH = 0xEC;
+
+uint8_t sim_crc8(const uint8_t *data, size_t len) {
+  uint8_t crc = 0;
+  while (len--) {
+    uint8_t in = *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      bool mix = (crc ^ in) & 1;
+      crc >>= 1;
+      if (mix)
+        crc ^= 0x8C;
+      in >>= 1;
+    }
+  }
+  return crc;
+}
+
+uint16_t sim_crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+  }
+  return ~crc;
+}
+
+uint64_t sim_rom(uint8_t family, uint64_t serial) {
+  uint64_t rom = ((serial & 0xFFFFFFFFFFFFULL) << 8) | family;
+  uint8_t bytes[7];
+  for (uint8_t i = 0; i < 7; i++)
+    bytes[i] = rom >> (i * 8);
+  return rom | (uint64_t(sim_crc8(bytes, 7)) << 56);
+}
+
+static void append_crc16(std::vector<uint8_t> &block) {
+  uint16_t crc = sim_crc16(block.data(), block.size());
+  block.push_back(crc & 0xFF);
+  block.push_back(crc >> 8);
+}
+
+// SimRecorder
+
+void SimRecorder::on_byte_(uint8_t value) {
+  this->received.push_back(value);
+  if (++this->count_ == this->listen)
+    this->transmit_();
+}
+
+void SimRecorder::fill_tx_() {
+  if (this->responses.empty())
+    return;
+  this->send_(this->responses.front());
+  this->responses.pop_front();
+}
+
+// SimDS18B20
+
+static const uint8_t DS18_CONVERT = 0x44;
+static const uint8_t DS18_READ_SCRATCH_PAD = 0xBE;
+static const uint8_t DS18_WRITE_SCRATCH_PAD = 0x4E;
+static const uint8_t DS18_COPY_SCRATCH_PAD = 0x48;
+static const uint8_t DS18_RECALL = 0xB8;
+
+SimDS18B20::SimDS18B20(uint64_t rom) : SimDevice(rom) {
+  // power-up state: 85°C, alarms at 75°C and 70°C, 12 bit
+  const uint8_t ds18b20[9] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0};
+  const uint8_t ds18s20[9] = {0xAA, 0x00, 0x4B, 0x46, 0xFF, 0xFF, 0x0C, 0x10, 0};
+  memcpy(this->scratch_pad_, this->is_ds18s20_() ? ds18s20 : ds18b20, 9);
+  this->scratch_pad_[8] = sim_crc8(this->scratch_pad_, 8);
+  memcpy(this->eeprom_, this->scratch_pad_ + 2, 3);
+}
+
+void SimDS18B20::set_alarms(int8_t high, int8_t low) {
+  this->scratch_pad_[2] = high;
+  this->scratch_pad_[3] = low;
+  this->scratch_pad_[8] = sim_crc8(this->scratch_pad_, 8);
+  memcpy(this->eeprom_, this->scratch_pad_ + 2, 3);
+}
+
+uint32_t SimDS18B20::conversion_us_() const {
+  if (this->is_ds18s20_())
+    return 750000;
+  switch ((this->scratch_pad_[4] >> 5) & 3) {
+    case 0:
+      return 94000;
+    case 1:
+      return 188000;
+    case 2:
+      return 375000;
+    default:
+      return 750000;
+  }
+}
+
+void SimDS18B20::update_() {
+  if (!this->converting_ || this->now_us_() < this->conversion_done_)
+    return;
+  this->converting_ = false;
+  if (this->is_ds18s20_()) {
+    // half degrees, the count registers give the rest
+    int base = int(std::floor(this->temperature + 0.25f));
+    int16_t raw = base * 2;
+    this->scratch_pad_[0] = raw & 0xFF;
+    this->scratch_pad_[1] = (raw >> 8) & 0xFF;
+    this->scratch_pad_[6] = 16 - uint8_t(std::lround((this->temperature - base + 0.25f) * 16));
+    this->scratch_pad_[7] = 16;
+  } else {
+    int16_t raw = int16_t(std::lround(this->temperature * 16));
+    // the lower resolutions leave the low bits undefined, the devices clear them
+    uint8_t resolution = 9 + ((this->scratch_pad_[4] >> 5) & 3);
+    raw &= ~((1 << (12 - resolution)) - 1);
+    this->scratch_pad_[0] = raw & 0xFF;
+    this->scratch_pad_[1] = (raw >> 8) & 0xFF;
+  }
+  this->scratch_pad_[8] = sim_crc8(this->scratch_pad_, 8);
+}
+
+void SimDS18B20::on_select_(uint8_t rom_command) {
+  this->command_ = 0;
+  this->written_ = 0;
+}
+
+void SimDS18B20::on_byte_(uint8_t value) {
+  this->update_();
+  if (this->command_ == DS18_WRITE_SCRATCH_PAD) {
+    // TH, TL and the config register, the DS18S20 has no config register
+    uint8_t count = this->is_ds18s20_() ? 2 : 3;
+    if (this->written_ < count) {
+      uint8_t at = 2 + this->written_++;
+      this->scratch_pad_[at] = at == 4 ? (value & 0x60) | 0x1F : value;
+      this->scratch_pad_[8] = sim_crc8(this->scratch_pad_, 8);
+    }
+    return;
+  }
+  if (this->command_ != 0)
+    return;
+  this->command_ = value;
+  switch (value) {
+    case DS18_CONVERT:
+      this->converting_ = true;
+      this->conversion_done_ = this->now_us_() + this->conversion_us_();
+      this->transmit_();
+      break;
+    case DS18_READ_SCRATCH_PAD:
+      this->send_(this->scratch_pad_, 9);
+      this->transmit_();
+      break;
+    case DS18_COPY_SCRATCH_PAD:
+      memcpy(this->eeprom_, this->scratch_pad_ + 2, 3);
+      this->eeprom_writes++;
+      break;
+    case DS18_RECALL:
+      memcpy(this->scratch_pad_ + 2, this->eeprom_, this->is_ds18s20_() ? 2 : 3);
+      this->scratch_pad_[8] = sim_crc8(this->scratch_pad_, 8);
+      break;
+    default:
+      break;
+  }
+}
+
+bool SimDS18B20::idle_bit_() {
+  // a powered device answers read slots with 0 while converting
+  this->update_();
+  return !this->converting_;
+}
+
+bool SimDS18B20::alarm_() {
+  this->update_();
+  int8_t t = int8_t((this->scratch_pad_[1] << 4) | (this->scratch_pad_[0] >> 4));
+  if (this->is_ds18s20_())
+    t = int8_t(int16_t(this->scratch_pad_[0] | (this->scratch_pad_[1] << 8)) >> 1);
+  return t >= int8_t(this->scratch_pad_[2]) || t <= int8_t(this->scratch_pad_[3]);
+}
+
+// SimDS2405
+
+void SimDS2405::on_select_(uint8_t rom_command) {
+  if (rom_command == ROM_MATCH) {
+    this->pio_on = !this->pio_on;
+  } else if (rom_command != ROM_SEARCH && rom_command != ROM_ALARM_SEARCH) {
+    return;
+  }
+  // read slots return the level of the PIO pin
+  this->answer_ = this->pio_level();
+  this->transmit_();
+}
+
+// SimDS2408
+
+static const uint8_t DS2408_READ_REGISTERS = 0xF0;
+static const uint8_t DS2408_CHANNEL_READ = 0xF5;
+static const uint8_t DS2408_CHANNEL_WRITE = 0x5A;
+static const uint8_t DS2408_WRITE_SEARCH_REGISTER = 0xCC;
+static const uint8_t DS2408_RESET_ACTIVITY = 0xC3;
+static const uint8_t SIM_CONFIRM = 0xAA;
+
+void SimDS2408::set_inputs(uint8_t inputs) {
+  uint8_t before = this->pio();
+  this->inputs = inputs;
+  this->activity |= before ^ this->pio();
+}
+
+void SimDS2408::write_latch_(uint8_t value) {
+  uint8_t before = this->pio();
+  this->latch = value;
+  this->activity |= before ^ this->pio();
+}
+
+uint8_t SimDS2408::register_(uint16_t address) const {
+  switch (address) {
+    case 0x88:
+      return this->pio();
+    case 0x89:
+      return this->latch;
+    case 0x8A:
+      return this->activity;
+    case 0x8B:
+      return this->search_mask;
+    case 0x8C:
+      return this->search_polarity;
+    case 0x8D:
+      return this->control;
+    default:
+      return 0xFF;
+  }
+}
+
+bool SimDS2408::alarm_() {
+  // PLS picks the activity latches over the pin levels, CT ANDs the selected bits instead of ORing them
+  uint8_t source = (this->control & 0x01) ? this->activity : this->pio();
+  uint8_t match = ~(source ^ this->search_polarity) & this->search_mask;
+  if (this->control & 0x02)
+    return match == this->search_mask;
+  return match != 0;
+}
+
+void SimDS2408::on_select_(uint8_t rom_command) {
+  this->command_ = 0;
+  this->received_ = 0;
+  this->block_.clear();
+}
+
+void SimDS2408::on_byte_(uint8_t value) {
+  if (this->command_ == 0) {
+    this->command_ = value;
+    this->block_.push_back(value);
+    if (value == DS2408_CHANNEL_READ) {
+      this->transmit_();
+    } else if (value == DS2408_RESET_ACTIVITY) {
+      this->activity = 0;
+      this->transmit_();
+    }
+    return;
+  }
+  this->received_++;
+  switch (this->command_) {
+    case DS2408_READ_REGISTERS:
+      this->block_.push_back(value);
+      if (this->received_ == 1) {
+        this->address_ = value;
+      } else {
+        this->address_ |= value << 8;
+        // the registers up to the end of the page, then the crc over the command, address and data
+        for (uint16_t a = this->address_; a < 0x90; a++)
+          this->block_.push_back(this->register_(a));
+        append_crc16(this->block_);
+        this->send_(this->block_.data() + 3, this->block_.size() - 3);
+        this->transmit_();
+      }
+      break;
+    case DS2408_CHANNEL_WRITE:
+      if (this->received_ & 1) {
+        this->data_ = value;
+      } else if (value == uint8_t(~this->data_)) {
+        this->write_latch_(this->data_);
+        this->send_(SIM_CONFIRM);
+        this->send_(this->pio());
+        this->send_then_receive_();
+        this->transmit_();
+      } else {
+        this->deselect_();
+      }
+      break;
+    case DS2408_WRITE_SEARCH_REGISTER:
+      if (this->received_ == 1) {
+        this->address_ = value;
+      } else if (this->received_ == 2) {
+        this->address_ |= value << 8;
+      } else {
+        if (this->address_ == 0x8B)
+          this->search_mask = value;
+        else if (this->address_ == 0x8C)
+          this->search_polarity = value;
+        else if (this->address_ == 0x8D)
+          this->control = (this->control & 0x80) | (value & 0x0F);
+        this->address_++;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void SimDS2408::fill_tx_() {
+  if (this->command_ == DS2408_RESET_ACTIVITY) {
+    this->send_(SIM_CONFIRM);
+  } else if (this->command_ == DS2408_CHANNEL_READ) {
+    // 32 samples of the pins, then a crc16, the first one also covers the command
+    for (uint8_t i = 0; i < 32; i++)
+      this->block_.push_back(this->pio());
+    append_crc16(this->block_);
+    size_t skip = this->block_.size() > 34 ? 1 : 0;
+    this->send_(this->block_.data() + skip, this->block_.size() - skip);
+    this->block_.clear();
+  }
+}
+
+// SimDS2409
+
+static const uint8_t DS2409_STATUS = 0x5A;
+static const uint8_t DS2409_ALL_OFF = 0x66;
+static const uint8_t DS2409_DISCHARGE = 0x99;
+static const uint8_t DS2409_DIRECT_ON_MAIN = 0xA5;
+static const uint8_t DS2409_SMART_ON_MAIN = 0xCC;
+static const uint8_t DS2409_SMART_ON_AUX = 0x33;
+
+void SimDS2409::add_main(SimDevice *device) {
+  this->main_.push_back(device);
+  device->set_connected(this->main_on_);
+}
+
+void SimDS2409::add_aux(SimDevice *device) {
+  this->aux_.push_back(device);
+  device->set_connected(this->aux_on_);
+}
+
+void SimDS2409::connect_(bool main, bool aux) {
+  this->main_on_ = main;
+  this->aux_on_ = aux;
+  for (auto *device : this->main_)
+    device->set_connected(main);
+  for (auto *device : this->aux_)
+    device->set_connected(aux);
+}
+
+uint8_t SimDS2409::status_() const {
+  // b0 main off, b2 aux off, b6 control output on
+  return (this->main_on_ ? 0 : 0x01) | (this->aux_on_ ? 0 : 0x04) | (this->control ? 0x40 : 0);
+}
+
+void SimDS2409::on_select_(uint8_t rom_command) {
+  this->command_ = 0;
+  this->connect_after_ = -1;
+}
+
+void SimDS2409::on_slot_end_() {
+  // the branch is switched on after the confirmation byte, its devices don't see those slots
+  if (this->connect_after_ < 0 || !this->sent_())
+    return;
+  this->connect_(this->connect_after_ == 0, this->connect_after_ == 1);
+  this->connect_after_ = -1;
+}
+
+void SimDS2409::on_byte_(uint8_t value) {
+  if (this->command_ == 0) {
+    this->command_ = value;
+    switch (value) {
+      case DS2409_ALL_OFF:
+      case DS2409_DISCHARGE:
+        this->connect_(false, false);
+        this->send_(value);
+        this->transmit_();
+        break;
+      case DS2409_DIRECT_ON_MAIN:
+        this->connect_(false, false);
+        this->connect_after_ = 0;
+        this->send_(value);
+        this->transmit_();
+        break;
+      default:
+        break;
+    }
+    return;
+  }
+  if (this->command_ == DS2409_STATUS) {
+    // bit 5 switches the control output to manual, bit 7 is its state then
+    if (value & 0x20)
+      this->control = value & 0x80;
+    this->send_(this->status_());
+    this->send_(this->status_());
+    this->transmit_();
+  } else if (this->command_ == DS2409_SMART_ON_MAIN || this->command_ == DS2409_SMART_ON_AUX) {
+    // the reset byte, the coupler resets the branch and reports whether anything answered
+    bool main = this->command_ == DS2409_SMART_ON_MAIN;
+    this->connect_(false, false);
+    bool presence = false;
+    for (auto *device : main ? this->main_ : this->aux_) {
+      device->branch_reset();
+      presence = true;
+    }
+    this->connect_after_ = main ? 0 : 1;
+    this->send_(presence ? 0x00 : 0xFF);
+    this->send_(this->command_);
+    this->transmit_();
+  }
+}
+
+// SimDS2413
+
+static const uint8_t DS2413_READ = 0xF5;
+static const uint8_t DS2413_WRITE = 0x5A;
+
+uint8_t SimDS2413::status() const {
+  uint8_t pins = this->latch & this->inputs;
+  uint8_t status = (pins & 1) | ((this->latch & 1) << 1) | ((pins & 2) << 1) | ((this->latch & 2) << 2);
+  return status | (~status << 4);
+}
+
+void SimDS2413::on_select_(uint8_t rom_command) {
+  this->command_ = 0;
+  this->received_ = 0;
+}
+
+void SimDS2413::on_byte_(uint8_t value) {
+  if (this->command_ == 0) {
+    this->command_ = value;
+    if (value == DS2413_READ)
+      this->transmit_();
+    return;
+  }
+  if (this->command_ != DS2413_WRITE)
+    return;
+  if (++this->received_ & 1) {
+    this->data_ = value;
+  } else if (value == uint8_t(~this->data_)) {
+    this->latch = this->data_ & 0x03;
+    this->send_(SIM_CONFIRM);
+    this->send_(this->status());
+    this->send_then_receive_();
+    this->transmit_();
+  } else {
+    this->deselect_();
+  }
+}
+
+void SimDS2413::fill_tx_() {
+  if (this->command_ == DS2413_READ)
+    this->send_(this->status());
+}
+
+// SimDS2423
+
+static const uint8_t DS2423_READ_MEMORY_COUNTER = 0xA5;
+
+SimDS2423::SimDS2423(uint64_t rom) : SimDevice(rom) { memset(this->memory, 0xFF, sizeof(this->memory)); }
+
+void SimDS2423::on_select_(uint8_t rom_command) {
+  this->command_ = 0;
+  this->received_ = 0;
+  this->first_page_ = true;
+}
+
+void SimDS2423::on_byte_(uint8_t value) {
+  if (this->command_ == 0) {
+    this->command_ = value;
+    return;
+  }
+  if (this->command_ != DS2423_READ_MEMORY_COUNTER)
+    return;
+  if (++this->received_ == 1) {
+    this->address_ = value;
+  } else if (this->received_ == 2) {
+    this->address_ = (this->address_ | (value << 8)) & 0x1FF;
+    this->transmit_();
+  }
+}
+
+void SimDS2423::fill_tx_() {
+  if (this->command_ != DS2423_READ_MEMORY_COUNTER || this->address_ >= 512)
+    return;
+  // the rest of the page, its counter, 4 zero bytes and a crc16; the first one also covers the command and address
+  std::vector<uint8_t> block;
+  if (this->first_page_) {
+    block = {this->command_, uint8_t(this->address_ & 0xFF), uint8_t(this->address_ >> 8)};
+  }
+  uint16_t page = this->address_ / 32;
+  uint16_t end = (page + 1) * 32;
+  for (; this->address_ < end; this->address_++)
+    block.push_back(this->memory[this->address_]);
+  uint32_t counter = page >= 12 ? this->counters[page - 12] : 0xFFFFFFFF;
+  for (uint8_t i = 0; i < 4; i++)
+    block.push_back(counter >> (i * 8));
+  for (uint8_t i = 0; i < 4; i++)
+    block.push_back(0);
+  append_crc16(block);
+  size_t skip = this->first_page_ ? 3 : 0;
+  this->send_(block.data() + skip, block.size() - skip);
+  this->first_page_ = false;
+}
+
+// SimDS2438
+
+static const uint8_t DS2438_READ_SCRATCH_PAD = 0xBE;
+static const uint8_t DS2438_WRITE_SCRATCH_PAD = 0x4E;
+static const uint8_t DS2438_COPY_SCRATCH_PAD = 0x48;
+static const uint8_t DS2438_RECALL = 0xB8;
+static const uint8_t DS2438_CONVERT_T = 0x44;
+static const uint8_t DS2438_CONVERT_V = 0xB4;
+
+SimDS2438::SimDS2438(uint64_t rom) : SimDevice(rom) {
+  memset(this->pages_, 0, sizeof(this->pages_));
+  memset(this->scratch_pad_, 0, sizeof(this->scratch_pad_));
+  // IAD, CA and EE set after power-up
+  this->pages_[0][0] = 0x07;
+}
+
+void SimDS2438::update_() {
+  uint64_t now = this->now_us_();
+  if (this->temperature_pending_ && now >= this->temperature_done_) {
+    this->temperature_pending_ = false;
+    // 13 bits, 1/32°C
+    int16_t raw = int16_t(std::lround(this->temperature * 32)) << 3;
+    this->pages_[0][1] = raw & 0xFF;
+    this->pages_[0][2] = (raw >> 8) & 0xFF;
+  }
+  if (this->voltage_pending_ && now >= this->voltage_done_) {
+    this->voltage_pending_ = false;
+    // 10mV steps
+    float volt = this->convert_vdd_ ? this->vdd : this->vad;
+    uint16_t raw = uint16_t(std::lround(volt * 100)) & 0x3FF;
+    this->pages_[0][3] = raw & 0xFF;
+    this->pages_[0][4] = raw >> 8;
+  }
+  // the current ADC runs on its own while IAD is set
+  if (this->pages_[0][0] & 0x01) {
+    this->pages_[0][5] = this->current & 0xFF;
+    this->pages_[0][6] = (this->current >> 8) & 0x03;
+    if (this->current < 0)
+      this->pages_[0][6] |= 0xFC;
+  }
+  this->pages_[1][4] = this->ica;
+}
+
+void SimDS2438::on_select_(uint8_t rom_command) {
+  this->command_ = 0;
+  this->received_ = 0;
+}
+
+void SimDS2438::on_byte_(uint8_t value) {
+  this->update_();
+  if (this->command_ == 0) {
+    this->command_ = value;
+    if (value == DS2438_CONVERT_T) {
+      this->temperature_pending_ = true;
+      this->temperature_done_ = this->now_us_() + 10000;
+      this->transmit_();
+    } else if (value == DS2438_CONVERT_V) {
+      this->voltage_pending_ = true;
+      // AD selects VDD over VAD when the conversion starts
+      this->convert_vdd_ = this->pages_[0][0] & 0x08;
+      this->voltage_done_ = this->now_us_() + 4000;
+      this->transmit_();
+    }
+    return;
+  }
+  if (++this->received_ == 1) {
+    this->page_ = value & 0x07;
+    auto &pad = this->scratch_pad_[this->page_];
+    switch (this->command_) {
+      case DS2438_RECALL:
+        memcpy(pad, this->pages_[this->page_], 8);
+        break;
+      case DS2438_COPY_SCRATCH_PAD:
+        if (this->page_ == 0) {
+          // only the config and threshold bytes of page 0 are writable
+          this->pages_[0][0] = (this->pages_[0][0] & 0xF0) | (pad[0] & 0x0F);
+          this->pages_[0][7] = pad[7];
+        } else {
+          memcpy(this->pages_[this->page_], pad, 8);
+        }
+        break;
+      case DS2438_READ_SCRATCH_PAD:
+        this->send_(pad, 8);
+        this->send_(sim_crc8(pad, 8));
+        this->transmit_();
+        break;
+      default:
+        break;
+    }
+    return;
+  }
+  if (this->command_ == DS2438_WRITE_SCRATCH_PAD && this->received_ <= 9)
+    this->scratch_pad_[this->page_][this->received_ - 2] = value;
+}
+
+bool SimDS2438::idle_bit_() {
+  this->update_();
+  return !this->temperature_pending_ && !this->voltage_pending_;
+}
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "sim_bus.h"
+
+#include <deque>
+#include <vector>
+
+namespace esphome {
+namespace dallas {
+
+/// Dallas CRC8 of data, as the devices compute it.
+uint8_t sim_crc8(const uint8_t *data, size_t len);
+/// Dallas CRC16 of data, inverted as the devices send it.
+uint16_t sim_crc16(const uint8_t *data, size_t len);
+/// ROM of a device with this family code and serial number, with its crc.
+uint64_t sim_rom(uint8_t family, uint64_t serial);
+
+/// A device that records the bytes written to it and then answers reads with queued bytes.
+class SimRecorder : public SimDevice {
+ public:
+  explicit SimRecorder(uint64_t rom) : SimDevice(rom) {}
+
+  /// Bytes written after the device was selected.
+  std::vector<uint8_t> received;
+  /// Bytes the device answers with once listen bytes were written, 1s after that.
+  std::deque<uint8_t> responses;
+  uint8_t listen{1};
+
+ protected:
+  void on_select_(uint8_t rom_command) override { this->count_ = 0; }
+  void on_byte_(uint8_t value) override;
+  void fill_tx_() override;
+  bool supports_overdrive_() const override { return true; }
+  bool supports_resume_() const override { return true; }
+
+  uint8_t count_{0};
+};
+
+/// DS18B20 and the DS18S20 with its different scratch pad, by the family code of the ROM.
+class SimDS18B20 : public SimDevice {
+ public:
+  explicit SimDS18B20(uint64_t rom);
+
+  float temperature{21.5f};
+  /// EEPROM writes, they wear the device.
+  uint32_t eeprom_writes{0};
+  uint8_t get_config() const { return this->scratch_pad_[4]; }
+  /// Alarm thresholds as stored in the EEPROM, the device alarms at or outside of them.
+  void set_alarms(int8_t high, int8_t low);
+
+ protected:
+  bool is_ds18s20_() const { return (this->rom_ & 0xFF) == 0x10; }
+  uint32_t conversion_us_() const;
+  /// Put the result of a finished conversion into the scratch pad.
+  void update_();
+  void on_select_(uint8_t rom_command) override;
+  void on_byte_(uint8_t value) override;
+  bool idle_bit_() override;
+  bool alarm_() override;
+
+  uint8_t command_{0};
+  uint8_t written_{0};
+  uint8_t scratch_pad_[9];
+  uint8_t eeprom_[3];
+  bool converting_{false};
+  uint64_t conversion_done_{0};
+};
+
+/// DS2405 addressable switch, Match ROM toggles the PIO.
+class SimDS2405 : public SimDevice {
+ public:
+  explicit SimDS2405(uint64_t rom) : SimDevice(rom) {}
+
+  /// The output transistor pulls the PIO low.
+  bool pio_on{false};
+  /// Something outside pulls the PIO low.
+  bool input_low{false};
+  bool pio_level() const { return !this->pio_on && !this->input_low; }
+
+ protected:
+  void on_select_(uint8_t rom_command) override;
+  bool idle_bit_() override { return this->answer_; }
+  bool alarm_() override { return this->pio_on; }
+  bool supports_skip_() const override { return false; }
+
+  bool answer_{true};
+};
+
+/// DS2408 8 channel switch with its register page and conditional search.
+class SimDS2408 : public SimDevice {
+ public:
+  explicit SimDS2408(uint64_t rom) : SimDevice(rom) {}
+
+  /// Output latches, a 0 pulls the PIO low.
+  uint8_t latch{0xFF};
+  /// Pins pulled low from outside have their bit cleared.
+  uint8_t inputs{0xFF};
+  uint8_t activity{0};
+  uint8_t search_mask{0};
+  uint8_t search_polarity{0};
+  uint8_t control{0x88};
+  uint8_t pio() const { return this->latch & this->inputs; }
+  /// Change the outside inputs, recording activity.
+  void set_inputs(uint8_t inputs);
+
+ protected:
+  uint8_t register_(uint16_t address) const;
+  void write_latch_(uint8_t value);
+  void on_select_(uint8_t rom_command) override;
+  void on_byte_(uint8_t value) override;
+  void fill_tx_() override;
+  bool alarm_() override;
+  bool supports_overdrive_() const override { return true; }
+  bool supports_resume_() const override { return true; }
+
+  uint8_t command_{0};
+  uint8_t received_{0};
+  uint16_t address_{0};
+  uint8_t data_{0};
+  /// Channel access read: bytes and crc of the current 32 byte block.
+  std::vector<uint8_t> block_;
+};
+
+/// DS2409 coupler with a main and an auxiliary branch.
+class SimDS2409 : public SimDevice {
+ public:
+  explicit SimDS2409(uint64_t rom) : SimDevice(rom) {}
+
+  void add_main(SimDevice *device);
+  void add_aux(SimDevice *device);
+  bool main_on() const { return this->main_on_; }
+  bool aux_on() const { return this->aux_on_; }
+  /// Control output transistor.
+  bool control{false};
+
+ protected:
+  void connect_(bool main, bool aux);
+  uint8_t status_() const;
+  void on_select_(uint8_t rom_command) override;
+  void on_byte_(uint8_t value) override;
+  void on_slot_end_() override;
+
+  std::vector<SimDevice *> main_;
+  std::vector<SimDevice *> aux_;
+  bool main_on_{false};
+  bool aux_on_{false};
+  uint8_t command_{0};
+  /// Branch to switch on once the confirmation byte went out, 0 main, 1 aux, -1 none.
+  int8_t connect_after_{-1};
+};
+
+/// DS2413 dual channel switch.
+class SimDS2413 : public SimDevice {
+ public:
+  explicit SimDS2413(uint64_t rom) : SimDevice(rom) {}
+
+  /// Output latches of PIOA and PIOB, a 0 pulls the pin low.
+  uint8_t latch{0x03};
+  uint8_t inputs{0x03};
+  uint8_t status() const;
+
+ protected:
+  void on_select_(uint8_t rom_command) override;
+  void on_byte_(uint8_t value) override;
+  void fill_tx_() override;
+  bool supports_overdrive_() const override { return true; }
+  bool supports_resume_() const override { return true; }
+
+  uint8_t command_{0};
+  uint8_t received_{0};
+  uint8_t data_{0};
+};
+
+/// DS2423 RAM with counters, read with Read Memory + Counter.
+class SimDS2423 : public SimDevice {
+ public:
+  explicit SimDS2423(uint64_t rom);
+
+  /// Counters of pages 12 to 15.
+  uint32_t counters[4] = {0, 0, 0, 0};
+  uint8_t memory[512];
+
+ protected:
+  void on_select_(uint8_t rom_command) override;
+  void on_byte_(uint8_t value) override;
+  void fill_tx_() override;
+  bool supports_overdrive_() const override { return true; }
+
+  uint8_t command_{0};
+  uint8_t received_{0};
+  uint16_t address_{0};
+  bool first_page_{true};
+};
+
+/// DS2438 battery monitor, temperature, the two voltage inputs and the current register.
+class SimDS2438 : public SimDevice {
+ public:
+  explicit SimDS2438(uint64_t rom);
+
+  float temperature{25.0f};
+  float vdd{5.0f};
+  float vad{3.3f};
+  /// Current register, in units of 1/(4096 * Rsens) A.
+  int16_t current{0};
+  uint8_t ica{0};
+  uint8_t get_config() const { return this->pages_[0][0]; }
+
+ protected:
+  void update_();
+  void on_select_(uint8_t rom_command) override;
+  void on_byte_(uint8_t value) override;
+  bool idle_bit_() override;
+
+  uint8_t pages_[8][8];
+  uint8_t scratch_pad_[8][8];
+  uint8_t command_{0};
+  uint8_t page_{0};
+  uint8_t received_{0};
+  uint64_t temperature_done_{0};
+  uint64_t voltage_done_{0};
+  bool temperature_pending_{false};
+  bool voltage_pending_{false};
+  bool convert_vdd_{false};
+};
+
+}  // namespace dallas
+}  // namespace esphome
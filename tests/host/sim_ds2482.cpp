@@ -0,0 +1,197 @@
+#include "sim_ds2482.h"
+
+namespace esphome {
+namespace dallas {
+
+static const uint8_t STATUS_BUSY = 0x01;
+static const uint8_t STATUS_PRESENCE = 0x02;
+static const uint8_t STATUS_RESET = 0x10;
+static const uint8_t STATUS_SINGLE_BIT = 0x20;
+static const uint8_t STATUS_TRIPLET_SECOND = 0x40;
+static const uint8_t STATUS_DIRECTION = 0x80;
+
+static const uint8_t CHANNEL_CODES[8] = {0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87};
+static const uint8_t CHANNEL_READBACK[8] = {0xB8, 0xB1, 0xAA, 0xA3, 0x9C, 0x95, 0x8E, 0x87};
+
+/// Slot timing of the bridge in µs, typical values from the DS2482-100 datasheet.
+struct SimBridgeSpeed {
+  uint32_t reset_low;
+  uint32_t presence_sample;
+  uint32_t reset_high;
+  uint32_t write0_low;
+  uint32_t write1_low;
+  uint32_t sample;
+  uint32_t slot;
+};
+static const SimBridgeSpeed BRIDGE_STANDARD = {560, 68, 584, 64, 8, 14, 70};
+static const SimBridgeSpeed BRIDGE_OVERDRIVE = {70, 9, 74, 8, 1, 2, 11};
+
+SimDS2482::SimDS2482(uint8_t address, std::vector<uint8_t> pins) : address_(address), pins_(std::move(pins)) {}
+
+i2c::ErrorCode SimDS2482::read(uint8_t address, uint8_t *data, size_t len) {
+  host_advance_ns(uint64_t(len + 1) * this->byte_ns);
+  if (address != this->address_)
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  for (size_t i = 0; i < len; i++) {
+    switch (this->pointer_) {
+      case REGISTER_STATUS:
+        data[i] = this->status_;
+        if (this->busy_left_ != 0) {
+          this->busy_left_--;
+          data[i] |= STATUS_BUSY;
+        }
+        break;
+      case REGISTER_DATA:
+        data[i] = this->data_;
+        break;
+      case REGISTER_CHANNEL:
+        data[i] = CHANNEL_READBACK[this->channel_];
+        break;
+      case REGISTER_CONFIG:
+        data[i] = this->config_;
+        break;
+    }
+  }
+  return i2c::ERROR_OK;
+}
+
+i2c::ErrorCode SimDS2482::write(uint8_t address, const uint8_t *data, size_t len) {
+  host_advance_ns(uint64_t(len + 1) * this->byte_ns);
+  if (address != this->address_)
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  if (len == 0)
+    return i2c::ERROR_OK;
+  // unknown commands and invalid parameters aren't acknowledged
+  if (!this->command_(data[0], len > 1 ? data + 1 : nullptr, len - 1))
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  this->commands[data[0]]++;
+  return i2c::ERROR_OK;
+}
+
+bool SimDS2482::command_(uint8_t cmd, const uint8_t *param, size_t len) {
+  bool has_param = cmd == 0xE1 || cmd == 0xD2 || cmd == 0xC3 || cmd == 0x87 || cmd == 0xA5 || cmd == 0x78;
+  if (len != (has_param ? 1u : 0u))
+    return false;
+  bool one_wire = cmd == 0xB4 || cmd == 0x87 || cmd == 0xA5 || cmd == 0x96 || cmd == 0x78;
+  if (one_wire && this->stuck) {
+    this->status_ |= STATUS_BUSY;
+    this->pointer_ = REGISTER_STATUS;
+    return true;
+  }
+  switch (cmd) {
+    case 0xF0:  // device reset
+      this->status_ = STATUS_RESET;
+      this->config_ = 0;
+      this->channel_ = 0;
+      this->pointer_ = REGISTER_STATUS;
+      return true;
+    case 0xE1:  // set read pointer
+      if (*param != REGISTER_STATUS && *param != REGISTER_DATA && *param != REGISTER_CONFIG &&
+          (*param != REGISTER_CHANNEL || this->pins_.size() == 1))
+        return false;
+      this->pointer_ = Register(*param);
+      return true;
+    case 0xD2:  // write configuration, the upper nibble is the complement of the lower one
+      if (uint8_t(~*param >> 4 & 0x0F) != (*param & 0x0F))
+        return false;
+      this->config_ = *param & 0x0F;
+      this->status_ &= ~STATUS_RESET;
+      this->pointer_ = REGISTER_CONFIG;
+      return true;
+    case 0xC3:  // channel select, only on the -800
+      if (this->pins_.size() == 1)
+        return false;
+      for (uint8_t i = 0; i < this->pins_.size(); i++) {
+        if (CHANNEL_CODES[i] == *param) {
+          this->channel_ = i;
+          this->pointer_ = REGISTER_CHANNEL;
+          return true;
+        }
+      }
+      return false;
+    case 0xB4:  // 1-Wire reset
+      this->status_ &= ~STATUS_PRESENCE;
+      if (this->one_wire_reset_())
+        this->status_ |= STATUS_PRESENCE;
+      this->one_wire_command_done_();
+      return true;
+    case 0x87:  // 1-Wire single bit
+      this->status_ &= ~STATUS_SINGLE_BIT;
+      if (this->one_wire_bit_(*param & 0x80))
+        this->status_ |= STATUS_SINGLE_BIT;
+      this->one_wire_command_done_();
+      return true;
+    case 0xA5:  // 1-Wire write byte
+      for (uint8_t i = 0; i < 8; i++)
+        this->one_wire_bit_((*param >> i) & 1);
+      this->one_wire_command_done_();
+      return true;
+    case 0x96:  // 1-Wire read byte
+      this->data_ = 0;
+      for (uint8_t i = 0; i < 8; i++)
+        this->data_ |= uint8_t(this->one_wire_bit_(true)) << i;
+      this->one_wire_command_done_();
+      return true;
+    case 0x78: {  // 1-Wire triplet
+      bool id = this->one_wire_bit_(true);
+      bool complement = this->one_wire_bit_(true);
+      bool direction = id == complement ? (id || (*param & 0x80)) : id;
+      this->one_wire_bit_(direction);
+      this->status_ &= ~(STATUS_SINGLE_BIT | STATUS_TRIPLET_SECOND | STATUS_DIRECTION);
+      if (id)
+        this->status_ |= STATUS_SINGLE_BIT;
+      if (complement)
+        this->status_ |= STATUS_TRIPLET_SECOND;
+      if (direction)
+        this->status_ |= STATUS_DIRECTION;
+      this->one_wire_command_done_();
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+void SimDS2482::one_wire_command_done_() {
+  this->pointer_ = REGISTER_STATUS;
+  this->busy_left_ = this->busy_reads;
+}
+
+void SimDS2482::pull_low_() {
+  auto pin = this->pin_();
+  pin.pin_mode(gpio::FLAG_OUTPUT);
+  pin.digital_write(false);
+}
+
+void SimDS2482::release_() { this->pin_().pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP); }
+
+bool SimDS2482::one_wire_reset_() {
+  auto &speed = this->overdrive_() ? BRIDGE_OVERDRIVE : BRIDGE_STANDARD;
+  this->pull_low_();
+  delayMicroseconds(speed.reset_low);
+  this->release_();
+  delayMicroseconds(speed.presence_sample);
+  bool presence = !this->pin_().digital_read();
+  delayMicroseconds(speed.reset_high - speed.presence_sample);
+  return presence;
+}
+
+bool SimDS2482::one_wire_bit_(bool bit) {
+  auto &speed = this->overdrive_() ? BRIDGE_OVERDRIVE : BRIDGE_STANDARD;
+  this->pull_low_();
+  if (!bit) {
+    delayMicroseconds(speed.write0_low);
+    this->release_();
+    delayMicroseconds(speed.slot - speed.write0_low);
+    return false;
+  }
+  delayMicroseconds(speed.write1_low);
+  this->release_();
+  delayMicroseconds(speed.sample - speed.write1_low);
+  bool level = this->pin_().digital_read();
+  delayMicroseconds(speed.slot - speed.sample);
+  return level;
+}
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "esphome/components/i2c/i2c.h"
+#include "esphome/core/hal.h"
+
+#include <vector>
+
+namespace esphome {
+namespace dallas {
+
+/** A DS2482 on a simulated I2C bus, it drives simulated 1-Wire buses as their master.
+ *
+ * Takes the commands of the datasheet and runs the 1-Wire part on the pins with the
+ * bridge's own slot timing, in virtual time. With one channel it is a DS2482-100,
+ * which doesn't know channel select, with eight a DS2482-800.
+ */
+class SimDS2482 : public i2c::I2CBus {
+ public:
+  /// pins are the 1-Wire buses of the channels, see SimBus::get_pin().
+  SimDS2482(uint8_t address, std::vector<uint8_t> pins);
+
+  i2c::ErrorCode read(uint8_t address, uint8_t *data, size_t len) override;
+  i2c::ErrorCode write(uint8_t address, const uint8_t *data, size_t len) override;
+
+  /// Status reads that report the bridge busy after each 1-Wire command.
+  uint8_t busy_reads{1};
+  /// A bridge whose 1-Wire commands never finish.
+  bool stuck{false};
+  /// Time an I2C byte takes, 9 clocks at 100kHz.
+  uint32_t byte_ns{90000};
+
+  /// Commands by code, e.g. to count the triplets of a search.
+  uint32_t commands[256] = {};
+  uint8_t get_config() const { return this->config_; }
+  uint8_t get_channel() const { return this->channel_; }
+
+ protected:
+  enum Register : uint8_t {
+    REGISTER_STATUS = 0xF0,
+    REGISTER_DATA = 0xE1,
+    REGISTER_CHANNEL = 0xD2,
+    REGISTER_CONFIG = 0xC3,
+  };
+
+  bool command_(uint8_t cmd, const uint8_t *param, size_t len);
+  /// 1-Wire reset, whether there was a presence pulse.
+  bool one_wire_reset_();
+  /// One time slot, returns the level sampled in it.
+  bool one_wire_bit_(bool bit);
+  void one_wire_command_done_();
+  bool overdrive_() const { return this->config_ & 0x08; }
+  ISRInternalGPIOPin pin_() const { return ISRInternalGPIOPin(this->pins_[this->channel_]); }
+  void pull_low_();
+  void release_();
+
+  uint8_t address_;
+  std::vector<uint8_t> pins_;
+  uint8_t status_{0x10};
+  uint8_t data_{0};
+  uint8_t config_{0};
+  uint8_t channel_{0};
+  Register pointer_{REGISTER_STATUS};
+  uint8_t busy_left_{0};
+};
+
+}  // namespace dallas
+}  // namespace esphome
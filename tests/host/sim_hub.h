@@ -0,0 +1,33 @@
+#pragma once
+
+#include "dallas_component.h"
+#include "sim_devices.h"
+
+namespace esphome {
+namespace dallas {
+
+/// A hub on a simulated bus, configured the way the code generator does it.
+struct SimHub {
+  SimHub() {
+    host_app.clear();
+    ESPPreferenceObject::storage().clear();
+    this->hub.set_pin(&this->pin);
+    this->hub.set_update_interval(5000);
+    this->hub.set_alert_update_interval(SCHEDULER_DONT_RUN);
+    host_app.register_component(&this->hub);
+  }
+  ~SimHub() { host_app.clear(); }
+
+  void add(DallasDevice *device, uint64_t address) {
+    device->set_address(address);
+    device->set_parent(&this->hub);
+    this->hub.register_sensor(device);
+  }
+
+  SimBus bus;
+  HostGPIOPin pin{bus.get_pin()};
+  DallasComponent hub;
+};
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,57 @@
+#include "sim_uart.h"
+
+namespace esphome {
+namespace dallas {
+
+void SimUART::write_array(const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    uint8_t echo = this->frame_(data[i]);
+    if (this->rx_connected)
+      this->rx_.push_back(echo);
+  }
+}
+
+bool SimUART::read_array(uint8_t *data, size_t len) {
+  // the echo of a frame is in the FIFO once it was sent, there is nothing to wait for
+  if (this->rx_.size() < len)
+    return false;
+  for (size_t i = 0; i < len; i++) {
+    data[i] = this->rx_.front();
+    this->rx_.pop_front();
+  }
+  return true;
+}
+
+uint8_t SimUART::frame_(uint8_t value) {
+  if (this->baud_rate_ == 9600)
+    this->frames_9600++;
+  if (this->baud_rate_ == 115200)
+    this->frames_115200++;
+  ISRInternalGPIOPin pin(this->pin_);
+  uint64_t bit_ns = 1000000000ULL / this->baud_rate_;
+  uint64_t start = host_now_ns();
+  uint8_t echo = 0;
+  // start bit, 8 data bits LSB first, stop bit
+  for (uint8_t i = 0; i < 10; i++) {
+    bool level = i == 0 ? false : i == 9 ? true : (value >> (i - 1)) & 1;
+    if (level) {
+      pin.pin_mode(gpio::FLAG_INPUT | gpio::FLAG_PULLUP);
+    } else {
+      pin.pin_mode(gpio::FLAG_OUTPUT);
+      pin.digital_write(false);
+    }
+    uint64_t middle = start + i * bit_ns + bit_ns / 2;
+    if (host_now_ns() < middle)
+      host_advance_ns(middle - host_now_ns());
+    bool sampled = pin.digital_read();
+    if (i >= 1 && i <= 8 && sampled)
+      echo |= 1 << (i - 1);
+    uint64_t end = start + (i + 1) * bit_ns;
+    if (host_now_ns() < end)
+      host_advance_ns(end - host_now_ns());
+  }
+  return echo;
+}
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "esphome/components/uart/uart.h"
+#include "esphome/core/hal.h"
+
+#include <deque>
+
+namespace esphome {
+namespace dallas {
+
+/** A UART with TX and RX tied to a simulated 1-Wire bus.
+ *
+ * TX drives the pin open drain, a 0 bit pulls the line low and a 1 bit releases it.
+ * RX samples the line in the middle of each bit, so what the devices do to the line
+ * shows in the echo. Frames go out when written and take their time on the virtual clock.
+ */
+class SimUART : public uart::UARTComponent {
+ public:
+  explicit SimUART(uint8_t pin) : pin_(pin) {}
+
+  void write_array(const uint8_t *data, size_t len) override;
+  bool read_array(uint8_t *data, size_t len) override;
+  int available() override { return this->rx_.size(); }
+  void flush() override {}
+  void load_settings(bool dump_config) override { this->loads++; }
+
+  /// RX not connected to the bus, nothing echoes.
+  bool rx_connected{true};
+  /// Baud rate changes that were applied.
+  uint32_t loads{0};
+  /// Frames sent at each of the two rates the bus master uses.
+  uint32_t frames_9600{0};
+  uint32_t frames_115200{0};
+
+ protected:
+  uint8_t frame_(uint8_t value);
+
+  uint8_t pin_;
+  std::deque<uint8_t> rx_;
+};
+
+}  // namespace dallas
+}  // namespace esphome
@@ -0,0 +1,23 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF GPIO driver, the simulated bus is always open drain with a pull-up.
+
+#include <driver/rmt.h>
+
+typedef enum {
+  GPIO_PULLUP_ONLY,
+  GPIO_PULLDOWN_ONLY,
+  GPIO_PULLUP_PULLDOWN,
+  GPIO_FLOATING,
+} gpio_pull_mode_t;
+
+typedef enum {
+  GPIO_MODE_INPUT,
+  GPIO_MODE_OUTPUT,
+  GPIO_MODE_OUTPUT_OD,
+  GPIO_MODE_INPUT_OUTPUT_OD,
+  GPIO_MODE_INPUT_OUTPUT,
+} gpio_mode_t;
+
+inline esp_err_t gpio_set_pull_mode(gpio_num_t gpio, gpio_pull_mode_t pull) { return ESP_OK; }
+inline esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode) { return ESP_OK; }
@@ -0,0 +1,114 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF RMT driver and the ring buffer it hands captures out with.
+//
+// A transmit channel drives its pin as an open drain output, so a simulated bus on
+// that pin sees the pulses, and a started receive channel on the same pin records
+// the line in 1µs steps until it stays at one level for the idle threshold.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define pdMS_TO_TICKS(ms) (ms)
+
+typedef int esp_err_t;
+typedef uint32_t TickType_t;
+typedef void *RingbufHandle_t;
+static const esp_err_t ESP_OK = 0;
+static const esp_err_t ESP_FAIL = -1;
+
+typedef enum {
+  GPIO_NUM_0 = 0,
+} gpio_num_t;
+
+typedef enum {
+  RMT_CHANNEL_0,
+  RMT_CHANNEL_1,
+  RMT_CHANNEL_2,
+  RMT_CHANNEL_3,
+  RMT_CHANNEL_4,
+  RMT_CHANNEL_5,
+  RMT_CHANNEL_6,
+  RMT_CHANNEL_7,
+  RMT_CHANNEL_MAX,
+} rmt_channel_t;
+
+typedef enum {
+  RMT_MODE_TX,
+  RMT_MODE_RX,
+} rmt_mode_t;
+
+typedef enum {
+  RMT_IDLE_LEVEL_LOW,
+  RMT_IDLE_LEVEL_HIGH,
+} rmt_idle_level_t;
+
+typedef struct {
+  union {
+    struct {
+      uint32_t duration0 : 15;
+      uint32_t level0 : 1;
+      uint32_t duration1 : 15;
+      uint32_t level1 : 1;
+    };
+    uint32_t val;
+  };
+} rmt_item32_t;
+
+typedef struct {
+  bool idle_output_en;
+  rmt_idle_level_t idle_level;
+} rmt_tx_config_t;
+
+typedef struct {
+  uint16_t idle_threshold;
+  uint8_t filter_ticks_thresh;
+  bool filter_en;
+} rmt_rx_config_t;
+
+typedef struct {
+  rmt_mode_t rmt_mode;
+  rmt_channel_t channel;
+  gpio_num_t gpio_num;
+  uint8_t clk_div;
+  uint8_t mem_block_num;
+  rmt_tx_config_t tx_config;
+  rmt_rx_config_t rx_config;
+} rmt_config_t;
+
+inline rmt_config_t RMT_DEFAULT_CONFIG_TX(gpio_num_t gpio, rmt_channel_t channel) {
+  rmt_config_t config{};
+  config.rmt_mode = RMT_MODE_TX;
+  config.channel = channel;
+  config.gpio_num = gpio;
+  config.clk_div = 80;
+  config.mem_block_num = 1;
+  return config;
+}
+
+inline rmt_config_t RMT_DEFAULT_CONFIG_RX(gpio_num_t gpio, rmt_channel_t channel) {
+  rmt_config_t config{};
+  config.rmt_mode = RMT_MODE_RX;
+  config.channel = channel;
+  config.gpio_num = gpio;
+  config.clk_div = 80;
+  config.mem_block_num = 1;
+  config.rx_config.idle_threshold = 12000;
+  return config;
+}
+
+esp_err_t rmt_config(const rmt_config_t *config);
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags);
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel);
+esp_err_t rmt_get_ringbuf_handle(rmt_channel_t channel, RingbufHandle_t *buf_handle);
+esp_err_t rmt_set_rx_idle_thresh(rmt_channel_t channel, uint16_t thresh);
+esp_err_t rmt_rx_start(rmt_channel_t channel, bool rx_idx_rst);
+esp_err_t rmt_rx_stop(rmt_channel_t channel);
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t *rmt_item, int item_num, bool wait_tx_done);
+
+void *xRingbufferReceive(RingbufHandle_t buffer, size_t *item_size, TickType_t ticks_to_wait);
+void vRingbufferReturnItem(RingbufHandle_t buffer, void *item);
+
+/// Hand out items as the next capture of a receive channel instead of what it records.
+void host_rmt_set_capture(rmt_channel_t channel, const std::vector<rmt_item32_t> &items);
@@ -0,0 +1,49 @@
+#pragma once
+
+// Host stand-in for the i2c component, transfers go to a bus the test provides, e.g. a simulated device.
+
+#include <cstddef>
+#include <cstdint>
+
+#define LOG_I2C_DEVICE(this) ESP_LOGCONFIG(TAG, "  Address: 0x%02X", this->get_i2c_address())
+
+namespace esphome {
+namespace i2c {
+
+enum ErrorCode {
+  ERROR_OK = 0,
+  ERROR_INVALID_ARGUMENT = 1,
+  ERROR_NOT_ACKNOWLEDGED = 2,
+  ERROR_TIMEOUT = 3,
+  ERROR_NOT_INITIALIZED = 4,
+  ERROR_TOO_LARGE = 5,
+  ERROR_UNKNOWN = 6,
+};
+
+class I2CBus {
+ public:
+  virtual ~I2CBus() = default;
+  virtual ErrorCode read(uint8_t address, uint8_t *data, size_t len) = 0;
+  virtual ErrorCode write(uint8_t address, const uint8_t *data, size_t len) = 0;
+};
+
+class I2CDevice {
+ public:
+  void set_i2c_address(uint8_t address) { this->address_ = address; }
+  void set_i2c_bus(I2CBus *bus) { this->bus_ = bus; }
+  uint8_t get_i2c_address() const { return this->address_; }
+
+  ErrorCode read(uint8_t *data, size_t len) {
+    return this->bus_ == nullptr ? ERROR_NOT_INITIALIZED : this->bus_->read(this->address_, data, len);
+  }
+  ErrorCode write(const uint8_t *data, size_t len, bool stop = true) {
+    return this->bus_ == nullptr ? ERROR_NOT_INITIALIZED : this->bus_->write(this->address_, data, len);
+  }
+
+ protected:
+  uint8_t address_{0x00};
+  I2CBus *bus_{nullptr};
+};
+
+}  // namespace i2c
+}  // namespace esphome
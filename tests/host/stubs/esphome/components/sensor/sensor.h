@@ -0,0 +1,43 @@
+#pragma once
+
+// Host stand-in for the sensor component, keeps the last state published.
+
+#include "esphome/core/component.h"
+
+#include <cmath>
+#include <string>
+
+#define LOG_SENSOR(prefix, type, obj) \
+  if ((obj) != nullptr) \
+  ESP_LOGCONFIG(TAG, "%s%s '%s'", prefix, type, (obj)->get_name().c_str())
+
+#define SUB_SENSOR(name) \
+ protected: \
+  sensor::Sensor *name##_sensor_{nullptr}; \
+\
+ public: \
+  void set_##name##_sensor(sensor::Sensor *sensor) { this->name##_sensor_ = sensor; }
+
+namespace esphome {
+namespace sensor {
+
+class Sensor {
+ public:
+  virtual ~Sensor() = default;
+  void publish_state(float state) {
+    this->state = state;
+    this->publish_count++;
+  }
+  void set_name(const std::string &name) { this->name_ = name; }
+  const std::string &get_name() const { return this->name_; }
+  virtual std::string unique_id() { return ""; }
+
+  float state{NAN};
+  uint32_t publish_count{0};
+
+ protected:
+  std::string name_;
+};
+
+}  // namespace sensor
+}  // namespace esphome
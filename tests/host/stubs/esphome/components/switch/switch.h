@@ -0,0 +1,36 @@
+#pragma once
+
+// Host stand-in for the switch component, keeps the last state published.
+
+#include "esphome/core/component.h"
+
+#include <string>
+
+namespace esphome {
+namespace switch_ {
+
+class Switch {
+ public:
+  virtual ~Switch() = default;
+  void publish_state(bool state) {
+    this->state = state;
+    this->publish_count++;
+  }
+  /// What the restore mode gives at boot, set by the test.
+  optional<bool> get_initial_state_with_restore_mode() { return this->initial_state; }
+  /// What the frontend calls to switch.
+  void turn_on() { this->write_state(true); }
+  void turn_off() { this->write_state(false); }
+
+  bool state{false};
+  uint32_t publish_count{0};
+  optional<bool> initial_state;
+
+ protected:
+  virtual void write_state(bool state) = 0;
+};
+
+inline void log_switch(const char *tag, const char *prefix, const char *type, Switch *obj) {}
+
+}  // namespace switch_
+}  // namespace esphome
@@ -0,0 +1,48 @@
+#pragma once
+
+// Host stand-in for the uart component, the test provides the UART, e.g. one on a simulated bus.
+
+#include <cstdint>
+#include <cstring>
+
+namespace esphome {
+namespace uart {
+
+class UARTComponent {
+ public:
+  virtual ~UARTComponent() = default;
+  virtual void write_array(const uint8_t *data, size_t len) = 0;
+  virtual bool read_array(uint8_t *data, size_t len) = 0;
+  virtual int available() = 0;
+  /// Wait until everything written went out.
+  virtual void flush() = 0;
+  /// Apply changed settings, like the ESP32 UART.
+  virtual void load_settings(bool dump_config) {}
+  void set_baud_rate(uint32_t baud_rate) { this->baud_rate_ = baud_rate; }
+  uint32_t get_baud_rate() const { return this->baud_rate_; }
+
+ protected:
+  uint32_t baud_rate_{9600};
+};
+
+class UARTDevice {
+ public:
+  UARTDevice() = default;
+  explicit UARTDevice(UARTComponent *parent) : parent_(parent) {}
+
+  void write_array(const uint8_t *data, size_t len) { this->parent_->write_array(data, len); }
+  bool read_array(uint8_t *data, size_t len) { return this->parent_->read_array(data, len); }
+  uint8_t read() {
+    uint8_t data = 0;
+    this->parent_->read_array(&data, 1);
+    return data;
+  }
+  int available() { return this->parent_->available(); }
+  void flush() { this->parent_->flush(); }
+
+ protected:
+  UARTComponent *parent_{nullptr};
+};
+
+}  // namespace uart
+}  // namespace esphome
@@ -0,0 +1,124 @@
+#pragma once
+
+// Host stand-in for esphome/core/component.h. The scheduler runs on the virtual clock,
+// host_app drives the components the way App does on a device.
+
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/optional.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+const uint32_t SCHEDULER_DONT_RUN = 4294967295UL;
+
+namespace setup_priority {
+extern const float BUS;
+extern const float IO;
+extern const float HARDWARE;
+extern const float DATA;
+extern const float PROCESSOR;
+extern const float LATE;
+}  // namespace setup_priority
+
+#define LOG_UPDATE_INTERVAL(this) \
+  ESP_LOGCONFIG(TAG, "  Update Interval: %.1fs", this->get_update_interval() / 1000.0f)
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return setup_priority::DATA; }
+  virtual void call_setup() { this->setup(); }
+  virtual void call_loop() { this->loop(); }
+
+  void status_set_warning(const char *message = nullptr) { this->warning_ = true; }
+  void status_set_error(const char *message = nullptr) { this->error_ = true; }
+  void status_clear_warning() { this->warning_ = false; }
+  void status_clear_error() { this->error_ = false; }
+  bool status_has_warning() const { return this->warning_; }
+  bool status_has_error() const { return this->error_; }
+  void mark_failed() { this->failed_ = true; }
+  bool is_failed() const { return this->failed_; }
+
+ protected:
+  void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f);
+  bool cancel_interval(const std::string &name);
+  void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f);
+  void set_timeout(uint32_t timeout, std::function<void()> &&f);
+  bool cancel_timeout(const std::string &name);
+  void defer(std::function<void()> &&f) { this->set_timeout(0, std::move(f)); }
+  void defer(const std::string &name, std::function<void()> &&f) { this->set_timeout(name, 0, std::move(f)); }
+
+  bool warning_{false};
+  bool error_{false};
+  bool failed_{false};
+};
+
+class PollingComponent : public Component {
+ public:
+  PollingComponent() : PollingComponent(0) {}
+  explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+  virtual void update() = 0;
+  void call_setup() override {
+    this->setup();
+    this->start_poller();
+  }
+  virtual void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+  virtual uint32_t get_update_interval() const { return this->update_interval_; }
+  void start_poller() { this->set_interval("update", this->get_update_interval(), [this]() { this->update(); }); }
+  void stop_poller() { this->cancel_interval("update"); }
+
+ protected:
+  uint32_t update_interval_;
+};
+
+/// Runs the registered components on the virtual clock.
+class HostApplication {
+ public:
+  void register_component(Component *component) { this->components_.push_back(component); }
+  /// Set up the components in priority order, like App.setup().
+  void setup();
+  /// One pass of the main loop: the timers that are due, then every loop(). Sleeps unless a
+  /// component asked for a high frequency loop.
+  void loop();
+  /// Loop for ms of virtual time.
+  void run_for(uint32_t ms);
+  /// Loop until done returns true or max_ms passed, returns done().
+  bool run_until(const std::function<bool()> &done, uint32_t max_ms);
+  /// Drop the components and timers, for the next test.
+  void clear();
+
+  void set_timer(Component *component, const std::string &name, uint32_t ms, bool repeat, std::function<void()> &&f);
+  bool cancel_timer(Component *component, const std::string &name, bool repeat);
+
+  /// Time one loop pass takes when nothing sleeps, in µs.
+  uint32_t loop_overhead_us{20};
+  /// Longest sleep between loop passes, in ms.
+  uint32_t loop_interval_ms{16};
+
+ protected:
+  struct Timer {
+    Component *component;
+    std::string name;
+    uint64_t due_us;
+    uint32_t interval_ms;
+    bool repeat;
+    bool removed;
+    std::function<void()> f;
+  };
+  uint64_t now_us_() const { return host_now_ns() / 1000; }
+
+  std::vector<Component *> components_;
+  std::vector<Timer> timers_;
+};
+
+extern HostApplication host_app;
+
+}  // namespace esphome
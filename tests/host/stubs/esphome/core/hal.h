@@ -0,0 +1,97 @@
+#pragma once
+
+// Host stand-in for the parts of esphome/core/hal.h the bus code uses.
+//
+// The clock is virtual: delays advance it exactly and every micros() call costs
+// a little, so busy-waits end. Pin operations go to whatever is attached to the
+// pin number, e.g. a simulated bus.
+
+#include <cstdint>
+#include <string>
+
+#define IRAM_ATTR
+#define HOT
+
+namespace esphome {
+
+namespace gpio {
+enum Flags : uint8_t {
+  FLAG_NONE = 0x00,
+  FLAG_INPUT = 0x01,
+  FLAG_OUTPUT = 0x02,
+  FLAG_OPEN_DRAIN = 0x04,
+  FLAG_PULLUP = 0x08,
+  FLAG_PULLDOWN = 0x10,
+};
+inline Flags operator|(Flags a, Flags b) { return Flags(uint8_t(a) | uint8_t(b)); }
+}  // namespace gpio
+
+/// Receives the operations on a host pin.
+class HostPinListener {
+ public:
+  virtual ~HostPinListener() = default;
+  virtual void pin_mode(gpio::Flags flags) = 0;
+  virtual void digital_write(bool value) = 0;
+  virtual bool digital_read() = 0;
+};
+
+/// Route the operations on a pin number to listener, nullptr detaches it. Unattached pins read high.
+void host_attach_pin(uint8_t pin, HostPinListener *listener);
+
+class ISRInternalGPIOPin {
+ public:
+  ISRInternalGPIOPin() = default;
+  explicit ISRInternalGPIOPin(uint8_t pin) : pin_(pin) {}
+  void pin_mode(gpio::Flags flags);
+  bool digital_read();
+  void digital_write(bool value);
+
+ protected:
+  uint8_t pin_{0xFF};
+};
+
+class GPIOPin {
+ public:
+  virtual ~GPIOPin() = default;
+  virtual void setup() = 0;
+  virtual void pin_mode(gpio::Flags flags) = 0;
+  virtual bool digital_read() = 0;
+  virtual void digital_write(bool value) = 0;
+  virtual std::string dump_summary() const = 0;
+};
+
+class InternalGPIOPin : public GPIOPin {
+ public:
+  virtual ISRInternalGPIOPin to_isr() const = 0;
+  virtual uint8_t get_pin() const = 0;
+};
+
+/// A GPIO of the host, see host_attach_pin().
+class HostGPIOPin : public InternalGPIOPin {
+ public:
+  explicit HostGPIOPin(uint8_t pin) : pin_(pin) {}
+  void setup() override {}
+  void pin_mode(gpio::Flags flags) override { this->to_isr().pin_mode(flags); }
+  bool digital_read() override { return this->to_isr().digital_read(); }
+  void digital_write(bool value) override { this->to_isr().digital_write(value); }
+  std::string dump_summary() const override;
+  ISRInternalGPIOPin to_isr() const override { return ISRInternalGPIOPin(this->pin_); }
+  uint8_t get_pin() const override { return this->pin_; }
+
+ protected:
+  uint8_t pin_;
+};
+
+uint32_t micros();
+uint32_t millis();
+void delayMicroseconds(uint32_t us);
+void delay(uint32_t ms);
+void yield();
+
+/// Virtual time in ns.
+uint64_t host_now_ns();
+void host_advance_ns(uint64_t ns);
+/// Time a micros() call takes, 250ns by default.
+void host_set_micros_cost_ns(uint32_t ns);
+
+}  // namespace esphome
@@ -0,0 +1,41 @@
+#pragma once
+
+// Host stand-in for the parts of esphome/core/helpers.h the components use.
+
+#include "esphome/core/optional.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace esphome {
+
+uint8_t crc8(uint8_t *data, uint8_t len);
+std::string str_sprintf(const char *fmt, ...);
+std::string format_hex(uint64_t value);
+std::string str_lower_case(const std::string &str);
+uint32_t fnv1_hash(const std::string &str);
+inline std::string to_string(int value) { return std::to_string(value); }
+inline uint32_t encode_uint32(uint8_t byte1, uint8_t byte2, uint8_t byte3, uint8_t byte4) {
+  return (uint32_t(byte1) << 24) | (uint32_t(byte2) << 16) | (uint32_t(byte3) << 8) | byte4;
+}
+
+class InterruptLock {
+ public:
+  InterruptLock() {}
+  ~InterruptLock() {}
+};
+
+/// Counts the requests, the host main loop runs without sleeping while there are any.
+class HighFrequencyLoopRequester {
+ public:
+  void start();
+  void stop();
+  static bool is_high_frequency();
+
+ protected:
+  bool started_{false};
+};
+
+}  // namespace esphome
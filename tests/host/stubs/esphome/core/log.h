@@ -0,0 +1,35 @@
+#pragma once
+
+// Host stand-in for esphome/core/log.h, printed when HOST_LOG is set in the environment.
+
+#include <cstdio>
+
+namespace esphome {
+extern bool host_log_enabled;
+/// Gets every log line, printed or not, e.g. to collect the benchmark lines.
+extern void (*host_log_listener)(const char *tag, const char *message);
+template<typename... Args> inline void host_log(const char *tag, const char *fmt, Args... args) {
+  if (host_log_listener != nullptr) {
+    char message[512];
+    std::snprintf(message, sizeof(message), fmt, args...);
+    host_log_listener(tag, message);
+  }
+  if (!host_log_enabled)
+    return;
+  std::printf("[%s] ", tag);
+  std::printf(fmt, args...);
+  std::printf("\n");
+}
+}  // namespace esphome
+
+#define ESP_LOGE(tag, ...) ::esphome::host_log(tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ::esphome::host_log(tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ::esphome::host_log(tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ::esphome::host_log(tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) ::esphome::host_log(tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) ::esphome::host_log(tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) ::esphome::host_log(tag, __VA_ARGS__)
+#define LOG_PIN(prefix, pin) \
+  if ((pin) != nullptr) \
+  ESP_LOGCONFIG(TAG, prefix "%s", (pin)->dump_summary().c_str())
+#define YESNO(b) ((b) ? "YES" : "NO")
@@ -0,0 +1,57 @@
+#pragma once
+
+// Host stand-in for esphome/core/preferences.h, kept in memory for the life of the process.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace esphome {
+
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() = default;
+  ESPPreferenceObject(uint32_t key, size_t size) : key_(key), size_(size) {}
+
+  template<typename T> bool save(const T *src) {
+    if (this->size_ != sizeof(T))
+      return false;
+    auto &data = storage()[this->key_];
+    data.assign(reinterpret_cast<const uint8_t *>(src), reinterpret_cast<const uint8_t *>(src) + sizeof(T));
+    return true;
+  }
+  template<typename T> bool load(T *dest) {
+    auto it = storage().find(this->key_);
+    if (this->size_ != sizeof(T) || it == storage().end() || it->second.size() != sizeof(T))
+      return false;
+    memcpy(dest, it->second.data(), sizeof(T));
+    return true;
+  }
+
+  /// Everything saved so far, tests clear it to simulate a fresh device.
+  static std::map<uint32_t, std::vector<uint8_t>> &storage() {
+    static std::map<uint32_t, std::vector<uint8_t>> data;
+    return data;
+  }
+
+ protected:
+  uint32_t key_{0};
+  size_t size_{0};
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash) {
+    return ESPPreferenceObject(type, sizeof(T));
+  }
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type) {
+    return ESPPreferenceObject(type, sizeof(T));
+  }
+  bool sync() { return true; }
+};
+
+extern ESPPreferences *global_preferences;
+
+}  // namespace esphome
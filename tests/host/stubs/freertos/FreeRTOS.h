@@ -0,0 +1,15 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS types, tasks run as threads, see host_freertos.cpp.
+
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY ((TickType_t) 0xFFFFFFFF)
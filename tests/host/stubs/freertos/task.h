@@ -0,0 +1,21 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS task API, a task is a thread with a notification counter.
+
+#include "FreeRTOS.h"
+
+struct HostTask;
+typedef HostTask *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+/// The core is ignored, a host thread runs wherever the OS puts it.
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_size, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+/// Sleeps for real, a tick is 1ms.
+void vTaskDelay(TickType_t ticks);
+
+/// Make the next task creation fail, as when the heap is out of memory.
+void host_task_fail_next_create();
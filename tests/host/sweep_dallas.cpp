@@ -0,0 +1,69 @@
+// The on-target timing sweep on simulated buses with different rise times, as JSON lines:
+//   {"rise_ns":2000,"sample":4,"slot":60,"errors":0,"n":10,"bus_us":..}
+//   {"rise_ns":2000,"found":true,"sample":..,"slot":..}
+// The rise time stands for the RC of the pull-up and the cable. A point errs once the
+// master samples a 1 before the line is back up, so the error free sample points start
+// later on slower buses.
+//
+//   sweep_dallas [rise_ns ...]
+
+#include "esp_one_wire.h"
+#include "esphome/core/log.h"
+#include "one_wire_sweep.h"
+#include "sim_devices.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static uint32_t sweep_rise_ns = 0;
+
+static void on_log(const char *tag, const char *message) {
+  if (std::strncmp(message, "sweep {", 7) == 0)
+    std::printf("{\"rise_ns\":%u,%s\n", sweep_rise_ns, message + 7);
+}
+
+/// Sweep a bus with a few devices, the first one is the reference. False if the sweep didn't start.
+static bool sweep(uint32_t rise_ns) {
+  sweep_rise_ns = rise_ns;
+  SimBus bus;
+  bus.set_rise_ns(rise_ns);
+  HostGPIOPin pin(bus.get_pin());
+  ESPOneWire wire(&pin);
+  SimDS18B20 a(sim_rom(0x28, 0xA1B2C3D));
+  SimDS2408 b(sim_rom(0x29, 0x1234AB));
+  SimDS18B20 c(sim_rom(0x28, 0xA1B2C3E));
+  bus.add_device(&a);
+  bus.add_device(&b);
+  bus.add_device(&c);
+
+  OneWireTimingSweep sweep;
+  if (!sweep.start(&wire, a.get_rom()))
+    return false;
+  while (sweep.step()) {
+  }
+  if (sweep.found()) {
+    std::printf("{\"rise_ns\":%u,\"found\":true,\"sample\":%u,\"slot\":%u}\n", rise_ns, sweep.get_best().read_sample,
+                sweep.get_best().slot);
+  } else {
+    std::printf("{\"rise_ns\":%u,\"found\":false}\n", rise_ns);
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  std::vector<uint32_t> rises;
+  for (int i = 1; i < argc; i++)
+    rises.push_back(std::strtoul(argv[i], nullptr, 10));
+  if (rises.empty())
+    rises = {200, 500, 1000, 2000, 4000, 6000, 8000, 10000};
+  host_log_listener = on_log;
+  int failures = 0;
+  for (auto rise_ns : rises)
+    failures += !sweep(rise_ns);
+  return failures;
+}
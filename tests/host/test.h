@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the host tests, a test binary returns the number of failed checks.
+
+static int test_failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      test_failures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    auto check_a = (a); \
+    auto check_b = (b); \
+    if ((unsigned long long) check_a != (unsigned long long) check_b) { \
+      std::printf("%s:%d: CHECK_EQ(%s, %s) failed: 0x%llx != 0x%llx\n", __FILE__, __LINE__, #a, #b, \
+                  (unsigned long long) check_a, (unsigned long long) check_b); \
+      test_failures++; \
+    } \
+  } while (0)
@@ -0,0 +1,238 @@
+#include "esp_one_wire.h"
+#include "esp_one_wire_async.h"
+#include "sim_devices.h"
+#include "test.h"
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static const uint64_t DS18B20 = sim_rom(0x28, 0xA1B2C3D);
+static const uint64_t DS2408 = sim_rom(0x29, 0x1234AB);
+static const uint64_t DS2413 = sim_rom(0x3A, 0x11223A);
+
+struct SimWire {
+  SimBus bus;
+  HostGPIOPin pin{bus.get_pin()};
+  ESPOneWire wire{&pin};
+};
+
+static void test_presence() {
+  SimWire sim;
+  CHECK(!sim.wire.reset());
+  CHECK_EQ(sim.wire.get_stats().presence_failures, 1);
+
+  SimRecorder a(DS18B20);
+  sim.bus.add_device(&a);
+  uint32_t falls = sim.bus.falls;
+  uint64_t start = host_now_ns();
+  CHECK(sim.wire.reset());
+  uint64_t took_us = (host_now_ns() - start) / 1000;
+  CHECK(took_us >= 480 + 70 + 410);
+  CHECK(took_us < 1100);
+  CHECK_EQ(a.resets, 1);
+  CHECK_EQ(sim.bus.falls - falls, 1);
+}
+
+static void test_slots() {
+  SimWire sim;
+  SimRecorder a(DS18B20);
+  sim.bus.add_device(&a);
+  a.responses = {0x3C, 0x81};
+
+  CHECK(sim.wire.reset());
+  uint64_t start = host_now_ns();
+  sim.wire.skip();
+  sim.wire.write8(0x5A);
+  CHECK_EQ(sim.wire.read8(), 0x3C);
+  CHECK_EQ(sim.wire.read8(), 0x81);
+  // pacing holds every slot to at least 60µs
+  CHECK(host_now_ns() - start >= 31 * 60000ULL);
+  CHECK_EQ(a.selects, 1);
+  CHECK_EQ(a.received.size(), 1);
+  CHECK_EQ(a.received[0], 0x5A);
+  CHECK_EQ(sim.bus.falls, 1 + 32);
+  CHECK_EQ(sim.bus.early_falls, 0);
+  CHECK_EQ(sim.bus.contentions, 0);
+  CHECK_EQ(a.missed_slots, 0);
+  CHECK_EQ(sim.wire.get_stats().slots, 32);
+}
+
+static void test_read_rom() {
+  SimWire sim;
+  SimDS2408 a(DS2408);
+  sim.bus.add_device(&a);
+  CHECK(sim.wire.reset());
+  CHECK_EQ(sim.wire.read_rom(), a.get_rom());
+}
+
+static void test_slow_rise() {
+  SimWire sim;
+  SimDS2408 a(DS2408);
+  sim.bus.add_device(&a);
+  // a long bus with a weak pull-up, the 1s haven't risen at the sample point yet
+  sim.bus.set_rise_ns(14000);
+  CHECK(sim.wire.reset());
+  // every 1 still reads as 0
+  CHECK_EQ(sim.wire.read_rom(), 0);
+  // too slow for any sample point within the 15µs a device holds a 0 valid
+  CHECK(!sim.wire.calibrate());
+}
+
+static void test_calibrate() {
+  SimWire sim;
+  SimDS2408 a(DS2408);
+  sim.bus.add_device(&a);
+  sim.bus.set_rise_ns(5000);
+  CHECK(sim.wire.calibrate());
+  // sampled after the rise, well before the end of the window
+  CHECK(sim.wire.get_timing().read_sample >= 3 + 5);
+  CHECK(sim.wire.get_timing().read_sample < 14);
+  CHECK(sim.wire.reset());
+  CHECK_EQ(sim.wire.read_rom(), a.get_rom());
+}
+
+static void test_contention() {
+  SimWire sim;
+  SimRecorder a(DS18B20);
+  sim.bus.add_device(&a);
+  a.responses = {0x00};
+
+  // the master writes 1s while the device answers with 0s, it drives the line high against the device
+  CHECK(sim.wire.reset());
+  sim.wire.skip();
+  sim.wire.write8(0x01);
+  sim.wire.write8(0xFF);
+  CHECK(sim.bus.contentions >= 8);
+}
+
+static void test_overdrive() {
+  SimWire sim;
+  SimDS2413 a(DS2413);
+  SimDS18B20 b(DS18B20);
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+  // the master samples 1-2µs into an overdrive slot, depending on where micros() ticks over,
+  // which needs a strong pull-up on a short bus
+  sim.bus.set_rise_ns(200);
+
+  CHECK(sim.wire.reset());
+  sim.wire.select_overdrive(DS2413);
+  CHECK(sim.wire.is_overdrive());
+  sim.wire.write8(0xF5);
+  CHECK_EQ(sim.wire.read8(), a.status());
+  sim.bus.idle(10);
+  CHECK(a.is_overdrive());
+  CHECK(!b.is_overdrive());
+  CHECK_EQ(sim.bus.early_falls, 0);
+  CHECK_EQ(a.missed_slots, 0);
+
+  // the standard speed device doesn't see the short reset
+  uint32_t b_resets = b.resets;
+  CHECK(sim.wire.reset_overdrive());
+  CHECK_EQ(b.resets, b_resets);
+  sim.wire.select(DS2413);
+  sim.wire.write8(0xF5);
+  CHECK_EQ(sim.wire.read8(), a.status());
+
+  // a standard reset returns it to standard speed
+  CHECK(sim.wire.reset());
+  CHECK(!a.is_overdrive());
+  CHECK_EQ(b.resets, b_resets + 1);
+}
+
+static void test_resume() {
+  SimWire sim;
+  SimDS2408 a(DS2408);
+  SimDS2413 b(DS2413);
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+
+  for (uint8_t i = 0; i < 3; i++) {
+    CHECK(sim.wire.reset());
+    uint32_t falls = sim.bus.falls;
+    sim.wire.select(DS2408);
+    sim.wire.write8(0xF5);
+    CHECK_EQ(sim.wire.read8(), a.pio());
+    // Match ROM the first time, then Resume ROM
+    CHECK_EQ(sim.bus.falls - falls, i == 0 ? 8 + 64 + 16 : 8 + 16);
+  }
+  CHECK_EQ(a.selects, 3);
+  CHECK_EQ(b.selects, 0);
+}
+
+static void test_alarm_search() {
+  SimWire sim;
+  SimDS18B20 a(DS18B20);
+  SimDS2408 b(DS2408);
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+  // the power-up 85°C is above the 75°C alarm, the DS2408 has no search condition
+  sim.wire.reset_search();
+  CHECK(sim.wire.reset());
+  CHECK_EQ(sim.wire.active_search(), DS18B20);
+  CHECK(sim.wire.reset());
+  CHECK_EQ(sim.wire.active_search(), 0);
+}
+
+static void test_search_lock_time() {
+  SimWire sim;
+  SimDS18B20 a(DS18B20);
+  SimDS2408 b(DS2408);
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+  sim.wire.set_max_lock_us(1000);
+  sim.wire.reset_search();
+  CHECK(sim.wire.reset());
+  CHECK(sim.wire.search() != 0);
+  // 64 triplets and the command take 12ms, interrupts ran within every millisecond
+  CHECK(sim.wire.get_stats().max_locked_us <= 1000);
+
+  // without a limit the whole search holds them off
+  sim.wire.set_max_lock_us(0);
+  sim.wire.reset_stats();
+  CHECK(sim.wire.reset());
+  CHECK(sim.wire.search() != 0);
+  CHECK(sim.wire.get_stats().max_locked_us > 10000);
+}
+
+static void test_async_after_overdrive() {
+  SimWire sim;
+  SimDS2413 a(DS2413);
+  sim.bus.add_device(&a);
+  sim.bus.set_rise_ns(200);
+  CHECK(sim.wire.reset());
+  sim.wire.select_overdrive(DS2413);
+  CHECK(a.is_overdrive());
+
+  // the reset of the transaction is a standard speed one and returns the device to standard speed
+  ESPOneWireAsync async(&sim.wire);
+  bool done = false;
+  bool present = false;
+  std::vector<uint8_t> data;
+  CHECK(async.start({ONE_WIRE_ROM_SKIP, 0xF5}, 1, [&](bool p, const std::vector<uint8_t> &d) {
+    done = true;
+    present = p;
+    data = d;
+  }));
+  async.finish();
+  CHECK(done && present);
+  CHECK(!sim.wire.is_overdrive());
+  CHECK(!a.is_overdrive());
+  CHECK_EQ(data.size(), 1);
+  CHECK_EQ(data[0], a.status());
+}
+
+int main() {
+  test_presence();
+  test_slots();
+  test_read_rom();
+  test_slow_rise();
+  test_calibrate();
+  test_contention();
+  test_overdrive();
+  test_resume();
+  test_alarm_search();
+  test_search_lock_time();
+  test_async_after_overdrive();
+  return test_failures;
+}
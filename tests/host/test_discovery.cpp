@@ -0,0 +1,234 @@
+#include "../../components/ds1820/ds1820.h"
+#include "../../components/ds2438/ds2438.h"
+#include "sim_hub.h"
+#include "test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <map>
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static const uint64_t DS18B20 = sim_rom(0x28, 0xA1B2C3D);
+static const uint64_t DS18B20_B = sim_rom(0x28, 0xA1B2C3E);
+static const uint64_t DS2408 = sim_rom(0x29, 0x1234AB);
+static const uint64_t DS2438 = sim_rom(0x26, 0x765432);
+static const uint64_t DS2438_B = sim_rom(0x26, 0x765433);
+
+/// A hub that records how long its loop() calls take.
+class TimedHub : public DallasComponent {
+ public:
+  void loop() override {
+    uint64_t start = host_now_ns();
+    DallasComponent::loop();
+    uint64_t took = host_now_ns() - start;
+    this->total_ns += took;
+    this->max_ns = std::max(this->max_ns, took);
+  }
+
+  uint64_t total_ns{0};
+  uint64_t max_ns{0};
+};
+
+struct Discovery {
+  /// Loop time of the whole discovery and of the longest loop() call, in µs.
+  uint64_t total_us;
+  uint64_t max_tick_us;
+  size_t attached;
+};
+
+static Discovery discover(size_t count) {
+  host_app.clear();
+  ESPPreferenceObject::storage().clear();
+  SimBus bus;
+  HostGPIOPin pin(bus.get_pin());
+  TimedHub hub;
+  hub.set_pin(&pin);
+  hub.set_update_interval(SCHEDULER_DONT_RUN);
+  hub.set_alert_update_interval(SCHEDULER_DONT_RUN);
+  host_app.register_component(&hub);
+
+  std::deque<SimDS18B20> devices;
+  std::deque<DallasTemperatureSensor> sensors;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t rom = sim_rom(0x28, 0x200000 + i * 104729);
+    devices.emplace_back(rom);
+    bus.add_device(&devices.back());
+    sensors.emplace_back();
+    sensors.back().set_resolution(12);
+    sensors.back().set_address(rom);
+    sensors.back().set_parent(&hub);
+    hub.register_sensor(&sensors.back());
+  }
+
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return hub.is_discovery_done(); }, 60000));
+  Discovery result{hub.total_ns / 1000, hub.max_ns / 1000, 0};
+  for (auto &sensor : sensors)
+    result.attached += sensor.is_attached();
+  host_app.clear();
+  return result;
+}
+
+static void test_discovery_scales() {
+  // past the 21 devices the search used to stop at
+  Discovery small = discover(10);
+  Discovery medium = discover(40);
+  Discovery large = discover(120);
+  CHECK_EQ(small.attached, 10);
+  CHECK_EQ(medium.attached, 40);
+  CHECK_EQ(large.attached, 120);
+
+  // the time per device stays flat, the fixed cost of a discovery is spread over more devices
+  uint64_t small_per_device = small.total_us / 10;
+  uint64_t medium_per_device = medium.total_us / 40;
+  uint64_t large_per_device = large.total_us / 120;
+  CHECK(medium_per_device <= small_per_device);
+  CHECK(large_per_device <= medium_per_device);
+  CHECK(large_per_device * 10 >= medium_per_device * 9);
+
+  // one device per loop() call, however many there are
+  CHECK(large.max_tick_us <= small.max_tick_us + small.max_tick_us / 10);
+  CHECK(large.max_tick_us < 50000);
+}
+
+/// A DS2438 on a hub, updated by hand.
+struct BatteryDevice {
+  BatteryDevice(SimHub &sim, uint64_t address) {
+    this->component.set_update_interval(SCHEDULER_DONT_RUN);
+    this->component.set_vcc_sensor(&this->vcc);
+    sim.add(&this->component, address);
+    host_app.register_component(&this->component);
+  }
+
+  /// Read the voltage, false if it wasn't published.
+  bool read() {
+    uint32_t count = this->vcc.publish_count;
+    this->component.update();
+    return host_app.run_until([&]() { return this->vcc.publish_count > count; }, 1000);
+  }
+
+  DS2438Component component;
+  sensor::Sensor vcc;
+};
+
+static void test_single_device() {
+  // the search by family found one device and a search of the whole bus no other, Skip ROM addresses it
+  SimHub sim;
+  SimDS2438 a(DS2438);
+  sim.bus.add_device(&a);
+  BatteryDevice device(sim, DS2438);
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return sim.hub.is_discovery_done(); }, 1000));
+  uint32_t selects = a.selects;
+  uint32_t addressed = a.addressed_selects;
+  CHECK(device.read());
+  CHECK(a.selects > selects);
+  CHECK_EQ(a.addressed_selects, addressed);
+}
+
+static void test_single_device_missing() {
+  // one device found, but another configured one may still show up
+  SimHub sim;
+  SimDS2438 a(DS2438);
+  a.vdd = 4.5f;
+  sim.bus.add_device(&a);
+  BatteryDevice device(sim, DS2438);
+  BatteryDevice missing(sim, DS2438_B);
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return sim.hub.is_discovery_done(); }, 1000));
+  uint32_t addressed = a.addressed_selects;
+  CHECK(device.read());
+  CHECK(a.addressed_selects > addressed);
+
+  // it does, and doesn't answer for the other one
+  SimDS2438 b(DS2438_B);
+  b.vdd = 3.0f;
+  sim.bus.add_device(&b);
+  CHECK(device.read());
+  CHECK(std::fabs(device.vcc.state - 4.5f) < 0.02f);
+  CHECK_EQ(device.component.get_stats().crc_failures, 0);
+}
+
+static void test_filtered_search() {
+  // the search only looked for temperature sensors, the DS2408 next to the only one wasn't counted
+  SimHub sim;
+  SimDS18B20 a(DS18B20);
+  SimDS2408 other(DS2408);
+  a.temperature = 24.5f;
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&other);
+  DallasTemperatureSensor sensor;
+  sensor.set_resolution(12);
+  sim.add(&sensor, DS18B20);
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return sim.hub.is_discovery_done(); }, 1000));
+  uint32_t addressed = a.addressed_selects;
+  CHECK(host_app.run_until([&]() { return sensor.publish_count > 0; }, 10000));
+  CHECK(sensor.state == 24.5f);
+  CHECK(a.addressed_selects > addressed);
+  CHECK_EQ(sensor.get_stats().crc_failures, 0);
+
+  // with a second sensor configured but missing, neither kind of search may use Skip ROM
+  SimHub sim2;
+  SimDS18B20 b(DS18B20);
+  sim2.bus.add_device(&b);
+  DallasTemperatureSensor present, absent;
+  present.set_resolution(12);
+  absent.set_resolution(12);
+  sim2.add(&present, DS18B20);
+  sim2.add(&absent, DS18B20_B);
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return sim2.hub.is_discovery_done(); }, 1000));
+  addressed = b.addressed_selects;
+  CHECK(host_app.run_until([&]() { return present.publish_count > 0; }, 10000));
+  CHECK(b.addressed_selects > addressed);
+}
+
+static void test_single_cached_device() {
+  // the first boot searches and caches the only device
+  std::map<uint32_t, std::vector<uint8_t>> saved;
+  {
+    SimHub sim;
+    sim.hub.set_rom_cache(true);
+    SimDS2438 a(DS2438);
+    sim.bus.add_device(&a);
+    BatteryDevice device(sim, DS2438);
+    host_app.setup();
+    CHECK(host_app.run_until([&]() { return sim.hub.is_discovery_done(); }, 1000));
+    saved = ESPPreferenceObject::storage();
+  }
+  CHECK(!saved.empty());
+
+  // the next boot only verifies the cache and can't know of the device that was added since
+  SimHub sim;
+  ESPPreferenceObject::storage() = saved;
+  sim.hub.set_rom_cache(true);
+  SimDS2438 a(DS2438);
+  SimDS2438 b(DS2438_B);
+  a.vdd = 4.5f;
+  b.vdd = 3.0f;
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+  BatteryDevice device(sim, DS2438);
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return sim.hub.is_discovery_done(); }, 1000));
+  // the one search that verified the cache, none of the whole bus
+  CHECK_EQ(a.searches, 1);
+  uint32_t addressed = a.addressed_selects;
+  CHECK(device.read());
+  CHECK(a.addressed_selects > addressed);
+  CHECK(std::fabs(device.vcc.state - 4.5f) < 0.02f);
+  CHECK_EQ(device.component.get_stats().crc_failures, 0);
+}
+
+int main() {
+  test_single_device();
+  test_single_device_missing();
+  test_filtered_search();
+  test_single_cached_device();
+  test_discovery_scales();
+  return test_failures;
+}
@@ -0,0 +1,271 @@
+#include "dallas_component.h"
+#include "../../components/ds1820/ds1820.h"
+#include "../../components/ds2405/ds2405.h"
+#include "../../components/ds2408/ds2408.h"
+#include "../../components/ds2409/ds2409.h"
+#include "../../components/ds2413/ds2413.h"
+#include "../../components/ds2423/ds2423.h"
+#include "../../components/ds2438/ds2438.h"
+#include "sim_hub.h"
+#include "test.h"
+
+#include <cmath>
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static const uint64_t DS18B20 = sim_rom(0x28, 0xA1B2C3D);
+static const uint64_t DS18B20_B = sim_rom(0x28, 0xA1B2C3E);
+static const uint64_t DS18S20 = sim_rom(0x10, 0xA1B2C3F);
+static const uint64_t DS2405 = sim_rom(0x05, 0x1234);
+static const uint64_t DS2408 = sim_rom(0x29, 0x1234AB);
+static const uint64_t DS2409 = sim_rom(0x1F, 0xAB09);
+static const uint64_t DS2413 = sim_rom(0x3A, 0x11223A);
+static const uint64_t DS2423 = sim_rom(0x1D, 0xABCD);
+static const uint64_t DS2438 = sim_rom(0x26, 0x765432);
+
+static bool near(float a, float b, float tolerance = 0.01f) { return std::fabs(a - b) <= tolerance; }
+
+static void test_ds18b20() {
+  SimHub sim;
+  SimDS18B20 a(DS18B20);
+  SimDS18B20 b(DS18B20_B);
+  a.temperature = 23.3f;
+  b.temperature = -10.125f;
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+  DallasTemperatureSensor sa, sb;
+  sa.set_resolution(12);
+  sb.set_resolution(10);
+  sim.add(&sa, DS18B20);
+  sim.add(&sb, DS18B20_B);
+
+  host_app.setup();
+  // discovery runs from loop()
+  CHECK(host_app.run_until([&]() { return sa.is_attached() && sb.is_attached(); }, 1000));
+  // only the one with another resolution was written, and copied to EEPROM
+  CHECK_EQ(a.eeprom_writes, 0);
+  CHECK_EQ(b.eeprom_writes, 1);
+  CHECK_EQ(b.get_config(), 0x3F);
+
+  CHECK(host_app.run_until([&]() { return sa.publish_count > 0 && sb.publish_count > 0; }, 10000));
+  CHECK(near(sa.state, 23.3125f));
+  // 0.25°C steps at 10 bits
+  CHECK(near(sb.state, -10.25f));
+  CHECK_EQ(sa.get_stats().crc_failures, 0);
+  CHECK(!sim.hub.status_has_warning());
+
+  // the next update publishes a new value
+  a.temperature = 30.0f;
+  CHECK(host_app.run_until([&]() { return sa.publish_count > 1; }, 10000));
+  CHECK(near(sa.state, 30.0f));
+}
+
+static void test_ds18s20() {
+  SimHub sim;
+  SimDS18B20 a(DS18S20);
+  a.temperature = 21.75f;
+  sim.bus.add_device(&a);
+  DallasTemperatureSensor s;
+  s.set_resolution(12);
+  sim.add(&s, DS18S20);
+
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return s.publish_count > 0; }, 10000));
+  // the count registers give the full resolution
+  CHECK(near(s.state, 21.75f, 1.0f / 16));
+  CHECK_EQ(a.eeprom_writes, 0);
+}
+
+static void test_ds2405() {
+  SimHub sim;
+  SimDS2405 a(DS2405);
+  sim.bus.add_device(&a);
+  DS2405Switch s;
+  sim.add(&s, DS2405);
+
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return s.is_attached(); }, 1000));
+  // the switch state is the PIO level, on while the output transistor is off
+  CHECK(!a.pio_on);
+  s.turn_off();
+  host_app.run_for(100);
+  CHECK(a.pio_on);
+  s.turn_on();
+  host_app.run_for(100);
+  CHECK(!a.pio_on);
+  // the discovery search and the one at setup, then each Match ROM toggles it;
+  // it must never be addressed with Skip ROM
+  CHECK_EQ(a.selects, 2 + 2);
+}
+
+static void test_ds2408() {
+  SimHub sim;
+  SimDS2408 a(DS2408);
+  a.set_inputs(0xF0);
+  sim.bus.add_device(&a);
+  DS2408Component c;
+  c.set_update_interval(1000);
+  sim.add(&c, DS2408);
+  host_app.register_component(&c);
+  DS2408GPIOPin out, in;
+  out.set_parent(&c);
+  out.set_pin(0);
+  out.set_inverted(false);
+  out.set_flags(gpio::FLAG_OUTPUT);
+  in.set_parent(&c);
+  in.set_pin(7);
+  in.set_inverted(false);
+  in.set_flags(gpio::FLAG_INPUT);
+
+  host_app.setup();
+  out.setup();
+  in.setup();
+  CHECK(host_app.run_until([&]() { return c.is_attached(); }, 1000));
+  // inputs go into the conditional search register
+  CHECK_EQ(a.search_mask, 0x80);
+
+  out.digital_write(false);
+  host_app.run_for(100);
+  CHECK_EQ(a.latch, 0xFE);
+  out.digital_write(true);
+  host_app.run_for(100);
+  CHECK_EQ(a.latch, 0xFF);
+
+  CHECK(in.digital_read());
+  a.set_inputs(0x70);
+  host_app.run_for(1100);
+  CHECK(!in.digital_read());
+  CHECK_EQ(c.get_stats().crc_failures, 0);
+}
+
+static void test_ds2413() {
+  SimHub sim;
+  SimDS2413 a(DS2413);
+  sim.bus.add_device(&a);
+  DS2413Component c;
+  c.set_update_interval(1000);
+  sim.add(&c, DS2413);
+  host_app.register_component(&c);
+  DS2413Switch sa, sb;
+  sa.set_parent(&c);
+  sa.set_pin(0);
+  sb.set_parent(&c);
+  sb.set_pin(1);
+
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return c.is_attached(); }, 1000));
+  sb.turn_off();
+  host_app.run_for(100);
+  CHECK_EQ(a.latch, 0x01);
+  sa.turn_off();
+  sb.turn_on();
+  host_app.run_for(100);
+  CHECK_EQ(a.latch, 0x02);
+  CHECK_EQ(c.get_stats().crc_failures, 0);
+}
+
+static void test_ds2409() {
+  SimHub sim;
+  SimDS2409 coupler(DS2409);
+  SimDS18B20 a(DS18B20);
+  SimDS18B20 b(DS18B20_B);
+  a.temperature = 12.5f;
+  b.temperature = 14.0f;
+  sim.bus.add_device(&coupler);
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+  coupler.add_main(&a);
+  coupler.add_aux(&b);
+
+  DS2409Component c;
+  c.set_update_interval(5000);
+  sim.add(&c, DS2409);
+  host_app.register_component(&c);
+  DallasTemperatureSensor sa, sb;
+  sa.set_resolution(12);
+  sb.set_resolution(12);
+  sa.set_address(DS18B20);
+  sa.set_parent(c.get_network(true));
+  c.get_network(true)->register_sensor(&sa);
+  sb.set_address(DS18B20_B);
+  sb.set_parent(c.get_network(false));
+  c.get_network(false)->register_sensor(&sb);
+
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return c.is_attached(); }, 1000));
+  // the branches are searched from loop(), one search pass at a time, then switched off
+  CHECK(host_app.run_until([&]() { return sa.is_attached() && sb.is_attached(); }, 5000));
+  CHECK(host_app.run_until([&]() { return !coupler.main_on() && !coupler.aux_on(); }, 1000));
+
+  CHECK(host_app.run_until([&]() { return sa.publish_count > 0 && sb.publish_count > 0; }, 15000));
+  CHECK(near(sa.state, 12.5f));
+  CHECK(near(sb.state, 14.0f));
+
+  c.turn_on();
+  host_app.run_for(100);
+  CHECK(coupler.control);
+}
+
+static void test_ds2423() {
+  SimHub sim;
+  SimDS2423 a(DS2423);
+  a.counters[0] = 12345;
+  a.counters[3] = 0x01020304;
+  sim.bus.add_device(&a);
+  DallasCounterComponent c;
+  c.set_update_interval(1000);
+  sensor::Sensor counter_a, counter_d;
+  c.set_counter_a_sensor(&counter_a);
+  c.set_counter_d_sensor(&counter_d);
+  sim.add(&c, DS2423);
+  host_app.register_component(&c);
+
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return counter_a.publish_count > 0 && counter_d.publish_count > 0; }, 5000));
+  CHECK_EQ(counter_a.state, 12345);
+  CHECK_EQ(counter_d.state, 0x01020304);
+  CHECK_EQ(c.get_stats().crc_failures, 0);
+}
+
+static void test_ds2438() {
+  SimHub sim;
+  SimDS2438 a(DS2438);
+  a.temperature = 24.5f;
+  a.vdd = 4.98f;
+  a.vad = 1.23f;
+  a.current = -410;
+  sim.bus.add_device(&a);
+  DS2438Component c;
+  c.set_update_interval(1000);
+  c.set_current_resistor(0.05f);
+  c.set_current_threshold(ZeroBits);
+  sensor::Sensor temp, vcc, vad, current;
+  c.set_temp_sensor(&temp);
+  c.set_vcc_sensor(&vcc);
+  c.set_vad_sensor(&vad);
+  c.set_current_sensor(&current);
+  sim.add(&c, DS2438);
+  host_app.register_component(&c);
+
+  host_app.setup();
+  CHECK(host_app.run_until(
+      [&]() { return temp.publish_count > 0 && vcc.publish_count > 0 && vad.publish_count > 0; }, 10000));
+  CHECK(near(temp.state, 24.5f));
+  CHECK(near(vcc.state, 4.98f));
+  CHECK(near(vad.state, 1.23f));
+  CHECK(near(current.state, -410 / 4096.0f / 0.05f));
+  CHECK_EQ(c.get_stats().crc_failures, 0);
+}
+
+int main() {
+  test_ds18b20();
+  test_ds18s20();
+  test_ds2405();
+  test_ds2408();
+  test_ds2413();
+  test_ds2409();
+  test_ds2423();
+  test_ds2438();
+  return test_failures;
+}
@@ -0,0 +1,239 @@
+#include "../../components/ds1820/ds1820.h"
+#include "../../components/ds2482/ds2482.h"
+#include "sim_ds2482.h"
+#include "sim_hub.h"
+#include "test.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static const uint64_t DS18B20 = sim_rom(0x28, 0xA1B2C3D);
+static const uint64_t DS18B20_B = sim_rom(0x28, 0xA1B2C3E);
+static const uint64_t RECORDER = sim_rom(0x29, 0x1234AB);
+
+static bool near(float a, float b, float tolerance = 0.01f) { return std::fabs(a - b) <= tolerance; }
+
+/// A DS2482-100 with a simulated bus on its channel, set up.
+struct SimBridge {
+  SimBridge() {
+    host_app.clear();
+    ESPPreferenceObject::storage().clear();
+    this->ds2482.set_i2c_bus(&this->i2c);
+    this->ds2482.set_i2c_address(0x18);
+    this->wire = this->ds2482.get_channel(0);
+    this->ds2482.setup();
+  }
+  ~SimBridge() { host_app.clear(); }
+
+  SimBus bus;
+  SimDS2482 i2c{0x18, {bus.get_pin()}};
+  DS2482Component ds2482;
+  ESPOneWire *wire;
+};
+
+static void test_setup() {
+  SimBridge sim;
+  CHECK(!sim.ds2482.is_failed());
+  CHECK(!sim.wire->is_bit_banged());
+  // device reset, then the active pullup
+  CHECK_EQ(sim.i2c.commands[0xF0], 1);
+  CHECK_EQ(sim.i2c.get_config(), 0x01);
+
+  // nothing answers at another address
+  DS2482Component other;
+  other.set_i2c_bus(&sim.i2c);
+  other.set_i2c_address(0x19);
+  other.setup();
+  CHECK(other.is_failed());
+  CHECK(!other.get_channel(0)->reset());
+}
+
+static void test_transfers() {
+  SimBridge sim;
+  CHECK(!sim.wire->reset());
+  CHECK_EQ(sim.wire->get_stats().presence_failures, 1);
+
+  SimRecorder a(RECORDER);
+  a.listen = 2;
+  a.responses = {0x5A, 0xC3};
+  sim.bus.add_device(&a);
+  CHECK(sim.wire->reset());
+  CHECK_EQ(a.resets, 1);
+  sim.wire->select(RECORDER);
+  sim.wire->write8(0xF0);
+  sim.wire->write8(0x12);
+  CHECK_EQ(sim.wire->read8(), 0x5A);
+  // the low bit of the next response
+  CHECK(sim.wire->read_bit());
+  sim.bus.idle(100);
+  CHECK_EQ(a.received.size(), 2);
+  CHECK_EQ(a.received[1], 0x12);
+  CHECK_EQ(a.missed_slots, 0);
+
+  // each 1-Wire command was polled until the bridge was idle
+  CHECK_EQ(sim.i2c.commands[0x96], 1);
+  CHECK_EQ(sim.i2c.commands[0x87], 1);
+  auto &stats = sim.wire->get_stats();
+  // Match ROM, two bytes written, one read and a bit
+  CHECK_EQ(stats.slots, 8 + 64 + 8 + 8 + 8 + 1);
+  // the I2C transfers take longer than the slots
+  CHECK(stats.bus_us > 85 * 70);
+}
+
+static void test_search() {
+  SimBridge sim;
+  SimDS18B20 a(DS18B20);
+  SimDS18B20 b(DS18B20_B);
+  SimRecorder c(RECORDER);
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+  sim.bus.add_device(&c);
+
+  auto found = sim.wire->search_vec();
+  CHECK_EQ(found.size(), 3);
+  for (auto rom : {DS18B20, DS18B20_B, RECORDER})
+    CHECK(std::find(found.begin(), found.end(), rom) != found.end());
+  // one triplet command per ROM bit and device, no single bits
+  CHECK_EQ(sim.i2c.commands[0x78], 3 * 64);
+  CHECK_EQ(sim.i2c.commands[0x87], 0);
+}
+
+static void test_overdrive() {
+  SimBridge sim;
+  SimRecorder a(RECORDER);
+  sim.bus.add_device(&a);
+
+  CHECK(sim.wire->reset());
+  sim.wire->skip_overdrive();
+  CHECK(sim.wire->is_overdrive());
+  CHECK(a.is_overdrive());
+  // the 1WS bit switches the bridge to overdrive slots
+  CHECK(sim.wire->reset_overdrive());
+  CHECK_EQ(sim.i2c.get_config() & 0x08, 0x08);
+  sim.wire->skip();
+  sim.wire->write8(0x44);
+  sim.bus.idle(20);
+  CHECK_EQ(a.received.size(), 1);
+  CHECK_EQ(a.received[0], 0x44);
+
+  // back to standard speed with a standard reset
+  CHECK(sim.wire->reset());
+  CHECK_EQ(sim.i2c.get_config() & 0x08, 0);
+  CHECK(!a.is_overdrive());
+  CHECK_EQ(a.missed_slots, 0);
+}
+
+static void test_stuck() {
+  SimBridge sim;
+  SimRecorder a(RECORDER);
+  sim.bus.add_device(&a);
+  sim.i2c.stuck = true;
+  // the status poll gives up, the bus reads as idle
+  uint64_t start = host_now_ns();
+  CHECK(!sim.wire->reset());
+  CHECK_EQ(sim.wire->read8(), 0xFF);
+  CHECK(host_now_ns() - start < 20000000ULL);
+  CHECK_EQ(a.resets, 0);
+}
+
+static void test_hub() {
+  // a hub that uses a bridge channel instead of a pin
+  host_app.clear();
+  ESPPreferenceObject::storage().clear();
+  SimBus bus;
+  SimDS2482 i2c(0x18, {bus.get_pin()});
+  DS2482Component ds2482;
+  ds2482.set_i2c_bus(&i2c);
+  ds2482.set_i2c_address(0x18);
+  host_app.register_component(&ds2482);
+  DallasComponent hub;
+  hub.set_one_wire(ds2482.get_channel(0));
+  hub.set_update_interval(5000);
+  hub.set_alert_update_interval(SCHEDULER_DONT_RUN);
+  host_app.register_component(&hub);
+
+  SimDS18B20 a(DS18B20);
+  SimDS18B20 b(DS18B20_B);
+  a.temperature = 23.3f;
+  b.temperature = -4.5f;
+  bus.add_device(&a);
+  bus.add_device(&b);
+  DallasTemperatureSensor sa, sb;
+  for (auto *sensor : {&sa, &sb}) {
+    sensor->set_resolution(12);
+    sensor->set_parent(&hub);
+    hub.register_sensor(sensor);
+  }
+  sa.set_address(DS18B20);
+  sb.set_address(DS18B20_B);
+
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return sa.is_attached() && sb.is_attached(); }, 1000));
+  CHECK(host_app.run_until([&]() { return sa.publish_count > 0 && sb.publish_count > 0; }, 10000));
+  CHECK(near(sa.state, 23.3125f));
+  CHECK(near(sb.state, -4.5f));
+  CHECK_EQ(sa.get_stats().crc_failures, 0);
+  CHECK(!hub.status_has_warning());
+  host_app.clear();
+}
+
+static void test_channels() {
+  // a DS2482-800 with buses on two of its channels, each with its own hub
+  host_app.clear();
+  ESPPreferenceObject::storage().clear();
+  SimBus bus0(4);
+  SimBus bus3(5);
+  SimDS2482 i2c(0x18, {bus0.get_pin(), 10, 11, bus3.get_pin(), 12, 13, 14, 15});
+  DS2482Component ds2482;
+  ds2482.set_i2c_bus(&i2c);
+  ds2482.set_i2c_address(0x18);
+  host_app.register_component(&ds2482);
+  DallasComponent hub0, hub3;
+  hub0.set_one_wire(ds2482.get_channel(0));
+  hub3.set_one_wire(ds2482.get_channel(3));
+  for (auto *hub : {&hub0, &hub3}) {
+    hub->set_update_interval(5000);
+    hub->set_alert_update_interval(SCHEDULER_DONT_RUN);
+    host_app.register_component(hub);
+  }
+
+  SimDS18B20 a(DS18B20);
+  SimDS18B20 b(DS18B20_B);
+  a.temperature = 19.0f;
+  b.temperature = 31.5f;
+  bus0.add_device(&a);
+  bus3.add_device(&b);
+  DallasTemperatureSensor sa, sb;
+  sa.set_resolution(12);
+  sb.set_resolution(12);
+  sa.set_address(DS18B20);
+  sb.set_address(DS18B20_B);
+  sa.set_parent(&hub0);
+  sb.set_parent(&hub3);
+  hub0.register_sensor(&sa);
+  hub3.register_sensor(&sb);
+
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return sa.publish_count > 0 && sb.publish_count > 0; }, 10000));
+  CHECK(near(sa.state, 19.0f));
+  CHECK(near(sb.state, 31.5f));
+  // the bridge switched between the channels
+  CHECK(i2c.commands[0xC3] >= 2);
+  CHECK(!hub0.status_has_warning());
+  CHECK(!hub3.status_has_warning());
+  host_app.clear();
+}
+
+int main() {
+  test_setup();
+  test_transfers();
+  test_search();
+  test_overdrive();
+  test_stuck();
+  test_hub();
+  test_channels();
+  return test_failures;
+}
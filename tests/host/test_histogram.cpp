@@ -0,0 +1,42 @@
+#include "one_wire_histogram.h"
+#include "test.h"
+
+#include <initializer_list>
+
+using namespace esphome::dallas;
+
+static void test_buckets() {
+  OneWireHistogram histogram;
+  for (uint32_t us : {0u, 1u, 2u, 3u, 4u, 7u, 8u, 1023u, 1024u, 100000u})
+    histogram.record(us);
+  CHECK_EQ(histogram.counts[0], 1);
+  CHECK_EQ(histogram.counts[1], 1);
+  CHECK_EQ(histogram.counts[2], 2);
+  CHECK_EQ(histogram.counts[3], 2);
+  CHECK_EQ(histogram.counts[4], 1);
+  CHECK_EQ(histogram.counts[10], 1);
+  // everything from 1024µs up goes into the last bucket
+  CHECK_EQ(histogram.counts[OneWireHistogram::BUCKETS - 1], 2);
+  CHECK_EQ(histogram.count, 10);
+}
+
+static void test_mean_and_max() {
+  OneWireHistogram histogram;
+  CHECK_EQ(histogram.mean(), 0);
+  histogram.record(60);
+  histogram.record(70);
+  histogram.record(80);
+  CHECK_EQ(histogram.mean(), 70);
+  CHECK_EQ(histogram.max, 80);
+  CHECK_EQ(histogram.take_recent_max(), 80);
+  CHECK_EQ(histogram.take_recent_max(), 0);
+  histogram.record(65);
+  CHECK_EQ(histogram.take_recent_max(), 65);
+  CHECK_EQ(histogram.max, 80);
+}
+
+int main() {
+  test_buckets();
+  test_mean_and_max();
+  return test_failures;
+}
@@ -0,0 +1,68 @@
+#include "../../components/ds1820/ds1820.h"
+#include "dallas_component.h"
+#include "sim_devices.h"
+#include "test.h"
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static const uint64_t DS18B20_A = sim_rom(0x28, 0xA1B2C3D);
+static const uint64_t DS18B20_B = sim_rom(0x28, 0xA1B2C3E);
+
+/// A hub on its own simulated bus, parallel with the root hub.
+struct ParallelHub {
+  ParallelHub(uint8_t pin, DallasComponent *root, uint64_t address, float temperature)
+      : bus(pin), device(address), root(root == nullptr ? &this->own : root) {
+    this->device.temperature = temperature;
+    this->bus.add_device(&this->device);
+    this->own.set_pin(&this->pin);
+    this->own.set_update_interval(SCHEDULER_DONT_RUN);
+    this->own.set_alert_update_interval(SCHEDULER_DONT_RUN);
+    this->own.set_parallel(this->root);
+    host_app.register_component(&this->own);
+    this->sensor.set_resolution(12);
+    this->sensor.set_address(address);
+    this->sensor.set_parent(&this->own);
+    this->own.register_sensor(&this->sensor);
+  }
+
+  SimBus bus;
+  HostGPIOPin pin{bus.get_pin()};
+  SimDS18B20 device;
+  DallasComponent own;
+  DallasComponent *root;
+  DallasTemperatureSensor sensor;
+};
+
+static void test_parallel_update() {
+  host_app.clear();
+  ParallelHub a(4, nullptr, DS18B20_A, 21.5f);
+  ParallelHub b(5, &a.own, DS18B20_B, 30.25f);
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return a.own.is_discovery_done() && b.own.is_discovery_done(); }, 1000));
+  CHECK(a.sensor.is_attached());
+  CHECK(b.sensor.is_attached());
+
+  uint32_t a_resets = a.device.resets;
+  uint32_t b_resets = b.device.resets;
+
+  // only the root updates, and queues the work on its bus
+  b.own.update();
+  CHECK(!a.own.has_transactions());
+  a.own.update();
+  CHECK(a.own.has_transactions());
+  CHECK(host_app.run_until([&]() { return a.sensor.publish_count > 0 && b.sensor.publish_count > 0; }, 2000));
+  CHECK(a.sensor.state == 21.5f);
+  CHECK(b.sensor.state == 30.25f);
+  CHECK_EQ(a.sensor.get_stats().crc_failures, 0);
+  CHECK_EQ(b.sensor.get_stats().crc_failures, 0);
+  // the conversion and the read reset both buses together
+  CHECK_EQ(a.device.resets - a_resets, 2);
+  CHECK_EQ(b.device.resets - b_resets, 2);
+  host_app.clear();
+}
+
+int main() {
+  test_parallel_update();
+  return test_failures;
+}
@@ -0,0 +1,162 @@
+#include "one_wire_program.h"
+#include "dallas_crc.h"
+#include "sim_devices.h"
+#include "test.h"
+
+#include <cstring>
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static const uint64_t ROM_A = 0xB200000012345629ULL;
+static const uint64_t ROM_B = 0x7100000087654329ULL;
+
+struct SimWire {
+  SimBus bus;
+  HostGPIOPin pin{bus.get_pin()};
+  ESPOneWire wire{&pin};
+};
+
+static bool run(ESPOneWire &wire, OneWireProgram &program, uint64_t address) {
+  if (!wire.reset())
+    return false;
+  return program.execute(&wire, address);
+}
+
+static void test_write_read() {
+  SimWire sim;
+  auto &wire = sim.wire;
+  SimRecorder a(ROM_A), b(ROM_B);
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+  a.listen = 3;
+  a.responses = {0x11, 0x22, 0x33};
+
+  OneWireProgram program;
+  const uint8_t address[2] = {0x88, 0x00};
+  program.write(0xF0).write(address, 2).read(3);
+  CHECK(run(wire, program, ROM_A));
+  CHECK(program.get_error() == nullptr);
+  CHECK_EQ(a.selects, 1);
+  CHECK_EQ(b.selects, 0);
+  CHECK_EQ(a.received.size(), 3);
+  CHECK_EQ(a.received[0], 0xF0);
+  CHECK_EQ(a.received[1], 0x88);
+  CHECK(b.received.empty());
+  const uint8_t *read = program.get_read();
+  CHECK(read != nullptr);
+  CHECK_EQ(read[0], 0x11);
+  CHECK_EQ(read[2], 0x33);
+  CHECK(program.get_read(1) == nullptr);
+}
+
+static void test_crc8() {
+  SimWire sim;
+  auto &wire = sim.wire;
+  SimRecorder a(ROM_A);
+  sim.bus.add_device(&a);
+  uint8_t data[4] = {0x50, 0x05, 0x4B, 0x46};
+  uint8_t crc = crc8(data, 4);
+
+  OneWireProgram program;
+  program.write(0xBE).read(4).check_crc8();
+  a.responses = {data[0], data[1], data[2], data[3], crc};
+  CHECK(run(wire, program, ROM_A));
+
+  OneWireProgram corrupted;
+  corrupted.write(0xBE).read(4).check_crc8();
+  a.responses = {data[0], uint8_t(data[1] ^ 0x10), data[2], data[3], crc};
+  CHECK(!run(wire, corrupted, ROM_A));
+  CHECK(strcmp(corrupted.get_error(), "bad crc8") == 0);
+}
+
+static void test_crc16_covers_writes() {
+  SimWire sim;
+  auto &wire = sim.wire;
+  SimRecorder a(ROM_A);
+  sim.bus.add_device(&a);
+  a.listen = 3;
+  // the CRC16 covers the command and address written as well as the data read
+  uint8_t transcript[5] = {0xA5, 0x20, 0x01, 0xDE, 0xAD};
+  uint16_t crc = crc16(transcript, 5, 0, 0xA001, false, true);
+
+  OneWireProgram program;
+  program.write(transcript, 3).read(2).check_crc16();
+  a.responses = {0xDE, 0xAD, uint8_t(crc & 0xFF), uint8_t(crc >> 8)};
+  CHECK(run(wire, program, ROM_A));
+
+  OneWireProgram other_address;
+  transcript[1] = 0x40;
+  other_address.write(transcript, 3).read(2).check_crc16();
+  a.responses = {0xDE, 0xAD, uint8_t(crc & 0xFF), uint8_t(crc >> 8)};
+  CHECK(!run(wire, other_address, ROM_A));
+  CHECK(strcmp(other_address.get_error(), "bad crc16") == 0);
+}
+
+static void test_confirm() {
+  SimWire sim;
+  auto &wire = sim.wire;
+  SimRecorder a(ROM_A);
+  sim.bus.add_device(&a);
+  a.listen = 3;
+
+  OneWireProgram program;
+  program.write(0x5A).write_inverted(0x0F).confirm().read(1);
+  a.responses = {0xAA, 0x0F};
+  CHECK(run(wire, program, ROM_A));
+  CHECK_EQ(a.received.size(), 3);
+  CHECK_EQ(a.received[2], 0xF0);
+  CHECK_EQ(program.get_read()[0], 0x0F);
+
+  OneWireProgram rejected;
+  rejected.write(0x5A).write_inverted(0x0F).confirm().read(1);
+  a.responses = {0x00, 0x0F};
+  CHECK(!run(wire, rejected, ROM_A));
+  CHECK(strcmp(rejected.get_error(), "not confirmed") == 0);
+}
+
+static void test_confirm_retry() {
+  SimWire sim;
+  auto &wire = sim.wire;
+  SimRecorder a(ROM_A);
+  sim.bus.add_device(&a);
+  a.listen = 3;
+
+  // DallasDevice::run_program_ runs a failed program once more, the read back byte must not become the expected one
+  OneWireProgram program;
+  program.write(0x5A).write_inverted(0x0F).confirm();
+  CHECK(!run(wire, program, ROM_A));
+  CHECK(!run(wire, program, ROM_A));
+  a.responses = {0x55};
+  CHECK(!run(wire, program, ROM_A));
+  a.responses = {0x55};
+  CHECK(!run(wire, program, ROM_A));
+  a.responses = {0xAA};
+  CHECK(run(wire, program, ROM_A));
+  a.responses = {0xAA};
+  CHECK(run(wire, program, ROM_A));
+}
+
+static void test_overflow() {
+  SimWire sim;
+  auto &wire = sim.wire;
+  SimRecorder a(ROM_A);
+  sim.bus.add_device(&a);
+
+  OneWireProgram program;
+  for (uint8_t i = 0; i <= OneWireProgram::MAX_STEPS; i++)
+    program.write(i);
+  CHECK(!run(wire, program, ROM_A));
+  CHECK(strcmp(program.get_error(), "program too long") == 0);
+  CHECK(a.received.empty());
+}
+
+int main() {
+  test_write_read();
+  test_crc8();
+  test_crc16_covers_writes();
+  test_confirm();
+  test_confirm_retry();
+  test_overflow();
+  return test_failures;
+}
@@ -0,0 +1,157 @@
+#include "one_wire_pulse.h"
+#include "test.h"
+
+using namespace esphome::dallas;
+
+// what a peripheral captures for the train: write slots as sent, the read slots from first_read on
+// stretched by a device answering 0
+static uint8_t capture(const OneWirePulseTrain &train, uint8_t first_read, const bool *answers, uint16_t *low_us) {
+  for (uint8_t i = 0; i < train.size(); i++) {
+    low_us[i] = train.get_pulses()[i].low_us;
+    if (i >= first_read && !answers[i - first_read])
+      low_us[i] = 30;
+  }
+  return train.size();
+}
+
+static void test_write8_pulses() {
+  OneWirePulseTrain train;
+  CHECK(train.add_write8(0xA5));
+  CHECK_EQ(train.size(), 8);
+  CHECK_EQ(train.get_read_count(), 0);
+  for (uint8_t i = 0; i < 8; i++) {
+    bool one = (0xA5 >> i) & 1;
+    auto &pulse = train.get_pulses()[i];
+    CHECK(one ? pulse.low_us < OneWirePulseTrain::READ_ZERO_LOW_US : pulse.low_us >= 60);
+    CHECK(pulse.low_us + pulse.high_us >= 60);
+  }
+}
+
+static void test_decode_reads() {
+  OneWirePulseTrain train;
+  train.add_write8(0xCC);
+  for (uint8_t i = 0; i < 8; i++)
+    train.add_read();
+  CHECK_EQ(train.get_read_count(), 8);
+
+  const bool answers[8] = {true, false, false, true, true, true, false, true};
+  uint16_t low_us[OneWirePulseTrain::MAX_SLOTS];
+  uint8_t count = capture(train, 8, answers, low_us);
+  CHECK(train.decode(low_us, count));
+  for (uint8_t i = 0; i < 8; i++)
+    CHECK_EQ(train.get_read(i), answers[i]);
+}
+
+static void test_decode_missing_slots() {
+  OneWirePulseTrain train;
+  train.add_write8(0x44);
+  train.add_read();
+  uint16_t low_us[OneWirePulseTrain::MAX_SLOTS];
+  const bool answers[1] = {true};
+  uint8_t count = capture(train, 8, answers, low_us);
+  CHECK(!train.decode(low_us, count - 1));
+}
+
+static void test_full_train() {
+  OneWirePulseTrain train;
+  for (uint8_t i = 0; i < OneWirePulseTrain::MAX_SLOTS / 8 - 1; i++)
+    CHECK(train.add_write8(0xFF));
+  train.add_read();
+  // the last byte doesn't fit whole any more
+  CHECK(!train.add_write8(0x00));
+  CHECK_EQ(train.size(), OneWirePulseTrain::MAX_SLOTS - 7);
+  while (!train.is_full())
+    CHECK(train.add_write(true));
+  CHECK(!train.add_read());
+  CHECK(!train.add_write(false));
+  train.clear();
+  CHECK(train.empty());
+  CHECK_EQ(train.get_read_count(), 0);
+}
+
+static void test_decode_interleaved() {
+  // search: two read slots, then the direction written, over more than a byte of reads
+  OneWirePulseTrain train;
+  for (uint8_t i = 0; i < 6; i++) {
+    train.add_read();
+    train.add_read();
+    train.add_write(i & 1);
+  }
+  CHECK_EQ(train.size(), 18);
+  CHECK_EQ(train.get_read_count(), 12);
+  uint16_t low_us[OneWirePulseTrain::MAX_SLOTS];
+  for (uint8_t i = 0; i < train.size(); i++) {
+    low_us[i] = train.get_pulses()[i].low_us;
+    // every third read answered 0, the written 0s have long lows too
+    if (i % 3 != 2 && (i / 3 + i % 3) % 3 == 0)
+      low_us[i] = 40;
+  }
+  CHECK(train.decode(low_us, train.size()));
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < train.size(); i++) {
+    if (i % 3 == 2)
+      continue;
+    CHECK_EQ(train.get_read(n), (i / 3 + i % 3) % 3 != 0);
+    n++;
+  }
+}
+
+static void test_decode_threshold() {
+  OneWirePulseTrain train;
+  train.add_read();
+  train.add_read();
+  const uint16_t low_us[2] = {OneWirePulseTrain::READ_ZERO_LOW_US - 1, OneWirePulseTrain::READ_ZERO_LOW_US};
+  CHECK(train.decode(low_us, 2));
+  CHECK(train.get_read(0));
+  CHECK(!train.get_read(1));
+  // a glitch captured after the last slot doesn't matter
+  const uint16_t extra[3] = {3, 3, 2};
+  CHECK(train.decode(extra, 3));
+  CHECK(train.get_read(1));
+}
+
+static void test_reuse() {
+  // slots of a cleared train are set again, a write where a read was isn't decoded
+  OneWirePulseTrain train;
+  train.add_read();
+  train.add_read();
+  const uint16_t zeros[2] = {30, 30};
+  CHECK(train.decode(zeros, 2));
+  CHECK(!train.get_read(1));
+  train.clear();
+  train.add_write(false);
+  train.add_read();
+  CHECK_EQ(train.get_read_count(), 1);
+  CHECK_EQ(train.get_pulses()[0].low_us, 60);
+  const uint16_t low_us[2] = {60, 3};
+  CHECK(train.decode(low_us, 2));
+  CHECK(train.get_read(0));
+}
+
+static void test_presence() {
+  const uint16_t present[2] = {480, 120};
+  const uint16_t absent[1] = {480};
+  const uint16_t held_low[1] = {960};
+  const uint16_t glitch[2] = {100, 120};
+  // a presence pulse as long as the reset is a bus still held low
+  const uint16_t long_presence[2] = {480, 240};
+  const uint16_t late_presence[3] = {480, 240, 60};
+  CHECK(OneWirePulseTrain::decode_presence(present, 2));
+  CHECK(!OneWirePulseTrain::decode_presence(absent, 1));
+  CHECK(!OneWirePulseTrain::decode_presence(held_low, 1));
+  CHECK(!OneWirePulseTrain::decode_presence(glitch, 2));
+  CHECK(!OneWirePulseTrain::decode_presence(long_presence, 2));
+  CHECK(!OneWirePulseTrain::decode_presence(late_presence, 3));
+}
+
+int main() {
+  test_write8_pulses();
+  test_decode_reads();
+  test_decode_missing_slots();
+  test_full_train();
+  test_decode_interleaved();
+  test_decode_threshold();
+  test_reuse();
+  test_presence();
+  return test_failures;
+}
@@ -0,0 +1,228 @@
+#include "rmt_one_wire.h"
+#include "sim_devices.h"
+#include "test.h"
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static const uint64_t DS18B20 = sim_rom(0x28, 0xA1B2C3D);
+static const uint64_t DS2408 = sim_rom(0x29, 0x1234AB);
+
+static const rmt_channel_t TX = RMT_CHANNEL_0;
+static const rmt_channel_t RX = RMT_CHANNEL_4;
+
+/// The RMT bus master on a simulated bus, the channels send and capture on its pin.
+struct SimRMT {
+  SimRMT() { this->setup = this->wire.setup(); }
+  ~SimRMT() {
+    rmt_driver_uninstall(TX);
+    rmt_driver_uninstall(RX);
+  }
+
+  SimBus bus;
+  HostGPIOPin pin{bus.get_pin()};
+  RMTOneWire wire{&pin, TX, RX};
+  bool setup;
+};
+
+static rmt_item32_t item(uint16_t low_us, uint16_t high_us) {
+  rmt_item32_t item;
+  item.level0 = 0;
+  item.duration0 = low_us;
+  item.level1 = 1;
+  item.duration1 = high_us;
+  return item;
+}
+
+/// What the receive channel captures for slots with these low times, the last high is the idle end.
+static std::vector<rmt_item32_t> frame(const std::vector<uint16_t> &low_us) {
+  std::vector<rmt_item32_t> items;
+  for (auto low : low_us)
+    items.push_back(item(low, 70 - low));
+  items.back().duration1 = 0;
+  return items;
+}
+
+/// Low times of a byte written or read, a 0 bit has the long low.
+static void add_byte(std::vector<uint16_t> &low_us, uint8_t value, uint16_t zero_us) {
+  for (uint8_t i = 0; i < 8; i++)
+    low_us.push_back((value >> i) & 1 ? 6 : zero_us);
+}
+
+static void test_setup() {
+  SimRMT sim;
+  CHECK(sim.setup);
+  CHECK(!sim.wire.is_bit_banged());
+  // the channels are taken
+  HostGPIOPin pin(sim.bus.get_pin());
+  RMTOneWire other(&pin, TX, RX);
+  CHECK(!other.setup());
+}
+
+static void test_reset() {
+  SimRMT sim;
+  CHECK(!sim.wire.reset());
+  CHECK_EQ(sim.wire.get_stats().presence_failures, 1);
+
+  SimRecorder a(DS18B20);
+  sim.bus.add_device(&a);
+  CHECK(sim.wire.reset());
+  CHECK_EQ(a.resets, 1);
+  CHECK_EQ(sim.wire.get_stats().resets, 2);
+  CHECK_EQ(sim.wire.get_stats().presence_failures, 1);
+}
+
+static void test_write_only() {
+  SimRMT sim;
+  SimRecorder a(DS18B20);
+  a.listen = 3;
+  sim.bus.add_device(&a);
+
+  CHECK(sim.wire.reset());
+  {
+    // sent as one train when the transaction ends
+    OneWireLock lock(&sim.wire);
+    sim.wire.skip();
+    sim.wire.write8(0x4E);
+    sim.wire.write8(0x4B);
+    sim.wire.write8(0x46);
+    CHECK_EQ(a.received.size(), 0);
+  }
+  sim.bus.idle(100);
+  CHECK_EQ(a.received.size(), 3);
+  CHECK_EQ(a.received[0], 0x4E);
+  CHECK_EQ(a.received[2], 0x46);
+  CHECK_EQ(sim.wire.get_stats().slots, 32);
+  CHECK_EQ(a.missed_slots, 0);
+}
+
+static void test_write_read() {
+  SimRMT sim;
+  SimDS2408 a(DS2408);
+  SimDS18B20 b(DS18B20);
+  a.set_inputs(0x5F);
+  b.temperature = 18.0625f;
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+
+  // the select, the command and the read slots go out as one train
+  CHECK(sim.wire.reset());
+  {
+    OneWireLock lock(&sim.wire);
+    sim.wire.select(DS2408);
+    sim.wire.write8(0xF5);
+    CHECK_EQ(sim.wire.read8(), a.pio());
+  }
+
+  // longer than a train, read in chunks
+  uint8_t pad[9];
+  CHECK(sim.wire.reset());
+  {
+    OneWireLock lock(&sim.wire);
+    sim.wire.select(DS18B20);
+    sim.wire.write8(0xBE);
+    sim.wire.read_bytes(pad, sizeof(pad));
+  }
+  CHECK_EQ(sim_crc8(pad, 8), pad[8]);
+  CHECK_EQ(pad[4], 0x7F);
+}
+
+static void test_search() {
+  SimRMT sim;
+  SimDS2408 a(DS2408);
+  SimDS18B20 b(DS18B20);
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+
+  auto found = sim.wire.search_vec();
+  CHECK_EQ(found.size(), 2);
+  bool has_a = false, has_b = false;
+  for (auto rom : found) {
+    has_a = has_a || rom == DS2408;
+    has_b = has_b || rom == DS18B20;
+  }
+  CHECK(has_a && has_b);
+}
+
+static void test_captured_reset() {
+  SimRMT sim;
+  // reset pulse, then the presence pulse in the next item
+  host_rmt_set_capture(RX, {item(480, 32), item(118, 0)});
+  CHECK(sim.wire.reset());
+  // the presence pulse in the second half of an item, when the capture started on a high level
+  rmt_item32_t first;
+  first.level0 = 1;
+  first.duration0 = 4;
+  first.level1 = 0;
+  first.duration1 = 481;
+  rmt_item32_t second;
+  second.level0 = 1;
+  second.duration0 = 30;
+  second.level1 = 0;
+  second.duration1 = 120;
+  host_rmt_set_capture(RX, {first, second, item(0, 0)});
+  CHECK(sim.wire.reset());
+  // only the reset pulse
+  host_rmt_set_capture(RX, {item(480, 0)});
+  CHECK(!sim.wire.reset());
+  // a bus held low past the reset
+  host_rmt_set_capture(RX, {item(900, 0)});
+  CHECK(!sim.wire.reset());
+  CHECK_EQ(sim.wire.get_stats().presence_failures, 2);
+}
+
+static void test_captured_reads() {
+  SimRMT sim;
+  std::vector<uint16_t> low_us;
+  add_byte(low_us, 0xA5, 30);
+  host_rmt_set_capture(RX, frame(low_us));
+  CHECK_EQ(sim.wire.read8(), 0xA5);
+
+  // write slots first, only the read slots are decoded
+  low_us.clear();
+  add_byte(low_us, 0xBE, 60);
+  add_byte(low_us, 0x3C, 45);
+  host_rmt_set_capture(RX, frame(low_us));
+  {
+    OneWireLock lock(&sim.wire);
+    sim.wire.write8(0xBE);
+    CHECK_EQ(sim.wire.read8(), 0x3C);
+  }
+
+  // a read 0 just past the threshold, a 1 just below it
+  low_us.clear();
+  low_us.push_back(uint16_t(OneWirePulseTrain::READ_ZERO_LOW_US));
+  low_us.push_back(uint16_t(OneWirePulseTrain::READ_ZERO_LOW_US - 1));
+  host_rmt_set_capture(RX, frame(low_us));
+  CHECK_EQ(sim.wire.tribit(false), TRIBIT_SECOND_BIT);
+}
+
+static void test_captured_missing() {
+  SimRMT sim;
+  // slots lost from the capture read as 1s, as from an empty bus
+  std::vector<uint16_t> low_us;
+  add_byte(low_us, 0x00, 30);
+  low_us.resize(5);
+  host_rmt_set_capture(RX, frame(low_us));
+  CHECK_EQ(sim.wire.read8(), 0xFF);
+  // an empty capture
+  host_rmt_set_capture(RX, {item(0, 0)});
+  CHECK_EQ(sim.wire.read8(), 0xFF);
+  // the next transfer is decoded again
+  low_us.clear();
+  add_byte(low_us, 0x81, 30);
+  host_rmt_set_capture(RX, frame(low_us));
+  CHECK_EQ(sim.wire.read8(), 0x81);
+}
+
+int main() {
+  test_setup();
+  test_reset();
+  test_write_only();
+  test_write_read();
+  test_search();
+  test_captured_reset();
+  test_captured_reads();
+  test_captured_missing();
+  return test_failures;
+}
@@ -0,0 +1,112 @@
+#include "esp_one_wire.h"
+#include "sim_devices.h"
+#include "test.h"
+
+#include <algorithm>
+#include <initializer_list>
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static const uint64_t DS18B20_A = 0x3C00000A1B2C3D28ULL;
+static const uint64_t DS18B20_B = 0x1100000A1B2C3E28ULL;
+static const uint64_t DS2408 = 0x9F0000001234AB29ULL;
+static const uint64_t DS2438 = 0x5500000076543226ULL;
+
+struct SimWire {
+  SimWire() {
+    this->bus.add_device(&this->a);
+    this->bus.add_device(&this->b);
+    this->bus.add_device(&this->c);
+    this->bus.add_device(&this->d);
+  }
+  SimBus bus;
+  HostGPIOPin pin{bus.get_pin()};
+  ESPOneWire wire{&pin};
+  SimDS18B20 a{DS18B20_A}, b{DS18B20_B};
+  SimDS2408 c{DS2408};
+  SimDS2438 d{DS2438};
+};
+
+static std::vector<uint64_t> search_family(ESPOneWire &wire, uint8_t family) {
+  std::vector<uint64_t> found;
+  wire.reset_search(family);
+  while (wire.reset()) {
+    uint64_t address = wire.search();
+    if (address == 0)
+      break;
+    found.push_back(address);
+  }
+  return found;
+}
+
+static void test_search_all() {
+  SimWire bus;
+  auto found = bus.wire.search_vec();
+  CHECK_EQ(found.size(), 4);
+  for (uint64_t rom : {DS18B20_A, DS18B20_B, DS2408, DS2438})
+    CHECK(std::count(found.begin(), found.end(), rom) == 1);
+}
+
+static void test_search_empty_bus() {
+  SimBus bus;
+  HostGPIOPin pin(bus.get_pin());
+  ESPOneWire wire(&pin);
+  CHECK(wire.search_vec().empty());
+}
+
+static void test_family_search() {
+  SimWire bus;
+  auto found = search_family(bus.wire, 0x28);
+  CHECK_EQ(found.size(), 2);
+  CHECK(std::count(found.begin(), found.end(), DS18B20_A) == 1);
+  CHECK(std::count(found.begin(), found.end(), DS18B20_B) == 1);
+
+  found = search_family(bus.wire, 0x29);
+  CHECK_EQ(found.size(), 1);
+  CHECK_EQ(found[0], DS2408);
+
+  // no such family, the search runs into the next one and has to give up
+  CHECK(search_family(bus.wire, 0x27).empty());
+  CHECK(search_family(bus.wire, 0x10).empty());
+}
+
+static void test_family_search_stops_early() {
+  SimWire bus;
+  search_family(bus.wire, 0x26);
+  uint32_t family_slots = bus.wire.get_stats().slots;
+  bus.wire.reset_stats();
+  bus.wire.search_vec();
+  // one search pass for the family instead of one per device
+  CHECK(family_slots < bus.wire.get_stats().slots / 2);
+}
+
+static void test_search_select() {
+  SimWire bus;
+  bus.wire.reset();
+  CHECK_EQ(bus.wire.search_select(DS2408, ONE_WIRE_ROM_SEARCH), DS2408);
+  // the device samples the last direction bit after the master is done with the slot
+  bus.bus.idle(100);
+  CHECK_EQ(bus.c.selects, 1);
+  CHECK_EQ(bus.a.selects + bus.b.selects + bus.d.selects, 0);
+
+  // a device that isn't there, the search ends up on another one
+  bus.wire.reset();
+  CHECK(bus.wire.search_select(0x0100000000000028ULL, ONE_WIRE_ROM_SEARCH) != 0x0100000000000028ULL);
+}
+
+static void test_max_devices() {
+  SimWire bus;
+  bus.wire.set_max_devices(3);
+  CHECK_EQ(bus.wire.search_vec().size(), 3);
+}
+
+int main() {
+  test_search_all();
+  test_search_empty_bus();
+  test_family_search();
+  test_family_search_stops_early();
+  test_search_select();
+  test_max_devices();
+  return test_failures;
+}
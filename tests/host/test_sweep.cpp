@@ -0,0 +1,97 @@
+#include "esp_one_wire.h"
+#include "one_wire_sweep.h"
+#include "sim_devices.h"
+#include "test.h"
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static const uint64_t DS18B20 = sim_rom(0x28, 0xA1B2C3D);
+static const uint64_t DS18B20_B = sim_rom(0x28, 0xA1B2C3E);
+static const uint64_t DS2408 = sim_rom(0x29, 0x1234AB);
+
+struct SimSweep {
+  SimSweep() {
+    this->bus.add_device(&this->a);
+    this->bus.add_device(&this->b);
+    this->bus.add_device(&this->c);
+  }
+
+  /// Run the whole sweep, false if it didn't start.
+  bool run() {
+    if (!this->sweep.start(&this->wire, DS18B20))
+      return false;
+    while (this->sweep.step()) {
+    }
+    return true;
+  }
+
+  SimBus bus;
+  HostGPIOPin pin{bus.get_pin()};
+  ESPOneWire wire{&pin};
+  SimDS18B20 a{DS18B20};
+  SimDS18B20 b{DS18B20_B};
+  SimDS2408 c{DS2408};
+  OneWireTimingSweep sweep;
+};
+
+static void test_fast_bus() {
+  SimSweep sim;
+  auto original = sim.wire.get_timing();
+  CHECK(sim.run());
+  CHECK(!sim.sweep.is_running());
+  CHECK(sim.sweep.found());
+  CHECK_EQ(sim.sweep.get_best().slot, 60);
+  CHECK(sim.sweep.get_best().read_sample < original.read_sample);
+  // the sweep leaves the timing to the caller
+  CHECK_EQ(sim.wire.get_timing().read_sample, original.read_sample);
+}
+
+static void test_slow_bus() {
+  // a 1 sampled before the line rose reads as a 0, the search still follows the ROM but reads other bits
+  SimSweep sim;
+  sim.bus.set_rise_ns(6000);
+  CHECK(sim.run());
+  CHECK(sim.sweep.found());
+  CHECK(sim.sweep.get_best().read_sample >= 11);
+
+  // nothing reads reliably three sample points in a row
+  SimSweep slower;
+  slower.bus.set_rise_ns(10000);
+  CHECK(slower.run());
+  CHECK(!slower.sweep.found());
+}
+
+static void test_no_sample_points() {
+  SimSweep sim;
+  auto timing = sim.wire.get_timing();
+  // no sample point after a 14µs read low
+  timing.read_low = 14;
+  sim.wire.set_timing(timing);
+  CHECK(!sim.run());
+  CHECK(!sim.sweep.is_running());
+  CHECK(!sim.sweep.step());
+
+  // one point left, too few to pick one
+  timing.read_low = 13;
+  timing.read_sample = 14;
+  sim.wire.set_timing(timing);
+  CHECK(sim.run());
+  CHECK(!sim.sweep.found());
+  CHECK_EQ(sim.wire.get_timing().read_low, 13);
+}
+
+static void test_missing_device() {
+  SimSweep sim;
+  sim.bus.remove_device(&sim.a);
+  CHECK(!sim.run());
+  CHECK(!sim.sweep.is_running());
+}
+
+int main() {
+  test_fast_bus();
+  test_slow_bus();
+  test_no_sample_points();
+  test_missing_device();
+  return test_failures;
+}
@@ -0,0 +1,130 @@
+#include "../../components/ds1820/ds1820.h"
+#include "sim_hub.h"
+#include "sim_uart.h"
+#include "test.h"
+#include "uart_one_wire.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace esphome;
+using namespace esphome::dallas;
+
+static const uint64_t DS18B20 = sim_rom(0x28, 0xA1B2C3D);
+static const uint64_t DS18B20_B = sim_rom(0x28, 0xA1B2C3E);
+static const uint64_t RECORDER = sim_rom(0x29, 0x1234AB);
+
+/// The UART bus master with TX and RX on a simulated bus.
+struct SimLoopback {
+  SimBus bus;
+  SimUART uart{bus.get_pin()};
+  UARTOneWire wire{&uart};
+};
+
+static void test_reset() {
+  SimLoopback sim;
+  CHECK(!sim.wire.reset());
+  CHECK_EQ(sim.wire.get_stats().presence_failures, 1);
+
+  SimRecorder a(RECORDER);
+  sim.bus.add_device(&a);
+  CHECK(sim.wire.reset());
+  CHECK_EQ(a.resets, 1);
+  // one frame at the reset rate each, the rate is switched back for the slots
+  CHECK_EQ(sim.uart.frames_9600, 2);
+  CHECK_EQ(sim.uart.get_baud_rate(), 115200);
+  CHECK_EQ(sim.wire.get_stats().presence_failures, 1);
+}
+
+static void test_transfers() {
+  SimLoopback sim;
+  SimRecorder a(RECORDER);
+  a.listen = 2;
+  a.responses = {0xA5, 0x3C};
+  sim.bus.add_device(&a);
+
+  CHECK(sim.wire.reset());
+  sim.wire.select(RECORDER);
+  sim.wire.write8(0xF0);
+  sim.wire.write8(0x81);
+  CHECK_EQ(sim.wire.read8(), 0xA5);
+  // the low bit of the next response, a 0
+  CHECK(!sim.wire.read_bit());
+  sim.bus.idle(100);
+  CHECK_EQ(a.received.size(), 2);
+  CHECK_EQ(a.received[0], 0xF0);
+  CHECK_EQ(a.received[1], 0x81);
+  CHECK_EQ(a.missed_slots, 0);
+  CHECK_EQ(sim.wire.get_stats().slots, 8 + 64 + 8 + 8 + 8 + 1);
+  // a slot is one frame of 10 bits at 115200 baud
+  CHECK_EQ(sim.uart.frames_115200, 8 + 64 + 8 + 8 + 8 + 1);
+}
+
+static void test_search() {
+  SimLoopback sim;
+  SimDS18B20 a(DS18B20);
+  SimDS18B20 b(DS18B20_B);
+  SimRecorder c(RECORDER);
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+  sim.bus.add_device(&c);
+
+  auto found = sim.wire.search_vec();
+  CHECK_EQ(found.size(), 3);
+  for (auto rom : {DS18B20, DS18B20_B, RECORDER})
+    CHECK(std::find(found.begin(), found.end(), rom) != found.end());
+}
+
+static void test_no_echo() {
+  SimLoopback sim;
+  SimRecorder a(RECORDER);
+  sim.bus.add_device(&a);
+  sim.uart.rx_connected = false;
+  CHECK(!sim.wire.reset());
+  CHECK_EQ(sim.wire.read8(), 0xFF);
+  // the device still saw the reset, only the echo is missing
+  CHECK_EQ(a.resets, 1);
+}
+
+static void test_hub() {
+  host_app.clear();
+  ESPPreferenceObject::storage().clear();
+  SimLoopback sim;
+  DallasComponent hub;
+  hub.set_one_wire(&sim.wire);
+  hub.set_update_interval(5000);
+  hub.set_alert_update_interval(SCHEDULER_DONT_RUN);
+  host_app.register_component(&hub);
+
+  SimDS18B20 a(DS18B20);
+  SimDS18B20 b(DS18B20_B);
+  a.temperature = 22.0625f;
+  b.temperature = -1.5f;
+  sim.bus.add_device(&a);
+  sim.bus.add_device(&b);
+  DallasTemperatureSensor sa, sb;
+  for (auto *sensor : {&sa, &sb}) {
+    sensor->set_resolution(12);
+    sensor->set_parent(&hub);
+    hub.register_sensor(sensor);
+  }
+  sa.set_address(DS18B20);
+  sb.set_address(DS18B20_B);
+
+  host_app.setup();
+  CHECK(host_app.run_until([&]() { return sa.publish_count > 0 && sb.publish_count > 0; }, 10000));
+  CHECK(std::fabs(sa.state - 22.0625f) < 0.01f);
+  CHECK(std::fabs(sb.state + 1.5f) < 0.01f);
+  CHECK_EQ(sa.get_stats().crc_failures, 0);
+  CHECK(!hub.status_has_warning());
+  host_app.clear();
+}
+
+int main() {
+  test_reset();
+  test_transfers();
+  test_search();
+  test_no_echo();
+  test_hub();
+  return test_failures;
+}
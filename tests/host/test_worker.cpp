@@ -0,0 +1,202 @@
+// The bus task on host threads: the queues between the main loop and the task, and the
+// handover of transactions. Built with USE_ESP32 on its own, without the rest of the component.
+
+#include "dallas_bus_worker.h"
+#include "dallas_component.h"
+#include "test.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace esphome::dallas;
+
+static void test_queue() {
+  DallasSPSCQueue<int, 4> queue;
+  int item;
+  CHECK(queue.empty());
+  CHECK(!queue.pop(item));
+  // holds N - 1 items
+  CHECK(queue.push(1));
+  CHECK(queue.push(2));
+  CHECK(queue.push(3));
+  CHECK(queue.full());
+  CHECK(!queue.push(4));
+  CHECK(queue.pop(item));
+  CHECK_EQ(item, 1);
+  // wraps around
+  CHECK(queue.push(4));
+  for (int expected : {2, 3, 4}) {
+    CHECK(queue.pop(item));
+    CHECK_EQ(item, expected);
+  }
+  CHECK(queue.empty());
+}
+
+static void test_queue_threads() {
+  // a producer and a consumer thread, every item arrives once and in order
+  static const uint32_t COUNT = 200000;
+  DallasSPSCQueue<uint32_t, 8> queue;
+  std::thread producer([&queue]() {
+    for (uint32_t i = 0; i < COUNT; i++) {
+      while (!queue.push(i))
+        std::this_thread::yield();
+    }
+  });
+  uint32_t expected = 0;
+  uint32_t out_of_order = 0;
+  while (expected < COUNT) {
+    uint32_t item;
+    if (!queue.pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    out_of_order += item != expected;
+    expected = item + 1;
+  }
+  producer.join();
+  CHECK_EQ(out_of_order, 0);
+  CHECK(queue.empty());
+}
+
+/// A transaction that records where it ran, gated so the test can hold the task in it.
+struct Probe {
+  DallasTransaction *make(DallasPriority priority = DALLAS_PRIORITY_SENSOR) {
+    return new DallasTransaction{nullptr, 0, priority, [this]() {
+                                   this->started = true;
+                                   while (this->hold.load())
+                                     std::this_thread::yield();
+                                   this->ran_in_worker = this->ran_in_worker && this->worker->in_worker();
+                                   this->runs++;
+                                 }};
+  }
+
+  DallasBusWorker *worker;
+  std::atomic<bool> hold{false};
+  std::atomic<bool> started{false};
+  std::atomic<uint32_t> runs{0};
+  std::atomic<bool> ran_in_worker{true};
+};
+
+/// Take the results until count came back, false if they don't within a second.
+static bool take_results(DallasBusWorker &worker, std::vector<DallasTransaction *> &results, size_t count) {
+  auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (results.size() < count && std::chrono::steady_clock::now() < until) {
+    if (auto *transaction = worker.take_result()) {
+      results.push_back(transaction);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  return results.size() == count;
+}
+
+static void test_worker_runs() {
+  DallasBusWorker worker;
+  CHECK(worker.start(1));
+  CHECK(worker.is_idle());
+  CHECK(!worker.in_worker());
+  Probe probe;
+  probe.worker = &worker;
+
+  // transactions come back in the order they were handed over, after running on the task
+  std::vector<DallasTransaction *> submitted;
+  for (int i = 0; i < 5; i++) {
+    submitted.push_back(probe.make());
+    CHECK(worker.submit(submitted.back()));
+  }
+  std::vector<DallasTransaction *> results;
+  CHECK(take_results(worker, results, 5));
+  CHECK(results == submitted);
+  CHECK_EQ(probe.runs.load(), 5);
+  CHECK(probe.ran_in_worker.load());
+  worker.wait_idle();
+  CHECK(worker.is_idle());
+  CHECK(worker.take_result() == nullptr);
+  for (auto *transaction : results)
+    delete transaction;
+}
+
+static void test_worker_full() {
+  DallasBusWorker worker;
+  CHECK(worker.start(1));
+  Probe probe;
+  probe.worker = &worker;
+
+  // the task holds the first one, the request queue takes 7 more
+  probe.hold = true;
+  std::vector<DallasTransaction *> submitted{probe.make()};
+  CHECK(worker.submit(submitted[0]));
+  while (!probe.started.load())
+    std::this_thread::yield();
+  CHECK(!worker.is_idle());
+  for (int i = 0; i < 7; i++) {
+    submitted.push_back(probe.make());
+    CHECK(worker.submit(submitted.back()));
+  }
+  auto *rejected = probe.make();
+  CHECK(!worker.submit(rejected));
+  delete rejected;
+
+  // the result queue fills up too, the task waits for the main loop to drain it
+  probe.hold = false;
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  CHECK(!worker.is_idle());
+  std::vector<DallasTransaction *> results;
+  CHECK(take_results(worker, results, 8));
+  CHECK(results == submitted);
+  worker.wait_idle();
+  for (auto *transaction : results)
+    delete transaction;
+}
+
+static void test_worker_stats() {
+  // the task counts while the main loop reads, the reads only ever see the count grow
+  DallasBusWorker worker;
+  CHECK(worker.start(1));
+  ESPOneWireStats stats;
+  std::vector<DallasTransaction *> submitted;
+  for (int i = 0; i < 4; i++) {
+    submitted.push_back(new DallasTransaction{nullptr, 0, DALLAS_PRIORITY_SENSOR, [&stats]() {
+                                                for (int j = 0; j < 20000; j++) {
+                                                  stats.slots++;
+                                                  stats.bus_us += 70;
+                                                }
+                                              }});
+    CHECK(worker.submit(submitted.back()));
+  }
+  uint32_t last = 0;
+  bool grew = true;
+  std::vector<DallasTransaction *> results;
+  auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (results.size() < submitted.size() && std::chrono::steady_clock::now() < until) {
+    uint32_t slots = stats.slots;
+    grew = grew && slots >= last;
+    last = slots;
+    if (auto *transaction = worker.take_result())
+      results.push_back(transaction);
+  }
+  CHECK(grew);
+  CHECK_EQ(results.size(), submitted.size());
+  CHECK_EQ(stats.slots, 80000);
+  CHECK_EQ(stats.bus_us, 80000 * 70);
+  for (auto *transaction : results)
+    delete transaction;
+}
+
+static void test_worker_start_fails() {
+  DallasBusWorker worker;
+  host_task_fail_next_create();
+  CHECK(!worker.start(1));
+}
+
+int main() {
+  test_queue();
+  test_queue_threads();
+  test_worker_runs();
+  test_worker_full();
+  test_worker_stats();
+  test_worker_start_fails();
+  return test_failures;
+}